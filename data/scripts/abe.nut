@@ -61,6 +61,17 @@ class Abe extends BaseMapObject
         "AbeRolling"
     ];
 
+    // Hashed with the object each frame so that replays notice when these drift
+    static kStateHashSlots =
+    [
+        "mNextFunction",
+        "mInvertX",
+        "mXSpeed",
+        "mXVelocity",
+        "mYSpeed",
+        "mYVelocity"
+    ];
+
     function InputNotSameAsDirection()
     {
         return (Actions.Left(mInput.IsHeld)  && base.FacingRight()) 
@@ -2,6 +2,7 @@
 
 #include "types.hpp"
 #include <vector>
+#include <unordered_map>
 
 #include <glm/glm.hpp>
 #include <glm/vec3.hpp> // glm::vec3
@@ -13,6 +14,7 @@
 #include "logger.hpp"
 #include <memory>
 #include "imgui/imgui.h"
+#include "debugoverlay.hpp"
 
 struct ColourU8
 {
@@ -30,6 +32,24 @@ public:
     bool IsValid() const { return mData != nullptr; }
 };
 
+// Axis aligned rectangle in world space
+struct WorldRect
+{
+    glm::vec2 mMin;
+    glm::vec2 mMax;
+
+    bool Intersects(const WorldRect& other) const
+    {
+        return mMin.x <= other.mMax.x && mMax.x >= other.mMin.x &&
+               mMin.y <= other.mMax.y && mMax.y >= other.mMin.y;
+    }
+
+    WorldRect Expanded(f32 amount) const
+    {
+        return WorldRect{ mMin - glm::vec2(amount, amount), mMax + glm::vec2(amount, amount) };
+    }
+};
+
 // TODO: Pass array ref
 inline void MatrixLerp(float* from, float* to, float speed)
 {
@@ -45,6 +65,9 @@ public:
     glm::vec2 WorldToScreen(const glm::vec2& worldPos);
     glm::vec2 ScreenToWorld(const glm::vec2& screenPos);
 
+    // The part of the world that is currently on screen, follows the smoothed camera
+    WorldRect VisibleWorldRect();
+
     glm::vec4 WorldToScreenRect(f32 x, f32 y, f32 width, f32 height)
     {
         glm::vec2 rectPos = glm::vec2(x, y);
@@ -216,6 +239,9 @@ public:
     // Drawing commands, which will be buffered and issued at the end of the frame.
 
     void TexturedQuad(TextureHandle texHandle, f32 x, f32 y, f32 w, f32 h, int layer, ColourU8 colour, eBlendModes blendMode = eBlendModes::eNormal, eCoordinateSystem coordinateSystem = eCoordinateSystem::eWorld);
+
+    // Draws part of the texture, uv is the top left and bottom right as (u0, v0, u1, v1)
+    void TexturedQuad(TextureHandle texHandle, f32 x, f32 y, f32 w, f32 h, const glm::vec4& uv, int layer, ColourU8 colour, eBlendModes blendMode = eBlendModes::eNormal, eCoordinateSystem coordinateSystem = eCoordinateSystem::eWorld);
     void Rect(f32 x, f32 y, f32 w, f32 h, int layer, ColourU8 colour, eBlendModes blendMode = eBlendModes::eNormal, eCoordinateSystem coordinateSystem = eCoordinateSystem::eWorld);
     void Text(f32 x, f32 y, f32 fontSize, const char* text, ColourU8 colour, int layer, eBlendModes blendMode = eBlendModes::eNormal, eCoordinateSystem coordinateSystem = eCoordinateSystem::eWorld);
     void PathBegin();
@@ -227,6 +253,9 @@ public:
     void FontStashTextureDebug(f32 x, f32 y);
     void TextBounds(f32 x, f32 y, f32 fontSize, const char* text, f32* bounds);
 
+    // Screen space debug drawing that is batched and drawn on top of the game at the end of the frame
+    DebugOverlay& Overlay() { return mDebugOverlay; }
+
 protected:
     struct CmdState
     {
@@ -246,6 +275,7 @@ private:
         eLine,
         eCircleFilled,
         eText,
+        eDebugOverlay,
         eImGuiUi
     };
 
@@ -266,6 +296,7 @@ private:
         f32 mY;
         f32 mW;
         f32 mH;
+        glm::vec4 mUv;
     };
 
     struct CmdRect
@@ -355,6 +386,32 @@ private:
     void HandleTextCommand(f32 dx, f32 dy, f32 fontSize, const char* text, ColourU8* colour, f32* bounds);
 
     void AddUiCmd();
+
+    struct GlyphVertex
+    {
+        ImVec2 mPos;
+        ImVec2 mUv;
+    };
+
+    // Triangles of a debug overlay part as drawn by fontstash at 0,0
+    struct GlyphRun
+    {
+        std::vector<GlyphVertex> mShadow;
+        std::vector<GlyphVertex> mGlyphs;
+        f32 mAdvance = 0.0f;
+    };
+
+    void AddDebugOverlayCmd();
+    void RenderDebugOverlay(ImTextureID& lastTextureId);
+    const GlyphRun& FindGlyphRun(u64 key, f32 fontSize, const char* text);
+    void DrawGlyphRun(const std::vector<GlyphVertex>& vertices, f32 x, f32 y, u32 colour);
+
+    DebugOverlay mDebugOverlay;
+    std::unordered_map<u64, GlyphRun> mGlyphRuns;
+    std::vector<const GlyphRun*> mDebugOverlayRuns;
+
+    // When set FontStashRenderDraw appends to this instead of drawing
+    std::vector<GlyphVertex>* mGlyphCapture = nullptr;
 protected:
     virtual void DestroyTextures() = 0;
  
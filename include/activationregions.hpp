@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include "types.hpp"
+#include "mapobject.hpp"
+#include "debug.hpp"
+
+#include <glm/glm.hpp>
+
+class MapObjectStore;
+
+// Decides which objects run their script Update each frame. Only objects within mRadius camera
+// blocks of the camera subject are awake, the rest are asleep and at most get a SleepUpdate every
+// kSleepTickInterval ticks. Objects flagged as always active (for map wide logic) are never put to
+// sleep. The pass over the store only reads the dense position arrays, so its cost is tiny
+// compared to the script calls it saves, and the number of script calls per frame depends on how
+// crowded the area around the subject is rather than on the size of the map.
+class ActivationRegions
+{
+public:
+    static const s32 kDefaultRadius = 1;
+    static const u32 kSleepTickInterval = 30;
+
+    using Stats = Debug::ActivationStats;
+
+    // With no subject every object is awake
+    void Update(const MapObjectStore& store, const MapObject* subject, const glm::vec2& blockSize);
+    void Update(const MapObjectStore& store, const glm::vec2& subjectPos, const glm::vec2& blockSize);
+    void WakeAll(const MapObjectStore& store);
+
+    // Objects added since the last Update are treated as awake
+    bool IsAwake(MapObjectHandle handle) const
+    {
+        return handle.mSlot >= mAwake.size() || mAwake[handle.mSlot] != 0;
+    }
+
+    // Staggered by slot so that sleeping objects don't all tick on the same frame
+    static bool WantsSleepTick(MapObjectHandle handle, u32 tick)
+    {
+        return ((handle.mSlot + tick) % kSleepTickInterval) == 0;
+    }
+
+    void SetRadius(s32 blocks) { mRadius = blocks; }
+    s32 Radius() const { return mRadius; }
+    const Stats& GetStats() const { return mStats; }
+private:
+    s32 mRadius = kDefaultRadius;
+    Stats mStats = {};
+
+    // Indexed by store slot
+    std::vector<u8> mAwake;
+};
@@ -18,8 +18,18 @@ class AudioConverter
 public:
     AudioConverter() = delete;
 
+    // Stereo frames rendered per block, each block is handed to the encoder in one go
+    static const u32 kDefaultBlockFrames = 16384;
+
     template<class EncoderAlgorithm>
-    static void Convert(ISound& sound, const char* outputName, std::atomic<bool>& quitFlag);
+    static void Convert(ISound& sound, const char* outputName, std::atomic<bool>& quitFlag, u32 blockFrames = kDefaultBlockFrames);
+
+    // Number of interleaved stereo samples left once the trailing silence is chopped off, always
+    // a whole number of frames
+    static u32 TrimTrailingSilence(const f32* samples, u32 numSamples);
+
+    // Splits interleaved left/right samples in to separate channels
+    static void Deinterleave(const f32* samples, u32 numFrames, f32* left, f32* right);
 };
 
 class WavHeader
@@ -80,7 +90,9 @@ public:
     explicit OggEncoder(const char* outputName);
     ~OggEncoder();
     void Consume(float* readbuffer, long bufferSizeInBytes);
-    void Finish() { }
+
+    // Marks the end of the stream, which also flushes the last pages
+    void Finish() { Consume(nullptr, 0); }
 private:
     void InitEncoder();
 
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include "types.hpp"
+#include "abstractrenderer.hpp"
+
+// The cameras of a path in one contiguous x major array, cell (x, y) is at (x * YSize()) + y,
+// along with the layout of the cells in the world. Each cell is a kCameraBlockSize block and its
+// camera image is drawn at kCameraBlockImageOffset inside of that block (which is only non zero
+// for AO). Cells are added in index order while a path loads, so cells that aren't added yet
+// are treated as missing.
+template<class T>
+class CameraGrid
+{
+public:
+    struct Cell
+    {
+        u32 mX;
+        u32 mY;
+    };
+
+    // End is exclusive
+    struct Range
+    {
+        u32 mXStart;
+        u32 mXEnd;
+        u32 mYStart;
+        u32 mYEnd;
+
+        bool Contains(u32 x, u32 y) const
+        {
+            return x >= mXStart && x < mXEnd && y >= mYStart && y < mYEnd;
+        }
+    };
+
+    CameraGrid() = default;
+    CameraGrid(const CameraGrid&) = delete;
+    CameraGrid& operator = (const CameraGrid&) = delete;
+
+    void Reset(u32 xSize, u32 ySize, const glm::vec2& blockSize, const glm::vec2& imageOffset, const glm::vec2& imageSize)
+    {
+        mCells.clear();
+        mCells.reserve(xSize * ySize);
+        mXSize = xSize;
+        mYSize = ySize;
+        mBlockSize = blockSize;
+        mImageOffset = imageOffset;
+        mImageSize = imageSize;
+    }
+
+    void Clear()
+    {
+        mCells.clear();
+        mXSize = 0;
+        mYSize = 0;
+    }
+
+    // Constructs the next cell in index order
+    template<class... Args>
+    T& Add(Args&&... args)
+    {
+        mCells.emplace_back(std::forward<Args>(args)...);
+        return mCells.back();
+    }
+
+    u32 XSize() const { return mXSize; }
+    u32 YSize() const { return mYSize; }
+
+    // Cells added so far
+    u32 Count() const { return static_cast<u32>(mCells.size()); }
+
+    Cell CellOfIndex(u32 index) const { return Cell{ index / mYSize, index % mYSize }; }
+
+    // Null if the cell is outside of the grid or not added yet
+    T* At(u32 x, u32 y)
+    {
+        const u32 index = (x * mYSize) + y;
+        return x < mXSize && y < mYSize && index < mCells.size() ? &mCells[index] : nullptr;
+    }
+
+    const T* At(u32 x, u32 y) const
+    {
+        return const_cast<CameraGrid*>(this)->At(x, y);
+    }
+
+    T* At(const Cell& cell) { return At(cell.mX, cell.mY); }
+    const T* At(const Cell& cell) const { return At(cell.mX, cell.mY); }
+
+    // The cell whose block contains the position, clamped to the edges of the grid
+    Cell CellAt(const glm::vec2& worldPos) const
+    {
+        const glm::vec2 cell = worldPos / mBlockSize;
+        return Cell{ ClampToCell(cell.x, mXSize), ClampToCell(cell.y, mYSize) };
+    }
+
+    // Unlike CellAt positions outside of the grid have no cell
+    bool CellContaining(const glm::vec2& worldPos, Cell& cell) const
+    {
+        const glm::vec2 pos = worldPos / mBlockSize;
+        if (pos.x < 0.0f || pos.y < 0.0f || pos.x >= mXSize || pos.y >= mYSize)
+        {
+            return false;
+        }
+        cell = Cell{ static_cast<u32>(pos.x), static_cast<u32>(pos.y) };
+        return true;
+    }
+
+    glm::vec2 BlockOrigin(u32 x, u32 y) const
+    {
+        return glm::vec2(static_cast<f32>(x), static_cast<f32>(y)) * mBlockSize;
+    }
+
+    // Where the cell's camera image is drawn
+    WorldRect ImageBounds(u32 x, u32 y) const
+    {
+        const glm::vec2 topLeft = BlockOrigin(x, y) + mImageOffset;
+        return WorldRect{ topLeft, topLeft + mImageSize };
+    }
+
+    // Cells whose camera image could overlap the rect
+    Range CellsOverlapping(const WorldRect& rect) const
+    {
+        // Cell x's image covers [x * blockSize + offset, x * blockSize + offset + imageSize]
+        const glm::vec2 start = (rect.mMin - mImageOffset - mImageSize) / mBlockSize;
+        const glm::vec2 end = (rect.mMax - mImageOffset) / mBlockSize;
+        return Range
+        {
+            ClampToRange(start.x, mXSize),
+            ClampToRange(end.x + 1.0f, mXSize),
+            ClampToRange(start.y, mYSize),
+            ClampToRange(end.y + 1.0f, mYSize)
+        };
+    }
+
+    // Cells within radius cells of the one whose block contains the position
+    Range CellsAround(const glm::vec2& worldPos, u32 radius) const
+    {
+        const glm::vec2 cell = glm::floor(worldPos / mBlockSize);
+        const f32 r = static_cast<f32>(radius);
+        return Range
+        {
+            ClampToRange(cell.x - r, mXSize),
+            ClampToRange(cell.x + r + 1.0f, mXSize),
+            ClampToRange(cell.y - r, mYSize),
+            ClampToRange(cell.y + r + 1.0f, mYSize)
+        };
+    }
+
+    // Calls fn(x, y, cell) for every added cell in the range, in index order
+    template<class Fn>
+    void ForEach(const Range& range, Fn fn)
+    {
+        for (u32 x = range.mXStart; x < range.mXEnd; x++)
+        {
+            const u32 columnStart = x * mYSize;
+            const u32 yEnd = std::min(range.mYEnd, Count() > columnStart ? Count() - columnStart : 0u);
+            for (u32 y = range.mYStart; y < yEnd; y++)
+            {
+                fn(x, y, mCells[columnStart + y]);
+            }
+        }
+    }
+
+    template<class Fn>
+    void ForEach(const Range& range, Fn fn) const
+    {
+        const_cast<CameraGrid*>(this)->ForEach(range, [&](u32 x, u32 y, T& cell) { fn(x, y, static_cast<const T&>(cell)); });
+    }
+
+    typename std::vector<T>::iterator begin() { return mCells.begin(); }
+    typename std::vector<T>::iterator end() { return mCells.end(); }
+    typename std::vector<T>::const_iterator begin() const { return mCells.begin(); }
+    typename std::vector<T>::const_iterator end() const { return mCells.end(); }
+    T& operator[](u32 index) { return mCells[index]; }
+    const T& operator[](u32 index) const { return mCells[index]; }
+private:
+    static u32 ClampToCell(f32 pos, u32 count)
+    {
+        // Clamp before converting as the position can be "infinite"
+        return count == 0 ? 0 : static_cast<u32>(glm::clamp(pos, 0.0f, static_cast<f32>(count - 1)));
+    }
+
+    static u32 ClampToRange(f32 pos, u32 count)
+    {
+        return static_cast<u32>(glm::clamp(std::floor(pos), 0.0f, static_cast<f32>(count)));
+    }
+
+    std::vector<T> mCells;
+    u32 mXSize = 0;
+    u32 mYSize = 0;
+    glm::vec2 mBlockSize = glm::vec2(1.0f, 1.0f);
+    glm::vec2 mImageOffset = glm::vec2(0.0f, 0.0f);
+    glm::vec2 mImageSize = glm::vec2(0.0f, 0.0f);
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.hpp"
+#include "gridmap.hpp"
+#include "debug.hpp"
+
+// Keeps the memory used by full size camera textures bounded. Every screen inside the window (the
+// cameras around the subject in game, or the visible ones in the editor) is marked as used each
+// frame. Once the GPU and CPU bytes of all resident screens go over the budget the least recently
+// used screens outside of the window are unloaded, they are loaded again asynchronously when they
+// come back in to the window.
+class CameraResidency
+{
+public:
+    static const u32 kDefaultBudgetBytes = 64 * 1024 * 1024;
+
+    // Cameras either side of the subject's that are loaded ahead of time in game
+    static const u32 kNeighbourRadius = 1;
+
+    CameraResidency(const CameraResidency&) = delete;
+    CameraResidency& operator = (const CameraResidency&) = delete;
+    explicit CameraResidency(ResourceLocator& locator);
+    ~CameraResidency();
+
+    // When prefetch is set every screen in the window starts loading, otherwise only the ones
+    // that get rendered do
+    void Update(AbstractRenderer& rend, const GridMapState& state, const ScreenGrid::Range& window, bool prefetch);
+
+    void SetBudget(u32 bytes) { mBudgetBytes = bytes; }
+    u32 Budget() const { return mBudgetBytes; }
+
+    struct Stats
+    {
+        u32 mResident;
+        u32 mLoading;
+        u32 mGpuBytes;
+        u32 mCpuBytes;
+    };
+    const Stats& GetStats() const { return mStats; }
+    u32 EvictedCount() const { return mEvictedCount; }
+private:
+    void DebugUi();
+
+    ResourceLocator& mLocator;
+    u32 mBudgetBytes = kDefaultBudgetBytes;
+    u32 mFrame = 0;
+    Stats mStats = {};
+    u32 mEvictedCount = 0;
+    std::vector<GridScreen*> mEvictable;
+    Debug::SectionId mDebugSection = 0;
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "types.hpp"
+#include "abstractrenderer.hpp"
+#include "iterativeforloop.hpp"
+
+class GridScreen;
+template<class T> class CameraGrid;
+class ResourceLocator;
+class IFileSystem;
+
+namespace Oddlib
+{
+    class IBits;
+}
+
+// Box filtered, downscaled copies of every camera in a path (with its FG1 layer composited on
+// top) packed in to a single RGB atlas. Decoding every camera of a large path at full size is
+// what made the zoomed out editor slow, so the atlas is built a few cameras per frame and then
+// saved to {CacheDir} so that the next time the path is opened it is a single file read.
+//
+// Level 0 is a quarter of the size of a camera and each level after that halves it again. All
+// the level 0 cells are laid out in a grid at the top of the atlas, with the level 1 and 2 grids
+// side by side under it.
+class CameraThumbnails
+{
+public:
+    static const u32 kLevelCount = 3;
+    static const u32 kCellWidth = 160;
+    static const u32 kCellHeight = 60;
+
+    // Cameras being decoded on other threads ahead of the one being downscaled
+    static const u32 kMaxPendingCameras = 4;
+
+    CameraThumbnails(const CameraThumbnails&) = delete;
+    CameraThumbnails& operator = (const CameraThumbnails&) = delete;
+    CameraThumbnails(ResourceLocator& locator, IFileSystem& fs);
+    ~CameraThumbnails();
+
+    // Called once all of a newly loaded path's screens exist
+    void SetScreens(const CameraGrid<GridScreen>& screens);
+
+    // Downscales the cameras that have finished decoding for at most kMaxExecutionTimeMs, never
+    // waits for a decode. True once the atlas is complete.
+    bool Build();
+    bool IsReady() const { return mState == eStates::eReady; }
+
+    // Picks the smallest level that still has at least as many pixels as a camera covers on screen.
+    // Returns kLevelCount when a camera covers more than twice the pixels of level 0, in which case
+    // the full size camera should be drawn instead.
+    static u32 LevelForScreenWidth(f32 screenWidth);
+
+    // x and y are the camera's position in the path, the atlas is uploaded on first use
+    void Render(AbstractRenderer& rend, u32 x, u32 y, u32 level, f32 xpos, f32 ypos, f32 w, f32 h);
+    void UnloadTexture(AbstractRenderer& rend);
+
+    u32 BuiltCount() const { return mBuiltCount; }
+    u32 CameraCount() const { return static_cast<u32>(mNames.size()); }
+private:
+    void RequestCameras();
+    void BuildCell(u32 index, Oddlib::IBits* cam);
+    void BuildLowerLevels(u32 index);
+    void CellOrigin(u32 index, u32 level, u32& x, u32& y) const;
+    u8* CellPixels(u32 index, u32 level);
+    std::string CacheFileName() const;
+    bool LoadFromCache();
+    void SaveToCache();
+
+    enum class eStates
+    {
+        eNoScreens,
+        eTryCache,
+        eBuilding,
+        eReady
+    };
+    eStates mState = eStates::eNoScreens;
+
+    ResourceLocator& mLocator;
+    IFileSystem& mFs;
+
+    // Camera names in x major order, empty names are blank cameras
+    std::vector<std::string> mNames;
+    u32 mYSize = 0;
+
+    // The names, y size and the data sets they were loaded from, so that changing the data
+    // paths or updating a mod doesn't reuse a stale atlas
+    u64 mCacheKey = 0;
+
+    u32 mColumns = 0;
+    u32 mRows = 0;
+    u32 mAtlasWidth = 0;
+    u32 mAtlasHeight = 0;
+    std::vector<u8> mPixels;
+
+    u32 mBuiltCount = 0;
+    TextureHandle mTexture;
+
+    // Decodes of cameras mBuiltCount onwards in order, blank cameras have an invalid future
+    std::deque<std::future<std::unique_ptr<Oddlib::IBits>>> mPendingCameras;
+    u32 mRequestedCount = 0;
+};
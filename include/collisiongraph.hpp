@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include "types.hpp"
+#include "collisionline.hpp"
+
+#include <glm/glm.hpp>
+
+// Index based connectivity of a path's collision lines, built once the lines are loaded. The
+// raw prev/next links are checked against the geometry so that broken links in the path data
+// are reported instead of silently followed. Floors are also joined to the floor of the same type
+// whose end is within the snap tolerance of theirs, as most floors in the original data have no
+// links at all. Objects standing on a floor can then follow it left or right by index instead of
+// ray casting against every line each frame.
+class CollisionGraph
+{
+public:
+    static const s32 kNoLine = -1;
+    static constexpr f32 kDefaultSnapTolerance = 2.0f;
+
+    // The furthest a floor can be below an object for FloorBelow to still count it as stood on
+    static constexpr f32 kMaxFloorDrop = 4.0f;
+
+    // Floor segments followed by FloorBelow before giving up
+    static const u32 kMaxFollowSteps = 8;
+
+    enum class eDirection
+    {
+        eLeft,
+        eRight
+    };
+
+    struct Segment
+    {
+        glm::vec2 mP1;
+        glm::vec2 mDirection; // Unit vector from P1 to P2
+        f32 mLength;
+        f32 mSlope;           // dy / dx, 0 for vertical lines
+        f32 mMinX;
+        f32 mMaxX;
+        bool mFloor;          // Walkable and not vertical
+
+        // Index form of CollisionLine::mLink, only set when the link is valid
+        s32 mPrevious;
+        s32 mNext;
+
+        // Walkable neighbours of a floor by x rather than by line direction
+        s32 mLeft;
+        s32 mRight;
+    };
+
+    // The lines must not be reordered while the graph is in use, indices are into lines
+    void Build(const CollisionLines& lines, f32 snapTolerance = kDefaultSnapTolerance);
+    void Clear();
+
+    u32 Count() const { return static_cast<u32>(mSegments.size()); }
+    const Segment& At(s32 lineIdx) const { return mSegments[lineIdx]; }
+
+    // The floor joined to the left or right end of lineIdx, or kNoLine
+    s32 NextFloorSegment(s32 lineIdx, eDirection dir) const
+    {
+        const Segment& segment = mSegments[lineIdx];
+        return dir == eDirection::eLeft ? segment.mLeft : segment.mRight;
+    }
+
+    f32 YAt(s32 lineIdx, f32 x) const
+    {
+        const Segment& segment = mSegments[lineIdx];
+        return segment.mP1.y + ((x - segment.mP1.x) * segment.mSlope);
+    }
+
+    // Starting from the floor an object was last on, follows the floor to the one under pos.
+    // Returns kNoLine if pos isn't on or at most kMaxFloorDrop above a floor joined to lineIdx,
+    // in which case the caller has to ray cast.
+    s32 FloorBelow(s32 lineIdx, const glm::vec2& pos) const;
+
+    // Links that were dropped because their ends don't meet
+    u32 BrokenLinkCount() const { return mBrokenLinks; }
+    u32 SnappedJoinCount() const { return mSnappedJoins; }
+private:
+    void ConvertLinks(const CollisionLines& lines, f32 snapTolerance);
+    void JoinFloors(const CollisionLines& lines, f32 snapTolerance);
+
+    std::vector<Segment> mSegments;
+    u32 mBrokenLinks = 0;
+    u32 mSnappedJoins = 0;
+};
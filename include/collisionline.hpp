@@ -108,7 +108,7 @@ public:
     }
 
     static eLineTypes ToType(u16 type);
-    static void Render(AbstractRenderer& rend, const CollisionLines& lines);
+    static void Render(AbstractRenderer& rend, const WorldRect& view, const CollisionLines& lines);
     static s32 Pick(const CollisionLines& lines, const glm::vec2& pos, float lineScale = 1.0f);
     bool IsSelected() const { return mSelected; }
     bool SetSelected(bool selected);
@@ -120,9 +120,12 @@ public:
         float nearestCollisionX = 0;
         float nearestCollisionY = 0;
         float nearestDistance = 0.0f;
+        s32 nearestIndex = -1;
 
+        s32 index = -1;
         for (const std::unique_ptr<CollisionLine>& line : lines)
         {
+            index++;
             bool found = false;
             for (u32 type : collisionTypes)
             {
@@ -174,6 +177,7 @@ public:
                     nearestCollisionY = intersectionY;
                     nearestDistance = distance;
                     nearestLine = line.get();
+                    nearestIndex = index;
                 }
             }
         }
@@ -184,6 +188,7 @@ public:
             {
                 collision->intersection.x = nearestCollisionX;
                 collision->intersection.y = nearestCollisionY;
+                collision->lineIndex = nearestIndex;
             }
             return true;
         }
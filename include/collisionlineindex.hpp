@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include "types.hpp"
+#include "collisionline.hpp"
+#include "abstractrenderer.hpp"
+
+// A uniform grid over the bounding boxes of a path's collision lines, so that the editor's
+// picking and box selection only test the lines in the cells they touch instead of every line.
+// Each cell's line indices are packed in to one array, a line that spans several cells is in
+// each of them. The lines are referred to by index so the index has to be rebuilt whenever
+// lines move, which is done lazily on the next query after Invalidate().
+class CollisionLineIndex
+{
+public:
+    static constexpr f32 kDefaultCellSize = 256.0f;
+
+    void Build(const CollisionLines& lines, f32 cellSize = kDefaultCellSize);
+    void Invalidate() { mDirty = true; }
+
+    // Rebuilds if the lines have changed since the last Build
+    void Update(const CollisionLines& lines)
+    {
+        if (mDirty)
+        {
+            Build(lines, mCellSize);
+        }
+    }
+
+    // Lines that intersect or are inside of the rect, in ascending index order
+    void Query(const CollisionLines& lines, const WorldRect& rect, std::vector<s32>& out) const;
+
+    // Same result as CollisionLine::Pick, the line with the highest index under pos or -1
+    s32 Pick(const CollisionLines& lines, const glm::vec2& pos, f32 lineScale = 1.0f) const;
+
+    u32 CellCount() const { return mXCells * mYCells; }
+private:
+    // Line indices whose bounds overlap rect, each line at most once
+    void Candidates(const WorldRect& rect, std::vector<s32>& out) const;
+
+    u32 ClampedCellX(f32 x) const;
+    u32 ClampedCellY(f32 y) const;
+
+    bool mDirty = true;
+    f32 mCellSize = kDefaultCellSize;
+    glm::vec2 mOrigin;
+    u32 mXCells = 0;
+    u32 mYCells = 0;
+
+    // mCellStart[cell] to mCellStart[cell + 1] is the cell's range in mCellLines
+    std::vector<u32> mCellStart;
+    std::vector<s32> mCellLines;
+
+    // Marks lines already added by the current query, instead of clearing a flag per line
+    mutable std::vector<u32> mVisited;
+    mutable u32 mQueryStamp = 0;
+    mutable std::vector<s32> mCandidates;
+};
@@ -21,6 +21,31 @@ struct Debug
     bool mVsync = true;
     bool mShowDebugUi = true;
     bool mChangeVSync = false;
+    bool mCullToView = true;
+    bool mSleepDistantObjects = true;
+
+    // Filled in while rendering the map, reset at the start of each map render
+    struct CullingStats
+    {
+        u32 mVisibleObjects;
+        u32 mCulledObjects;
+        u32 mVisibleScreens;
+        u32 mCulledScreens;
+        u32 mVisibleLines;
+        u32 mCulledLines;
+        u32 mVisibleObjectRects;
+        u32 mCulledObjectRects;
+    };
+    CullingStats mCulling = {};
+
+    // Copied from the map's ActivationRegions after each game update
+    struct ActivationStats
+    {
+        u32 mAwake;
+        u32 mAsleep;
+        u32 mAlwaysActive;
+    };
+    ActivationStats mActivation = {};
 
     struct BrowserUi
     {
@@ -53,13 +78,26 @@ struct Debug
     void Update(class InputState& input);
     void Render(class AbstractRenderer& renderer);
 
-    void AddSection(std::function<void()> fnSection)
+    using SectionId = u32;
+
+    // The section must be removed before anything it captures is destroyed, this is safe to
+    // do from within a section
+    SectionId AddSection(std::function<void()> fnSection)
     {
-        mSections.push_back(fnSection);
+        mSections.push_back({ mNextSectionId, fnSection });
+        return mNextSectionId++;
     }
 
+    void RemoveSection(SectionId id);
+
 private:
-    std::vector<std::function<void()>> mSections;
+    struct Section
+    {
+        SectionId mId;
+        std::function<void()> mFn;
+    };
+    std::vector<Section> mSections;
+    SectionId mNextSectionId = 1;
 };
 
 Debug& Debugging();
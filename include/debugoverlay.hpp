@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include "types.hpp"
+
+// Debug drawing that there can be hundreds of each frame, such as the bounding box and position
+// string of every animation. Instead of a draw command each these are appended to flat arrays
+// and drawn by AbstractRenderer in one go at the end of the frame, on top of the game.
+//
+// A string is made of parts, each part is laid out by the renderer once and the glyphs are
+// then reused for as long as the part keeps turning up. Numbers are parts of their own keyed by
+// their value, so a position that changes only re-lays out the digits.
+class DebugOverlay
+{
+public:
+    DebugOverlay();
+
+    // Colours are packed as by ColourU8::To32Bit
+    void Rect(f32 x, f32 y, f32 w, f32 h, u32 colour);
+
+    void BeginText(f32 x, f32 y, f32 fontSize, u32 colour);
+    void Append(const char* text);
+    void Append(f32 value);
+    void Append(s32 value);
+    void EndText();
+
+    void Clear();
+    bool Empty() const { return mRectX.empty() && mTextX.empty(); }
+
+    u32 RectCount() const { return static_cast<u32>(mRectX.size()); }
+    u32 TextCount() const { return static_cast<u32>(mTextX.size()); }
+
+    // The parts of text index are [FirstPart(index), FirstPart(index + 1))
+    u32 FirstPart(u32 index) const { return index < TextCount() ? mTextFirstPart[index] : PartCount(); }
+    u32 PartCount() const { return static_cast<u32>(mPartKey.size()); }
+    const char* Part(u32 index) const { return mChars.data() + mPartStart[index]; }
+
+    std::vector<f32> mRectX;
+    std::vector<f32> mRectY;
+    std::vector<f32> mRectW;
+    std::vector<f32> mRectH;
+    std::vector<u32> mRectColour;
+
+    std::vector<f32> mTextX;
+    std::vector<f32> mTextY;
+    std::vector<f32> mTextSize;
+    std::vector<u32> mTextColour;
+    std::vector<u32> mTextFirstPart;
+
+    // Parts that are the same string or number have the same key
+    std::vector<u64> mPartKey;
+private:
+    void AddPart(u64 key, u32 start);
+
+    std::vector<u32> mPartStart;
+    std::vector<char> mChars;
+    bool mInText = false;
+};
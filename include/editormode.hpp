@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gridmap.hpp"
+#include "collisionlineindex.hpp"
 
 class ICommand
 {
@@ -39,6 +40,47 @@ private:
 };
 
 
+// Commands pushed between UndoStack::BeginGroup and EndGroup, undone and redone as one
+class CommandGroup : public ICommandWithId<CommandGroup>
+{
+public:
+    NO_MOVE_OR_MOVE_ASSIGN(CommandGroup);
+
+    explicit CommandGroup(const std::string& name)
+        : mName(name) { }
+
+    void Add(std::unique_ptr<ICommand> cmd) { mCommands.emplace_back(std::move(cmd)); }
+    ICommand* Last() const { return mCommands.empty() ? nullptr : mCommands.back().get(); }
+    u32 Count() const { return static_cast<u32>(mCommands.size()); }
+
+    // Releases the only command so that a group of one doesn't need the wrapper
+    std::unique_ptr<ICommand> TakeFirst() { return std::move(mCommands.front()); }
+
+    virtual void Redo() final
+    {
+        for (auto& cmd : mCommands)
+        {
+            cmd->Redo();
+        }
+    }
+
+    virtual void Undo() final
+    {
+        for (auto it = mCommands.rbegin(); it != mCommands.rend(); ++it)
+        {
+            (*it)->Undo();
+        }
+    }
+
+    virtual std::string Message() final
+    {
+        return mName + " (" + std::to_string(mCommands.size()) + " commands)";
+    }
+private:
+    std::string mName;
+    std::vector<std::unique_ptr<ICommand>> mCommands;
+};
+
 class UndoStack
 {
 public:
@@ -47,17 +89,18 @@ public:
     template<class T, class... Args>
     void PushMerge(bool shouldMerge, Args&&... args)
     {
-        // If the last item on the stack is of the same type we are about to create
-        if (shouldMerge && !mUndoStack.empty() && GenerateTypeId<T>() == mUndoStack.back()->Id() && mUndoStack.back()->CanMerge())
+        // If the last command (in the open group, if there is one) is of the same type we are about to create
+        ICommand* last = LastCommand();
+        if (shouldMerge && last && GenerateTypeId<T>() == last->Id() && last->CanMerge())
         {
             // Undo the last action
-            mUndoStack.back()->Undo();
+            last->Undo();
 
             // Update its internals with the new target data
-            static_cast<T*>(mUndoStack.back().get())->Merge(std::forward<Args>(args)...);
+            static_cast<T*>(last)->Merge(std::forward<Args>(args)...);
 
             // Re-apply with new internals
-            mUndoStack.back()->Redo();
+            last->Redo();
         }
         else
         {
@@ -68,49 +111,109 @@ public:
     template<class T, class... Args>
     void Push(Args&&... args)
     {
-        // If the active index isn't the latest item then remove everything after it
-        if (mCommandIndex != Count())
-        {
-            mUndoStack.erase(mUndoStack.begin() + mCommandIndex, mUndoStack.end());
-        }
-
         // Apply action of new command and add to stack
         auto cmd = std::make_unique<T>(std::forward<Args>(args)...);
-        mUndoStack.emplace_back(std::move(cmd));
-        mUndoStack.back()->Redo();
-
-        // If we are over the stack limit remove the first item to stay within the limit
-        if (mStackLimit != -1 && static_cast<s32>(Count()) > mStackLimit)
-        {
-            mUndoStack.erase(mUndoStack.begin(), mUndoStack.begin() + 1);
-        }
-        else
-        {
-            mCommandIndex++;
-        }
+        cmd->Redo();
+        Add(std::move(cmd));
     }
 
+    // Everything pushed until the matching EndGroup becomes one command on the stack. Groups can
+    // be nested, only the outermost one is added. Undo and Redo close any open group first.
+    void BeginGroup(const std::string& name);
+    void EndGroup();
+    bool InGroup() const { return mGroupDepth > 0; }
+
     void Undo();
     void Redo();
     void Clear();
     u32 Count() const { return static_cast<u32>(mUndoStack.size()); }
     void DebugRenderCommandList() const;
 private:
+    // Adds a command that has already been applied
+    void Add(std::unique_ptr<ICommand> cmd);
+    ICommand* LastCommand() const;
+    void CloseGroup();
+
     std::vector<std::unique_ptr<ICommand>> mUndoStack;
     u32 mCommandIndex = 0;
     s32 mStackLimit = -1;
+
+    std::unique_ptr<CommandGroup> mGroup;
+    u32 mGroupDepth = 0;
 };
 
 
+// A bit per collision line for membership tests plus the selected line indices in the order they
+// were selected. Commands applied to the selection on every mouse move during a drag walk a flat
+// array, and once the storage has grown changing the selection doesn't allocate either.
 class Selection
 {
 public:
-    std::set<s32> Clear(CollisionLines& items);
+    // Returns the lines that were selected, in the order they were selected
+    std::vector<s32> Clear(CollisionLines& items);
     void Select(CollisionLines& items, s32 idx, bool select);
+
+    // Forgets the selection without touching the lines, for when the lines have been replaced
+    void Reset();
+
     bool HasSelection() const { return mSelectedLines.empty() == false; }
-    const std::set<s32>& SelectedLines() const { return mSelectedLines; }
+    bool IsSelected(s32 idx) const
+    {
+        const u32 word = static_cast<u32>(idx) / 64;
+        return word < mBits.size() && (mBits[word] & Bit(idx)) != 0;
+    }
+    const std::vector<s32>& SelectedLines() const { return mSelectedLines; }
 private:
-    std::set<s32> mSelectedLines;
+    static u64 Bit(s32 idx) { return 1ull << (static_cast<u32>(idx) % 64); }
+
+    std::vector<u64> mBits;
+    std::vector<s32> mSelectedLines;
+};
+
+class MoveSelection : public ICommandWithId<MoveSelection>
+{
+public:
+    NO_MOVE_OR_MOVE_ASSIGN(MoveSelection);
+
+    MoveSelection(CollisionLines& lines, Selection& selection, const glm::vec2& delta)
+        : mLines(lines), mSelection(selection), mDelta(delta)
+    {
+
+    }
+
+    void Merge(CollisionLines& /*lines*/, Selection& /*selection*/, const glm::vec2& delta)
+    {
+        mDelta += delta;
+    }
+
+    virtual void Redo() final
+    {
+        for (s32 idx : mSelection.SelectedLines())
+        {
+            mLines[idx]->mLine.mP1 += mDelta;
+            mLines[idx]->mLine.mP2 += mDelta;
+        }
+    }
+
+    virtual void Undo() final
+    {
+        for (s32 idx : mSelection.SelectedLines())
+        {
+            mLines[idx]->mLine.mP1 -= mDelta;
+            mLines[idx]->mLine.mP2 -= mDelta;
+        }
+    }
+
+    virtual std::string Message() final;
+
+    virtual bool CanMerge() const final
+    {
+        return true;
+    }
+private:
+    CollisionLines& mLines;
+    Selection& mSelection;
+    glm::vec2 mDelta;
 };
 
 class EditorMode
@@ -118,7 +221,7 @@ class EditorMode
 public:
     NO_MOVE_OR_MOVE_ASSIGN(EditorMode);
 
-    EditorMode(GridMapState& mapState);
+    EditorMode(GridMapState& mapState, ResourceLocator& locator);
    
 
     /* TODO: Set correct cursors
@@ -139,19 +242,31 @@ public:
 
 private:
 
+    // Selects the lines touching the rect between where the mouse was pressed and released
+    void BoxSelect(const glm::vec2& mousePosWorld, bool addToSelection);
+    WorldRect SelectionBox() const;
+
     Selection mSelection;
     UndoStack mUndoStack;
     bool mMergeCommand = false;
     glm::vec2 mLastMousePos;
 
+    // Picking and box selection query this rather than testing every line
+    CollisionLineIndex mLineIndex;
+    glm::vec2 mBoxStart;
+    glm::vec2 mBoxEnd;
+    std::vector<s32> mBoxLines;
+
     enum class eSelectionState
     {
         eNone,
         eLineP1Selected,
         eLineP2Selected,
         eLineMiddleSelected,
-        eMoveSelected
+        eMoveSelected,
+        eBoxSelect
     };
     eSelectionState mSelectionState = eSelectionState::eNone;
     GridMapState& mMapState;
+    ResourceLocator& mLocator;
 };
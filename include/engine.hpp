@@ -9,6 +9,7 @@
 #include "gamedefinition.hpp"
 #include "abstractrenderer.hpp"
 #include "oddlib/sdl_raii.hpp"
+#include "inputevents.hpp"
 #include <future>
 
 class InputState;
@@ -213,6 +214,9 @@ public:
 
     const Actions& GetActions() const { return mActions; }
 
+    // Used when replaying recorded input instead of mapping it from the devices
+    void SetActions(const Actions& actions) { mActions = actions; }
+
 private:
     Actions mActions;
 };
@@ -429,6 +433,12 @@ public:
     }
 
     const InputMapping& Mapping() const { return mInputMapping; }
+    InputMapping& Mapping() { return mInputMapping; }
+
+    // Published by the engine once a tick's input is final, i.e after a replay has applied its
+    // recorded tick
+    InputEventBus& Events() { return mEvents; }
+    const InputEventBus& Events() const { return mEvents; }
 private:
     void AddController(s32 i)
     {
@@ -450,6 +460,7 @@ private:
 
     std::map<u32, std::unique_ptr<Controller>> mControllers;
     InputMapping mInputMapping;
+    InputEventBus mEvents;
 };
 
 class SquirrelVm
@@ -588,14 +599,40 @@ private:
     void Update();
     void Render();
     bool InitSDL();
-    void AddGameDefinitionsFrom(const char* path);
-    void AddModDefinitionsFrom(const char* path);
-    void AddDirectoryBasedModDefinitionsFrom(std::string path);
-    void AddZipedModDefinitionsFrom(std::string path);
+
+    // A game definition json, or the json of a mod directory or a mod zip that may contain one
+    struct GameDefinitionSource
+    {
+        enum class eTypes
+        {
+            eDefinition,
+            eModDirectory,
+            eModZip
+        };
+
+        eTypes mType;
+
+        // What the cache entry is keyed and stamped by
+        std::string mPath;
+
+        // The directory of an eModDirectory
+        std::string mModPath;
+    };
+    using GameDefinitionSources = std::vector<GameDefinitionSource>;
+
+    void AddGameDefinitionsFrom(GameDefinitionSources& sources, const char* path);
+    void AddModDefinitionsFrom(GameDefinitionSources& sources, const char* path);
+    void AddDirectoryBasedModDefinitionsFrom(GameDefinitionSources& sources, std::string path);
+    void AddZipedModDefinitionsFrom(GameDefinitionSources& sources, std::string path);
+    void LoadGameDefinitions(const GameDefinitionSources& sources);
+    static void ParseGameDefinition(IFileSystem& fs, const GameDefinitionSource& source, GameDefinitionCache::Entry& entry);
     void InitResources();
     void InitImGui();
     void ImGui_WindowResize();
     void RenderLoadingIcon();
+    void SeedGame();
+    void UpdateRunGameState();
+    void OnReplayFinished();
 protected:
     void BindScriptTypes();
     void InitSubSystems();
@@ -631,4 +668,18 @@ protected:
     std::unique_ptr<std::future<void>> mASyncJob;
 
     u32 mGlobalFrameCounter = 0;
+
+    // Set from -record <file> or -replay <file>
+    std::string mRecordFileName;
+    std::string mReplayFileName;
+    std::unique_ptr<class InputRecorder> mInputRecorder;
+    std::unique_ptr<class InputReplayer> mInputReplayer;
+
+    // -profilescripts compiles scripts with line info and starts with the profiler enabled
+    bool mProfileScripts = false;
+    std::unique_ptr<class ScriptProfiler> mScriptProfiler;
+    std::unique_ptr<class ScriptGarbageCollector> mScriptGc;
+
+    // Sleeps out the rest of each frame rather than spinning the loop
+    std::unique_ptr<class FramePacer> mFramePacer;
 };
@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <mutex>
+#include "types.hpp"
 
 namespace Oddlib
 {
@@ -32,6 +33,11 @@ public:
     virtual bool FileExists(std::string& fileName) = 0;
     virtual std::string FsPath() const = 0;
 
+    // Size and last write time of a file, for telling if something cached from it is out of date.
+    // The time is at the finest resolution the OS gives, so only compare it for equality.
+    // False if the file system has no such thing.
+    virtual bool FileStamp(const std::string& /*fileName*/, u64& /*size*/, u64& /*modifiedTime*/) { return false; }
+
     enum EMatchType
     {
         IgnoreCase,
@@ -104,6 +110,8 @@ public:
 
     bool FileExists(std::string& fileName) override;
 
+    bool FileStamp(const std::string& fileName, u64& size, u64& modifiedTime) override;
+
     virtual std::string ExpandPath(const std::string& path) = 0;
 
     void DeleteFile(const std::string& path);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "types.hpp"
+
+// Where FramePacer reads the time from and how it sleeps, the default is
+// SDL_GetPerformanceCounter and std::this_thread::sleep_for. Tests use a fake clock instead.
+class IFrameClock
+{
+public:
+    virtual ~IFrameClock() = default;
+
+    // Ticks per second
+    virtual u64 Frequency() const = 0;
+    virtual u64 Now() const = 0;
+    virtual void SleepUs(f32 us) = 0;
+};
+
+// Holds the engine loop to a fixed frame rate without spinning on the clock for the whole frame.
+// Waiting sleeps until a margin before the frame is due and spin waits the rest, as sleeps can
+// wake up late by anything from a few microseconds to a couple of milliseconds depending on the
+// OS. The margin grows as soon as a sleep overshoots it and slowly shrinks back toward how late
+// sleeps typically are, so an idle engine spends most of each frame asleep.
+class FramePacer
+{
+public:
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator = (const FramePacer&) = delete;
+    explicit FramePacer(u32 framesPerSecond = 60);
+
+    // The clock must outlive the pacer
+    FramePacer(IFrameClock& clock, u32 framesPerSecond);
+
+    // Returns once the next frame is due. If the caller has fallen more than a frame behind the
+    // missed frames are dropped rather than run back to back.
+    void WaitForNextFrame();
+
+    f32 FrameMs() const;
+    f32 MsUntilNextFrame() const;
+
+    // Without sleeping the whole wait is a spin, which is how the loop used to behave
+    void SetSleepEnabled(bool enabled) { mSleepEnabled = enabled; }
+    bool SleepEnabled() const { return mSleepEnabled; }
+
+    // Measured over the last second
+    struct Stats
+    {
+        // Fraction of the time that the loop wasn't asleep, spinning counts as busy
+        f32 mCpuUsage;
+
+        // How late frames started
+        f32 mAverageErrorUs;
+        f32 mMaxErrorUs;
+
+        u32 mFrames;
+        u32 mDroppedFrames;
+    };
+    const Stats& LastStats() const { return mStats; }
+    f32 SpinMarginUs() const { return TicksToUs(mSpinMarginTicks); }
+
+    void DebugUi();
+private:
+    f32 TicksToUs(u64 ticks) const;
+    void AdaptSpinMargin(u64 oversleepTicks);
+    void EndFrame(u64 now);
+
+    static const u32 kInitialSpinMarginUs = 2000;
+    static const u32 kMinSpinMarginUs = 100;
+
+    IFrameClock& mClock;
+    bool mSleepEnabled = true;
+
+    // mClock ticks
+    u64 mFrequency = 0;
+    u64 mPeriodTicks = 0;
+    u64 mNextFrame = 0;
+    u64 mSpinMarginTicks = 0;
+    u64 mMinSpinMarginTicks = 0;
+
+    u64 mWindowStart = 0;
+    u64 mWindowSleptTicks = 0;
+    u64 mWindowErrorTicks = 0;
+    u64 mWindowMaxErrorTicks = 0;
+    u32 mWindowFrames = 0;
+    u32 mWindowDroppedFrames = 0;
+
+    Stats mStats = {};
+};
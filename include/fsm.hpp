@@ -8,41 +8,63 @@
 #include <set>
 #include <map>
 
-// Maps strings to functions
+// Maps strings to functions, each function also gets a dense id when added so that compiled
+// states can call it without looking its name up
 template<class ReturnType, class FunctionType>
 class FunctionMap final
 {
 public:
     using TEventFuncPtr = std::function < ReturnType(FunctionType) >;
 
+    static const s32 kNoFunction = -1;
+
     void Add(const char* functionName, TEventFuncPtr function)
     {
-        const auto it = mFunctions.find(functionName);
-        if (it != std::end(mFunctions))
+        const auto it = mIds.find(functionName);
+        if (it != std::end(mIds))
         {
             LOG_ERROR("Function: " << functionName << " already added");
         }
         else
         {
-            mFunctions.insert(std::make_pair(functionName, function));
+            mIds.insert(std::make_pair(functionName, static_cast<s32>(mFunctions.size())));
+            mFunctions.push_back(function);
+        }
+    }
+
+    s32 IdOf(const std::string& method) const
+    {
+        const auto it = mIds.find(method);
+        return it != std::end(mIds) ? it->second : kNoFunction;
+    }
+
+    ReturnType Call(s32 id, class FsmArgumentStack& stack)
+    {
+        if (id == kNoFunction)
+        {
+            return ReturnType();
         }
+        return mFunctions[id](stack);
     }
 
     ReturnType Evaluate(const std::string& method, class FsmArgumentStack& stack)
     {
-        const auto it = mFunctions.find(method);
-        if (it != std::end(mFunctions))
+        const s32 id = IdOf(method);
+        if (id == kNoFunction)
         {
-            return it->second(stack);
+            LOG_ERROR("Missing function: " << method.c_str());
         }
-        LOG_ERROR("Missing function: " << method.c_str());
-        return ReturnType();
+        return Call(id, stack);
     }
 
 private:
-    std::map<std::string, TEventFuncPtr> mFunctions;
+    std::map<std::string, s32> mIds;
+    std::vector<TEventFuncPtr> mFunctions;
 };
 
+template<class ReturnType, class FunctionType>
+const s32 FunctionMap<ReturnType, FunctionType>::kNoFunction;
+
 // This is only sort of a stack, you push arguments for the state action/condition, then during
 // FSM execution the pops happen but don't actually remove anything, and before any pops reset is called
 // which makes up start "fake" popping from the top of the stack again.
@@ -63,22 +85,37 @@ private:
 };
 
 // Calls a function from FunctionMap by name, and allows adding
-// of arguments to be passed to said function via a stack.
+// of arguments to be passed to said function via a stack. A leading '!'
+// in the name negates a condition.
 template<class T, class ReturnType>
 class FsmExecutor final
 {
 public:
-    FsmExecutor(const std::string& name) : mName(name) { }
+    FsmExecutor(const std::string& name)
+        : mNegate(!name.empty() && name[0] == '!'), mName(mNegate ? name.substr(1) : name) { }
+
+    // Resolves the name to the function's id, returns false if there is no such function
+    bool Compile(const T& functions)
+    {
+        mId = functions.IdOf(mName);
+        return Resolved();
+    }
+
+    bool Resolved() const { return mId != T::kNoFunction; }
 
     ReturnType Execute(T& functions)
     {
         mArguments.Reset();
-        return functions.Evaluate(mName, mArguments);
+        return functions.Call(mId, mArguments);
     }
 
+    bool Negated() const { return mNegate; }
+    const std::string& Name() const { return mName; }
     FsmArgumentStack& Arguments() { return mArguments; }
 private:
+    bool mNegate;
     std::string mName;
+    s32 mId = T::kNoFunction;
     FsmArgumentStack mArguments;
 };
 
@@ -87,15 +124,20 @@ using TConditions = FunctionMap < bool, FsmArgumentStack& >;
 using StateCondition = FsmExecutor < TConditions, bool >;
 using StateAction = FsmExecutor < TActions, void >;
 
+static const s32 kNoFsmState = -1;
+
 class FsmStateTransition final
 {
 public:
     FsmStateTransition(const std::string& name) : mTargetStateName(name) { }
     void AddCondition(StateCondition condition);
+    bool Compile(const TConditions& conditions, s32 targetState);
     bool Evaulate(TConditions& events);
     const std::string& Name() const { return mTargetStateName; }
+    s32 TargetState() const { return mTargetState; }
 private:
     std::string mTargetStateName;
+    s32 mTargetState = kNoFsmState;
     std::vector<StateCondition> mConditions;
 };
 
@@ -103,8 +145,11 @@ class FsmState final
 {
 public:
     FsmState(const std::string& name) : mStateName(name) { }
+    bool Compile(const TActions& actions, const TConditions& conditions, const std::map<std::string, s32>& stateIds);
     void Enter(TActions& actions);
-    const std::string* Update(TConditions& states);
+
+    // The id of the state to move to, or kNoFsmState to stay in this one
+    s32 Update(TConditions& states);
     const std::string& Name() const { return mStateName; }
     void AddEnterAction(StateAction action) { mEnterActions.push_back(action); }
     void AddTransition(FsmStateTransition transition) { mTransistions.push_back(transition); }
@@ -114,18 +159,30 @@ private:
     std::vector<FsmStateTransition> mTransistions;
 };
 
+// States are added by name, then Compile resolves every state, action and condition name to
+// an id once so that Update never compares or hashes strings.
 class FiniteStateMachine final
 {
 public:
     FiniteStateMachine() = default;
     void Construct();
+    void AddState(FsmState state) { mStates.push_back(state); }
+
+    // Must be called after all states, actions and conditions have been added. Returns false
+    // if anything refers to a missing state or function, these are logged. A transition to a
+    // missing state or with a missing condition (negated or not) is never taken, a missing
+    // action does nothing.
+    bool Compile();
     void Update();
     bool ToState(const char* stateName);
+    bool ToState(s32 stateId);
+    s32 ActiveState() const { return mActiveState; }
+    const std::string& StateName(s32 stateId) const { return mStates[stateId].Name(); }
     TConditions& Conditions() { return mConditions; }
     TActions& Actions() { return mActions; }
 private:
     std::vector<FsmState> mStates;
     TConditions mConditions;
     TActions mActions;
-    FsmState* mActiveState = nullptr;
+    s32 mActiveState = kNoFsmState;
 };
@@ -420,6 +420,9 @@ public:
     bool Hidden() const { return mHidden; }
     bool IsMod() const { return mIsMod; }
     const std::string ContainingArchive() const { return mContainingArchive; }
+
+    void Write(Oddlib::IStream& stream) const;
+    void Read(Oddlib::IStream& stream);
 private:
 
     void Parse(const std::string& json);
@@ -434,3 +437,27 @@ private:
     bool mIsMod = false;
     std::string mContainingArchive;
 };
+
+// Game definitions as they were parsed from each definition file or mod zip, saved to {CacheDir}.
+// An entry is only used while the size and last write time of its source still match, so at
+// startup the definitions that haven't changed cost a stat instead of an open and a json parse.
+class GameDefinitionCache
+{
+public:
+    struct Entry
+    {
+        std::string mPath;
+        u64 mSize = 0;
+        u64 mModifiedTime = 0;
+
+        // False for a zip that turned out not to be a mod
+        bool mHasDefinition = false;
+        GameDefinition mDefinition;
+    };
+
+    bool Load(IFileSystem& fs, const std::string& fileName);
+    void Save(IFileSystem& fs, const std::string& fileName) const;
+    const Entry* Find(const std::string& path, u64 size, u64 modifiedTime) const;
+
+    std::vector<Entry> mEntries;
+};
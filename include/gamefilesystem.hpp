@@ -2,7 +2,28 @@
 
 #include "filesystem.hpp"
 #include <string>
-#include <map>
+#include <vector>
+
+// Named directories such as {GameDir} that paths are expanded against. GameFileSystem fills it in
+// once in Init and never changes it afterwards, so paths can be expanded without locking.
+class NamedPaths
+{
+public:
+    void Add(const std::string& name, const std::string& path);
+    const std::string* Find(const std::string& name) const;
+
+    // Replaces the named directories in path and normalizes the slashes in one pass. out is
+    // overwritten so that a caller expanding lots of paths can reuse its buffer.
+    void Expand(const std::string& path, std::string& out) const;
+private:
+    struct Entry
+    {
+        std::string mName;
+        std::string mPath;
+    };
+    std::vector<Entry> mEntries;
+    size_t mLongestPath = 0;
+};
 
 class GameFileSystem : public OSBaseFileSystem
 {
@@ -17,6 +38,7 @@ public:
     std::string InitCachePath();
     std::string InitBasePath();
     virtual std::string ExpandPath(const std::string& path) override final;
+    void ExpandPath(const std::string& path, std::string& out) const { mNamedPaths.Expand(path, out); }
 private:
-    std::map<std::string, std::string> mNamedPaths;
+    NamedPaths mNamedPaths;
 };
@@ -7,10 +7,11 @@ class GameMode
 public:
     NO_MOVE_OR_MOVE_ASSIGN(GameMode);
 
-    GameMode(GridMapState& mapState);
+    GameMode(GridMapState& mapState, ResourceLocator& locator);
 
     void Update(const InputState& input, CoordinateSpace& coords);
     void Render(AbstractRenderer& rend) const;
 private:
     GridMapState& mMapState;
+    ResourceLocator& mLocator;
 };
@@ -13,6 +13,10 @@ public:
     void Render(AbstractRenderer& renderer);
     EngineStates Update(const InputState& input, CoordinateSpace& coords);
     const GameDefinition& SelectedGame() const { return *mVisibleGameDefinitions[mSelectedGameDefintionIndex]; }
+
+    // For starting a game without the UI, i.e when replaying recorded input
+    bool SelectGame(const std::string& gameName);
+    EngineStates StartSelectedGame();
 private:
     void UpdateVisibleGameDefinitions();
     EngineStates RenderSelectGame();
@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <deque>
+#include <future>
 #include <iomanip>
 #include <sstream>
 #include "core/audiobuffer.hpp"
@@ -11,14 +12,22 @@
 #include "fsm.hpp"
 #include "abstractrenderer.hpp"
 #include "collisionline.hpp"
+#include "collisiongraph.hpp"
 #include "proxy_sqrat.hpp"
 #include "mapobject.hpp"
+#include "mapobjectstore.hpp"
+#include "camerathumbnails.hpp"
+#include "activationregions.hpp"
+#include "cameragrid.hpp"
 #include "imgui/imgui.h"
 #include "iterativeforloop.hpp"
+#include "debug.hpp"
 
 class AbstractRenderer;
 class ResourceLocator;
 class InputState;
+class StateHash;
+class IFileSystem;
 
 namespace Oddlib { class LvlArchive; class IBits; }
 
@@ -29,6 +38,7 @@ class IMap
 public:
     virtual ~IMap() = default;
     virtual const CollisionLines& Lines() const = 0;
+    virtual const CollisionGraph& Graph() const = 0;
 };
 
 class Sound;
@@ -41,15 +51,18 @@ public:
     ~Level()
     {
         TRACE_ENTRYEXIT;
+        Debugging().RemoveSection(mDebugSection);
     }
-    Level(ResourceLocator& locator);
+    Level(ResourceLocator& locator, IFileSystem& fs);
     bool LoadMap(const Oddlib::Path& path);
     void Update(const InputState& input, CoordinateSpace& coords);
     void Render(AbstractRenderer& rend);
+    void AddToStateHash(StateHash& hash) const;
 private:
     void RenderDebugPathSelection();
     std::unique_ptr<class GridMap> mMap;
     ResourceLocator& mLocator;
+    Debug::SectionId mDebugSection = 0;
 public:
     void UnloadMap(AbstractRenderer& renderer);
 };
@@ -57,30 +70,69 @@ public:
 class GridScreen
 {
 public:
+    // Camera names are always an 8 character stem followed by .CAM
+    static const u32 kNameSize = 8;
+
     GridScreen(const GridScreen&) = delete;
     GridScreen& operator = (const GridScreen&) = delete;
-    GridScreen(const Oddlib::Path::Camera& camera, ResourceLocator& locator);
+    GridScreen& operator = (GridScreen&&) = delete;
+    GridScreen(GridScreen&& other);
+    explicit GridScreen(const Oddlib::Path::Camera& camera);
     ~GridScreen();
-    const std::string& FileName() const { return mFileName; }
-    void LoadTextures(AbstractRenderer& rend);
+
+    // Built from the stem on demand, empty for blank cameras
+    std::string FileName() const;
+
+    // Blocks until the textures exist, waiting for a load already in flight if there is one
+    void LoadTextures(AbstractRenderer& rend, ResourceLocator& locator);
+
+    // Starts decoding the camera on a worker thread unless it is resident or already loading
+    void RequestTextures(ResourceLocator& locator);
+
+    // Creates the textures if a requested load has finished, never blocks
+    void FinishLoading(AbstractRenderer& rend);
+
+    // Frees the textures and the decoded camera
     void UnLoadTextures(AbstractRenderer& rend);
-    bool hasTexture() const;
-    const Oddlib::Path::Camera &getCamera() const { return mCamera; }
-    void Render(AbstractRenderer& rend, float x, float y, float w, float h);
+
+    bool IsResident() const { return mTexHandle.IsValid(); }
+    bool IsLoading() const { return mPendingCam.valid(); }
+    u32 GpuBytes() const { return mGpuBytes; }
+    u32 CpuBytes() const { return mCpuBytes; }
+    u32 LastUsedFrame() const { return mLastUsedFrame; }
+    void MarkUsed(u32 frame) { mLastUsedFrame = frame; }
+
+    bool hasTexture() const { return mHasTexture; }
+    const std::vector<Oddlib::Path::MapObject>& Objects() const { return mObjects; }
+
+    // Textures are loaded asynchronously, so nothing is drawn until they exist
+    void Render(AbstractRenderer& rend, ResourceLocator& locator, float x, float y, float w, float h);
 private:
-    std::string mFileName;
+    void CreateTextures(AbstractRenderer& rend, std::unique_ptr<Oddlib::IBits> cam);
+
+    char mName[kNameSize];
+    bool mHasTexture = false;
     TextureHandle mTexHandle;
     TextureHandle mTexHandle2;
 
     // TODO: This is not the in-game format
-    Oddlib::Path::Camera mCamera;
+    std::vector<Oddlib::Path::MapObject> mObjects;
 
-    // Temp hack to prevent constant reloading of LVLs
+    // Kept for as long as the textures are resident, counted in mCpuBytes
     std::unique_ptr<Oddlib::IBits> mCam;
+    std::future<std::unique_ptr<Oddlib::IBits>> mPendingCam;
 
-    ResourceLocator& mLocator;
+    // Set when the screen is unloaded whilst its camera is still being decoded, the result is
+    // thrown away unless the screen is requested again before it arrives. The future isn't reset
+    // as that would block until the decode is done.
+    bool mPendingAbandoned = false;
+
+    u32 mGpuBytes = 0;
+    u32 mCpuBytes = 0;
+    u32 mLastUsedFrame = 0;
 };
 
+using ScreenGrid = CameraGrid<GridScreen>;
 
 #define NO_MOVE_OR_MOVE_ASSIGN(x)  x(x&&) = delete; x& operator = (x&&) = delete
 
@@ -102,13 +154,26 @@ public:
     glm::vec2 mCameraPosition;
     MapObject* mCameraSubject = nullptr;
 
-    std::deque<std::deque<std::unique_ptr<GridScreen>>> mScreens;
+    // Mutable as rendering streams the textures in
+    mutable ScreenGrid mScreens;
+
+    // Drawn instead of the full size cameras when the editor is zoomed out
+    std::unique_ptr<CameraThumbnails> mThumbnails;
 
     // CollisionLine contains raw pointers to other CollisionLine objects. Hence the vector
     // has unique_ptrs so that adding or removing to this vector won't cause the raw pointers to dangle.
     CollisionLines mCollisionItems;
+
+    // Indexed the same as mCollisionItems, rebuilt when going back to the game as the editor can move lines
+    CollisionGraph mCollisionGraph;
+
+    // Must outlive mObjs, each MapObject removes itself from the store when destroyed
+    MapObjectStore mObjectStore;
     std::vector<std::unique_ptr<MapObject>> mObjs;
 
+    // Which of mObjs get a full update in game
+    ActivationRegions mActivation;
+
     enum class eStates
     {
         eInGame,
@@ -118,26 +183,34 @@ public:
     };
 
     eStates mState = eStates::eInGame;
+
+    // In ticks rather than wall clock time so that replayed input switches on the same tick
+    u32 mTickCounter = 0;
     u32 mModeSwitchTimeout = 0;
 
     void RenderDebug(AbstractRenderer& rend) const;
+
+    // The view to cull against, or everything when culling is turned off in the debug UI
+    WorldRect CullRect(AbstractRenderer& rend) const;
+
     void DebugRayCast(AbstractRenderer& rend, const glm::vec2& from, const glm::vec2& to, u32 collisionType, const glm::vec2& fromDrawOffset = glm::vec2()) const;
 private:
     void RenderGrid(AbstractRenderer& rend) const;
 };
 
-constexpr u32 kSwitchTimeMs = 300;
+constexpr u32 kSwitchTimeTicks = 18; // 300ms at 60 ticks per second
 
 class GridMap : public IMap
 {
 public:
     GridMap(const GridMap&) = delete;
     GridMap& operator = (const GridMap&) = delete;
-    GridMap();
+    GridMap(ResourceLocator& locator, IFileSystem& fs);
     ~GridMap();
     bool LoadMap(const Oddlib::Path& path, ResourceLocator& locator);
     void Update(const InputState& input, CoordinateSpace& coords);
     void Render(AbstractRenderer& rend) const;
+    void AddToStateHash(StateHash& hash) const;
     static void RegisterScriptBindings();
 private:
     class Loader
@@ -173,6 +246,9 @@ private:
 
         void SetState(LoaderStates state);
     };
+
+    // Declared before the loader as the loader can own a MapObject that lives in the map state's store
+    GridMapState mMapState;
     Loader mLoader;
 
     MapObject* GetMapObject(s32 x, s32 y, const char* type);
@@ -181,12 +257,13 @@ private:
     void RenderToEditorOrToGame(AbstractRenderer& rend) const;
 
     virtual const CollisionLines& Lines() const override final { return mMapState.mCollisionItems; }
+    virtual const CollisionGraph& Graph() const override final { return mMapState.mCollisionGraph; }
 
-    void ConvertCollisionItems(const std::vector<Oddlib::Path::CollisionItem>& items);
+    void ConvertCollisionItems(const Oddlib::Path::CollisionItems& items);
 
-    GridMapState mMapState;
     std::unique_ptr<class EditorMode> mEditorMode;
     std::unique_ptr<class GameMode> mGameMode;
+    std::unique_ptr<class CameraResidency> mResidency;
     InstanceBinder<class GridMap> mScriptInstance;
 public:
     void UnloadMap(AbstractRenderer& renderer);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "replay.hpp"
+#include "types.hpp"
+
+class InputState;
+
+// A key, mouse button or action that went down or up on a tick
+struct InputEvent
+{
+    enum class eTypes : u32
+    {
+        eKeyPressed,
+        eKeyReleased,
+        eMouseButtonPressed,
+        eMouseButtonReleased,
+        eActionPressed,
+        eActionReleased
+    };
+
+    eTypes mType;
+
+    // SDL_Scancode, mouse button index or Actions::EInputActions
+    u32 mCode;
+};
+
+// Publishes each tick's input once it is final. The snapshot of the tick is kept in a ring
+// buffer along with the previous kHistoryTicks - 1, and its pressed and released edges are
+// worked out once up front. Subscribers are registered for a given key or action edge, so
+// handling a tick only costs as much as what actually changed rather than every consumer
+// checking every key it cares about.
+class InputEventBus
+{
+public:
+    static const u32 kHistoryTicks = 64;
+
+    using SubscriptionId = u32;
+    using Handler = std::function<void(const InputEvent&)>;
+
+    InputEventBus(const InputEventBus&) = delete;
+    InputEventBus& operator = (const InputEventBus&) = delete;
+    InputEventBus() = default;
+
+    void Publish(const InputState& input);
+    void Publish(const InputSnapshot& snapshot);
+
+    // Handlers are called from Publish in the order they subscribed. Whilst being called they
+    // may subscribe to any edge, a handler added to the edge being dispatched is called for it
+    // too, and they may unsubscribe themselves or others.
+    SubscriptionId Subscribe(InputEvent::eTypes type, u32 code, Handler handler);
+    void Unsubscribe(SubscriptionId id);
+
+    // Number of ticks published so far
+    u32 Tick() const { return mTick; }
+
+    // ticksAgo must be less than HistorySize(), 0 is the tick last published
+    const InputSnapshot& Snapshot(u32 ticksAgo = 0) const;
+    u32 HistorySize() const { return mTick < kHistoryTicks ? mTick : kHistoryTicks; }
+
+    // The edges of the tick last published
+    const std::vector<InputEvent>& Events() const { return mEvents; }
+
+    // For input buffering, e.g jump pressed slightly before landing still counts. Checks the
+    // last ticks ticks including the current one.
+    bool KeyPressedWithin(u32 key, u32 ticks) const;
+    bool ActionPressedWithin(u32 action, u32 ticks) const;
+private:
+    void AddKeyEvents(const std::bitset<SDL_NUM_SCANCODES>& keys, InputEvent::eTypes type);
+    void AddActionEvents(u32 actions, InputEvent::eTypes type);
+    void Dispatch();
+
+    static u32 SubscriberKey(InputEvent::eTypes type, u32 code)
+    {
+        return (static_cast<u32>(type) << 16) | code;
+    }
+
+    std::array<InputSnapshot, kHistoryTicks> mHistory;
+    u32 mTick = 0;
+    std::vector<InputEvent> mEvents;
+
+    struct Subscriber
+    {
+        SubscriptionId mId;
+        Handler mHandler;
+    };
+    std::unordered_map<u32, std::vector<Subscriber>> mSubscribers;
+    SubscriptionId mNextId = 1;
+
+    // Unsubscribing whilst dispatching only clears the handler, they're removed afterwards
+    bool mDispatching = false;
+    bool mHaveUnsubscribed = false;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "types.hpp"
 #include "proxy_sqrat.hpp"
 #include "logger.hpp"
@@ -35,6 +36,15 @@ class AbstractRenderer;
 class Animation;
 class ResourceLocator;
 class IMap;
+class StateHash;
+class MapObjectStore;
+
+// Stays valid while other objects are added and removed, unlike the dense index it maps to
+struct MapObjectHandle
+{
+    u32 mSlot = 0xFFFFFFFF;
+    u32 mGeneration = 0;
+};
 
 struct CollisionResult
 {
@@ -51,10 +61,7 @@ class MapObject
 {
 public:
     MapObject() = delete;
-    MapObject(ResourceLocator& locator, const ObjRect& rect)
-        : mLocator(locator), mRect(rect)
-    {
-    }
+    MapObject(ResourceLocator& locator, MapObjectStore& store, const ObjRect& rect, MapObjectHandle parent = MapObjectHandle());
 
     MapObject(const MapObject&) = delete;
     MapObject(MapObject&& other) = delete;
@@ -65,6 +72,9 @@ public:
 
     void LoadAnimation(const std::string& name);
 
+    // Adds an animation that has already been located, the returned pointer is only valid until the next one is added
+    Animation* AddAnimation(const std::string& name, Animation anim);
+
     void SetScriptInstance(Sqrat::Object obj)
     {
         TRACE_ENTRYEXIT;
@@ -73,7 +83,10 @@ public:
 
     bool Init();
     void Update(const InputState& input);
-    void Render(AbstractRenderer& rend, int x, int y, float scale, int layer) const;
+
+    // Called every ActivationRegions::kSleepTickInterval ticks instead of Update while asleep,
+    // only does anything if the script defines SleepUpdate
+    void SleepUpdate();
     void ReloadScript();
     static void RegisterScriptBindings();
 
@@ -83,8 +96,18 @@ public:
     // TODO: Shouldn't be part of this object
     void SnapXToGrid();
 
-    float mXPos = 50.0f;
-    float mYPos = 100.0f;
+    // Hot state lives in the MapObjectStore
+    f32 XPos() const;
+    f32 YPos() const;
+    void SetXPos(f32 xpos);
+    void SetYPos(f32 ypos);
+    bool FacingLeft() const;
+    bool FacingRight() const { return !FacingLeft(); }
+    MapObjectHandle Handle() const { return mHandle; }
+
+    // Always active objects are updated every tick wherever they are
+    void SetAlwaysActive(bool alwaysActive);
+    bool AlwaysActive() const;
 
     s32 Id() const { return mId; }
     bool WallCollision(IMap& map, f32 dx, f32 dy) const;
@@ -96,6 +119,9 @@ public:
     u32 ChildCount() const;
     Sqrat::Object& ChildAt(u32 index);
     void RemoveChild(u32 index);
+
+    // Position, facing, animation and frame of this object and its children, with the script slots named in its kStateHashSlots
+    void AddToStateHash(StateHash& hash) const;
 private:
     class Loader
     {
@@ -121,8 +147,13 @@ private:
     using UP_Loader = std::unique_ptr<Loader>;
     UP_Loader mLoader;
 
-    std::map<std::string, std::shared_ptr<Animation>> mAnims;
-    Animation* mAnim = nullptr;
+    // Playback cursors of the loaded animations, the frame data is shared with every other
+    // object using the same animation. An object only ever has a handful so they're searched.
+    std::vector<std::string> mAnimNames;
+    std::vector<Animation> mAnims;
+    Animation* FindAnimation(const std::string& name);
+    Animation* CurrentAnimation() const;
+    void SetCurrentAnimation(Animation* anim);
 
     void LoadScript();
 private: // Actions
@@ -130,24 +161,25 @@ private: // Actions
     void SetAnimation(const std::string& animation);
     void SetAnimationFrame(s32 frame);
     void SetAnimationAtFrame(const std::string& animation, u32 frame);
-    bool FacingLeft() const { return mFlipX; }
-    bool FacingRight() const { return !FacingLeft(); }
-    void FlipXDirection() { mFlipX = !mFlipX; }
+    void FlipXDirection();
 private:
     bool AnimUpdate();
     s32 FrameCounter() const;
     s32 NumberOfFrames() const;
     bool IsLastFrame() const;
     s32 FrameNumber() const;
-public:
-    bool mFlipX = false;
 private:
     ResourceLocator& mLocator;
+    MapObjectStore& mStore;
+    MapObjectHandle mHandle;
     std::string mScriptName;
     std::string mName;
     s32 mId = 0;
-    ObjRect mRect;
     Sqrat::Object mScriptObject; // Derived script object instance
 
     std::vector<UP_MapObject> mChildren;
+
+    // Collision line index of the floor last found by FloorCollision, it is followed through the
+    // map's CollisionGraph so that walking along a floor doesn't need a ray cast each frame
+    mutable s32 mFloorLine = -1;
 };
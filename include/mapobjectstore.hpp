@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include "types.hpp"
+#include "mapobject.hpp"
+
+class Animation;
+class AbstractRenderer;
+struct WorldRect;
+
+// Holds the state that the per frame loops touch (position, facing, current animation and
+// bounds) in parallel arrays so that they walk memory linearly instead of chasing MapObject
+// pointers. MapObject keeps the cold state (script instance, names, animation map) and reads
+// and writes its hot state through a handle. Removal moves the last object in to the hole so
+// the arrays are always dense and in no particular order. Render doesn't draw in array order
+// but in the order MapObject::Render used to recurse in: each root in creation order, followed
+// by its children depth first.
+class MapObjectStore
+{
+public:
+    MapObjectStore() = default;
+    MapObjectStore(const MapObjectStore&) = delete;
+    MapObjectStore& operator = (const MapObjectStore&) = delete;
+
+    // A child is drawn after its parent and the parent's older children
+    MapObjectHandle Add(MapObject* owner, const ObjRect& rect, MapObjectHandle parent = MapObjectHandle());
+    void Remove(MapObjectHandle handle);
+    // Like Remove but returns false for a stale handle instead of throwing, for use from destructors
+    bool TryRemove(MapObjectHandle handle);
+    bool IsValid(MapObjectHandle handle) const;
+
+    // Index in to the dense arrays, only valid until the next Add or Remove
+    u32 Index(MapObjectHandle handle) const { return mSlotToIndex[handle.mSlot]; }
+    u32 Count() const { return static_cast<u32>(mOwner.size()); }
+
+    // Slots are stable for the lifetime of an object, unlike the index
+    u32 Slot(u32 index) const { return mIndexToSlot[index]; }
+    u32 SlotCount() const { return static_cast<u32>(mSlotGeneration.size()); }
+
+    // Slots in the order Render draws them, only rebuilt after an Add or Remove
+    const std::vector<u32>& DrawOrder() const;
+
+    // Draws every object that has an animation set and overlaps the view
+    void Render(AbstractRenderer& rend, const WorldRect& view, int x, int y, float scale, int layer) const;
+
+    std::vector<f32> mXPos;
+    std::vector<f32> mYPos;
+    std::vector<u8> mFlipX;
+    std::vector<Animation*> mAnim;
+    std::vector<ObjRect> mRect;
+    std::vector<u8> mAlwaysActive;
+    std::vector<MapObject*> mOwner;
+private:
+    std::vector<u32> mSlotToIndex;
+    std::vector<u32> mIndexToSlot;
+    std::vector<u32> mSlotGeneration;
+    std::vector<u32> mFreeSlots;
+
+    // Per slot, for the draw order
+    std::vector<MapObjectHandle> mSlotParent;
+    std::vector<u32> mSlotSequence;
+    u32 mNextSequence = 0;
+
+    mutable std::vector<u32> mDrawOrder;
+    mutable bool mDrawOrderDirty = false;
+};
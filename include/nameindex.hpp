@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include "types.hpp"
+
+// Finds the index of a name in a vector owned by someone else, using open addressing with linear
+// probing. Only the name's hash and its index are stored, a probe that matches the hash is
+// confirmed by comparing against the owner's name for that index. Lookups take a C string so
+// callers don't have to build a std::string just to find something. If a name is inserted more
+// than once the first index is kept, the same as a linear search from the front.
+class NameIndex
+{
+public:
+    static const s32 kNotFound = -1;
+
+    void Clear()
+    {
+        mSlots.clear();
+        mCount = 0;
+    }
+
+    // getName(index) returns the name of the owner's item at index
+    template<class GetName>
+    void Insert(s32 index, GetName getName)
+    {
+        // Keep the table at most half full so that probe sequences stay short
+        if ((mCount + 1) * 2 > mSlots.size())
+        {
+            Grow(getName);
+        }
+        InsertHashed(Hash(getName(index).c_str()), index, getName);
+    }
+
+    template<class GetName>
+    s32 Find(const char* name, GetName getName) const
+    {
+        if (mSlots.empty())
+        {
+            return kNotFound;
+        }
+
+        const u32 hash = Hash(name);
+        const u32 mask = static_cast<u32>(mSlots.size()) - 1;
+        for (u32 slot = hash & mask; ; slot = (slot + 1) & mask)
+        {
+            const Slot& s = mSlots[slot];
+            if (s.mIndex == kNotFound)
+            {
+                return kNotFound;
+            }
+
+            if (s.mHash == hash && getName(s.mIndex) == name)
+            {
+                return s.mIndex;
+            }
+        }
+    }
+
+    u32 Count() const { return mCount; }
+
+    // FNV-1a
+    static u32 Hash(const char* str)
+    {
+        u32 hash = 2166136261u;
+        for (; *str; str++)
+        {
+            hash ^= static_cast<u8>(*str);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+private:
+    struct Slot
+    {
+        u32 mHash;
+        s32 mIndex;
+    };
+
+    template<class GetName>
+    void InsertHashed(u32 hash, s32 index, GetName getName)
+    {
+        const u32 mask = static_cast<u32>(mSlots.size()) - 1;
+        for (u32 slot = hash & mask; ; slot = (slot + 1) & mask)
+        {
+            Slot& s = mSlots[slot];
+            if (s.mIndex == kNotFound)
+            {
+                s = Slot{ hash, index };
+                mCount++;
+                return;
+            }
+
+            if (s.mHash == hash && getName(s.mIndex) == getName(index))
+            {
+                // Already there, the first one wins
+                return;
+            }
+        }
+    }
+
+    template<class GetName>
+    void Grow(GetName getName)
+    {
+        std::vector<Slot> old = std::move(mSlots);
+        mSlots.assign(old.empty() ? 16 : old.size() * 2, Slot{ 0, kNotFound });
+        mCount = 0;
+        for (const Slot& s : old)
+        {
+            if (s.mIndex != kNotFound)
+            {
+                InsertHashed(s.mHash, s.mIndex, getName);
+            }
+        }
+    }
+
+    std::vector<Slot> mSlots;
+    u32 mCount = 0;
+};
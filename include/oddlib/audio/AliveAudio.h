@@ -53,6 +53,12 @@ public:
 
     void Play(f32* stream, u32 len);
 
+    // For rendering on a thread of its own instead of from the audio callback, the voices are no
+    // longer locked and are mixed without SDL. Each instance has its own voices so several can be
+    // rendered at the same time.
+    void SetOfflineRendering(bool offline) { mOffline = offline; }
+    bool OfflineRendering() const { return mOffline; }
+
     u32 NumberOfActiveVoices() const { return static_cast<u32>(m_Voices.size()); }
 
     // Can be changed from outside class
@@ -75,5 +81,12 @@ private:
     void CleanVoices();
     void AliveRenderAudio(f32* AudioStream, int StreamLength);
 
+    // Locked unless rendering offline
+    std::unique_lock<std::recursive_mutex> VoiceLock()
+    {
+        return mOffline ? std::unique_lock<std::recursive_mutex>(mVoiceMutex, std::defer_lock) : std::unique_lock<std::recursive_mutex>(mVoiceMutex);
+    }
+
+    bool mOffline = false;
     std::recursive_mutex mVoiceMutex;
 };
@@ -81,6 +81,12 @@ public:
     void Restart();
     void Play(f32* stream, u32 len);
 
+    // Offline rendering is for converting a sequence as fast as possible rather than playing it
+    // from the audio callback. Nothing is locked so only the thread rendering the player may use
+    // it. Instead of queuing every note of the sequence as a delayed voice up front, the notes are
+    // started and stopped at their exact sample between the blocks that Play renders.
+    void SetOfflineRendering(bool offline);
+
     const std::string& Name() const { return mName; }
 
     void AudioSettingsUi();
@@ -90,6 +96,28 @@ private:
     f64 MidiTimeToSample(int time);
     u64 GetPlaybackPositionSample();
 
+    // Locked unless rendering offline
+    std::unique_lock<std::mutex> Lock() const
+    {
+        return mOffline ? std::unique_lock<std::mutex>(mMutex, std::defer_lock) : std::unique_lock<std::mutex>(mMutex);
+    }
+
+    void ScheduleEvents();
+    void PlayOffline(f32* stream, u32 len);
+
+    // A note on or off of the loaded sequence with its program resolved, at the sample it happens
+    struct ScheduledEvent
+    {
+        u64 mSample;
+        AliveAudioMidiMessageType mType;
+        int mProgram;
+        int mNote;
+        char mVelocity;
+    };
+    std::vector<ScheduledEvent> mSchedule;
+    size_t mNextEvent = 0;
+    bool mOffline = false;
+
     AliveAudioSequencerState m_PlayerState = ALIVE_SEQUENCER_STOPPED;
 
     // Gets called every time the play position is at 1/4 of the song.
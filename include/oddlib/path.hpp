@@ -6,11 +6,18 @@
 #include <array>
 #include <memory>
 #include "types.hpp"
+#include "oddlib/exceptions.hpp"
 
 namespace Oddlib
 {
     class IStream;
 
+    class InvalidPath : public Exception
+    {
+    public:
+        explicit InvalidPath(const std::string& msg) : Exception(msg) { }
+    };
+
     using UP_Path = std::unique_ptr<class Path>;
     class Path
     {
@@ -19,7 +26,6 @@ namespace Oddlib
         {
             u16 mX;
             u16 mY;
-            void Read(IStream& stream);
         };
         static_assert(sizeof(Point16) == 4, "Wrong point size");
 
@@ -34,9 +40,9 @@ namespace Oddlib
             Point16 mRectTopLeft;
             Point16 mRectBottomRight;
 
-            // TODO: Set to biggest known size
-            // Assume 64 bytes is the biggest length for now
-            std::array<u8, 512> mData;
+            // Where the object specific data lives within the path chunk, see Path::ObjectData()
+            u32 mDataOffset;
+            u32 mDataSize;
         };
 
         class Camera
@@ -55,7 +61,6 @@ namespace Oddlib
         {
             s16 mPrevious;
             s16 mNext;
-            void Read(IStream& stream);
         };
         static_assert(sizeof(Links) == 4, "Wrong link size");
 
@@ -66,50 +71,86 @@ namespace Oddlib
             u16 mType;
             Links mLinks[2];
             u16 mLineLength;
-            void Read(IStream& stream);
         };
-        // sizeof(CollisionItem) != 20 due to padding, since we don't just memcpy things into the POD
-        // we had to add up each member individually which is annoying..
+
+        // On disk size of a collision item, sizeof(CollisionItem) can't be used since we never
+        // memcpy the raw records.
         const static auto kCollisionItemSize = 20;
-        static_assert(sizeof(Point16) + sizeof(Point16) + sizeof(u16) + sizeof(Links) + sizeof(Links) + sizeof(u16) == kCollisionItemSize, "Wrong collision item size");
+
+        // Collision items stored as one array per field so that they can be converted
+        // or tested in bulk without pulling in the fields that aren't needed.
+        struct CollisionItems
+        {
+            std::vector<u16> mP1X;
+            std::vector<u16> mP1Y;
+            std::vector<u16> mP2X;
+            std::vector<u16> mP2Y;
+            std::vector<u16> mType;
+            std::vector<s16> mLinkPrevious;
+            std::vector<s16> mLinkNext;
+            std::vector<s16> mOptionalLinkPrevious;
+            std::vector<s16> mOptionalLinkNext;
+            std::vector<u16> mLineLength;
+
+            u32 Count() const { return static_cast<u32>(mType.size()); }
+            void Resize(u32 count);
+
+            // Gather a single item back in to its record form - for debugging/tools only
+            CollisionItem At(u32 index) const;
+        };
 
         Path(const Path&) = delete;
         Path& operator = (const Path&) = delete;
         Path(const std::string& musicThemeName,
              IStream& pathChunkStream,
              u32 collisionDataOffset,
-             u32 objectIndexTableOffset, 
+             u32 objectIndexTableOffset,
              u32 objectDataOffset,
-             u32 mapXSize, 
+             u32 mapXSize,
+             u32 mapYSize,
+             bool isAo);
+
+        // Same as above, but takes ownership of already loaded path chunk data
+        Path(const std::string& musicThemeName,
+             std::vector<u8>&& pathChunkData,
+             u32 collisionDataOffset,
+             u32 objectIndexTableOffset,
+             u32 objectDataOffset,
+             u32 mapXSize,
              u32 mapYSize,
              bool isAo);
 
         u32 XSize() const;
         u32 YSize() const;
         const Camera& CameraByPosition(u32 x, u32 y) const;
-        const std::vector<CollisionItem>& CollisionItems() const { return mCollisionItems; }
+        const CollisionItems& Collisions() const { return mCollisionItems; }
+        const u8* ObjectData(const MapObject& mapObject) const { return mData.data() + mapObject.mDataOffset; }
         bool IsAo() const { return mIsAo; }
         const std::string& MusicThemeName() const { return mMusicThemeName; }
     private:
-        void ReadPath(IStream& stream, u32 collisionDataOffset, u32 objectIndexTableOffset, u32 objectDataOffset);
-        void ReadCamera(IStream& stream);
-        std::vector<u32> ReadOffsetsToPerCameraObjectLists(IStream& stream, u32 objectIndexTableOffset);
-        void ReadMapObject(IStream& stream, Path::MapObject& mapObject);
-        void ReadMapObjectsForCamera(IStream& stream, Camera& camera);
+        void ReadPath(u32 collisionDataOffset, u32 objectIndexTableOffset, u32 objectDataOffset);
+        u32 ReadCameraArray();
+        void ReadCollisionItemArray(u32 pos, u32 numberOfCollisionItems);
+        void ReadMapObjectsArray(u32 collisionEndPos, u32 objectIndexTableOffset);
+        void ReadMapObjectsForCamera(u32 pos, Camera& camera);
+        u32 ReadMapObject(u32 pos, MapObject& mapObject) const;
+
+        void CheckBounds(u32 pos, u32 size, const char* what) const;
+
+        template<class T>
+        T ReadAt(u32 pos) const;
 
         std::string mMusicThemeName;
 
         u32 mXSize = 0;
         u32 mYSize = 0;
 
-        void ReadCameraArray(IStream& stream);
-
-        void ReadCollisionItemArray(IStream& stream, u32 numberOfCollisionItems);
-        void ReadMapObjectsArray(IStream& stream, u32 objectIndexTableOffset);
+        // The entire path chunk, objects data is referenced rather than copied out of this
+        std::vector<u8> mData;
 
         std::vector<Camera> mCameras;
 
-        std::vector<CollisionItem> mCollisionItems;
+        CollisionItems mCollisionItems;
         bool mIsAo = false;
     };
-}
\ No newline at end of file
+}
@@ -182,6 +182,29 @@ namespace Oddlib
         virtual IStream* Clone(u32 start, u32 size) override { return Stream<std::stringstream>::Clone(start, size); }
     };
 
+    // Read only view over memory owned by someone else, the memory must outlive the stream.
+    // Unlike MemoryStream no copy of the data is made.
+    class SpanStream : public IStream
+    {
+    public:
+        SpanStream(const u8* data, size_t size);
+        virtual IStream* Clone() override;
+        virtual IStream* Clone(u32 start, u32 size) override;
+        virtual void ReadBytes(u8* pDest, size_t destSize) override;
+        virtual void WriteBytes(const u8* pSrc, size_t srcSize) override;
+        virtual void Seek(size_t pos) override;
+        virtual size_t Pos() const override { return mPos; }
+        virtual size_t Size() const override { return mSize; }
+        virtual bool AtEnd() const override { return mPos >= mSize; }
+        virtual const std::string& Name() const override { return mName; }
+        virtual std::string LoadAllToString() override;
+    private:
+        const u8* mData = nullptr;
+        size_t mSize = 0;
+        size_t mPos = 0;
+        std::string mName;
+    };
+
     class FileStream :public Stream<std::fstream>
     {
     public:
@@ -8,6 +8,7 @@ namespace Physics
     struct raycast_collision
     {
         glm::vec2 intersection;
+        s32 lineIndex = -1; // Only set by CollisionLine::RayCast
     };
 
     bool IsLineSegmentsIntersecting(const glm::vec2& line1p1, const glm::vec2& line1p2, const glm::vec2& line2p1, const glm::vec2& line2p2, raycast_collision* const collision);
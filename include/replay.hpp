@@ -0,0 +1,179 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <type_traits>
+#include "SDL.h"
+#include "types.hpp"
+
+class InputState;
+
+namespace Oddlib
+{
+    class IStream;
+}
+
+// FNV-1a hash of the game state, used to check that a replay ends up in the same
+// state as the recording did on every tick.
+class StateHash
+{
+public:
+    void Add(const void* data, size_t size)
+    {
+        const u8* bytes = static_cast<const u8*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            mHash ^= bytes[i];
+            mHash *= 1099511628211ull;
+        }
+    }
+
+    template<class T>
+    void Add(const T& value)
+    {
+        static_assert(std::is_fundamental<T>::value || std::is_enum<T>::value, "Can only hash fundamental types");
+        Add(&value, sizeof(value));
+    }
+
+    u32 Value() const { return static_cast<u32>(mHash ^ (mHash >> 32)); }
+    u64 Value64() const { return mHash; }
+private:
+    u64 mHash = 14695981039346656037ull;
+};
+
+// Everything InputState holds after its per tick update, captured after the update rather than
+// as raw events so that the pressed/released edges can't drift when replayed.
+struct InputSnapshot
+{
+    enum eItemStates
+    {
+        eRawDown,
+        ePressed,
+        eReleased,
+        eDown,
+        eItemStateCount
+    };
+
+    std::array<std::bitset<SDL_NUM_SCANCODES>, eItemStateCount> mKeys;
+    std::array<u8, 2> mMouseButtons = {};
+    s32 mMouseX = 0;
+    s32 mMouseY = 0;
+
+    // Includes anything that came from a game controller
+    std::array<u32, eItemStateCount> mActions = {};
+
+    void Capture(const InputState& input);
+    void Apply(InputState& input) const;
+
+    // Only what changed since previous is written, so an idle tick is a single byte
+    void Write(Oddlib::IStream& stream, const InputSnapshot& previous) const;
+    void Read(Oddlib::IStream& stream, const InputSnapshot& previous);
+};
+
+// Ticks are only counted whilst the game is simulating (i.e not whilst a map or the game is
+// loading) as loading takes a wall clock dependent number of ticks.
+class InputRecorder
+{
+public:
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator = (const InputRecorder&) = delete;
+    explicit InputRecorder(std::unique_ptr<Oddlib::IStream> stream);
+
+    void Start(const std::string& gameName, u32 seed);
+    void RecordTick(const InputState& input, u32 stateHash);
+    u32 TickCount() const { return mTickCount; }
+private:
+    std::unique_ptr<Oddlib::IStream> mStream;
+    InputSnapshot mPrevious;
+    bool mStarted = false;
+    u32 mTickCount = 0;
+};
+
+class InputReplayer
+{
+public:
+    InputReplayer(const InputReplayer&) = delete;
+    InputReplayer& operator = (const InputReplayer&) = delete;
+    explicit InputReplayer(std::unique_ptr<Oddlib::IStream> stream);
+
+    const std::string& GameName() const { return mGameName; }
+    u32 Seed() const { return mSeed; }
+
+    // Returns false once there are no more recorded ticks
+    bool ApplyNextTick(InputState& input);
+
+    // Compares against the hash that was recorded for the tick last applied
+    void CheckTick(u32 stateHash);
+
+    u32 TickCount() const { return mTickCount; }
+    u32 MismatchedTickCount() const { return mMismatchedTickCount; }
+private:
+    std::unique_ptr<Oddlib::IStream> mStream;
+    std::string mGameName;
+    u32 mSeed = 0;
+    InputSnapshot mPrevious;
+    u32 mExpectedHash = 0;
+    u32 mTickCount = 0;
+    u32 mMismatchedTickCount = 0;
+};
+
+// Per subsystem timings of each simulated tick, only collected whilst recording or replaying
+class SubsystemTimings
+{
+public:
+    enum eSubsystems
+    {
+        eTick,
+        eGridMap,
+        eMapObjects,
+        eScripts,
+        eSubsystemCount
+    };
+
+    void SetEnabled(bool enabled) { mEnabled = enabled; }
+    bool Enabled() const { return mEnabled; }
+
+    void Add(eSubsystems subsystem, u64 nanoSeconds) { mCurrentTick[subsystem] += nanoSeconds; }
+    void EndTick();
+
+    std::string Report() const;
+private:
+    bool mEnabled = false;
+    std::array<u64, eSubsystemCount> mCurrentTick = {};
+    std::array<std::vector<u64>, eSubsystemCount> mTicks;
+};
+
+SubsystemTimings& Timings();
+
+class ScopedSubsystemTimer
+{
+public:
+    ScopedSubsystemTimer(const ScopedSubsystemTimer&) = delete;
+    ScopedSubsystemTimer& operator = (const ScopedSubsystemTimer&) = delete;
+
+    explicit ScopedSubsystemTimer(SubsystemTimings::eSubsystems subsystem)
+        : mSubsystem(subsystem), mEnabled(Timings().Enabled())
+    {
+        if (mEnabled)
+        {
+            mStartTime = TClock::now();
+        }
+    }
+
+    ~ScopedSubsystemTimer()
+    {
+        if (mEnabled)
+        {
+            Timings().Add(mSubsystem, static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(TClock::now() - mStartTime).count()));
+        }
+    }
+private:
+    using TClock = std::chrono::high_resolution_clock;
+    SubsystemTimings::eSubsystems mSubsystem;
+    bool mEnabled;
+    TClock::time_point mStartTime;
+};
@@ -483,6 +483,9 @@ private:
     }
 public:
     const SoundBankLocation* FindSoundBank(const std::string& soundBank);
+    const SoundBankLocation* FindSoundBank(SoundBankId soundBank);
+    bool FindSoundBankId(const std::string& soundBank, SoundBankId& id) const;
+    const std::string& SoundBankName(SoundBankId soundBank) const;
     const MusicTheme* FindSoundTheme(const char* themeName);
     const std::vector<SoundResource>& GetSoundResources() const;
     const std::vector<SoundBankLocation>& GetSoundBankResources() const;
@@ -500,28 +503,74 @@ inline bool PointInRect(T px, T py, T x, T y, T w, T h)
     return true;
 }
 
-class Animation
+// The immutable part of an animation, shared by every Animation that plays it. The frames are
+// flattened out of the Oddlib::AnimationSet in to arrays with the PC frame offset scaling
+// already applied, so that nothing is worked out again per instance or per query.
+class AnimationClip
 {
 public:
-    // Keeps the LVL and AnimSet shared pointers in scope for as long as the Animation lives.
+    AnimationClip(const AnimationClip&) = delete;
+    AnimationClip& operator = (const AnimationClip&) = delete;
+    AnimationClip() = delete;
+
+    // Keeps the LVL and AnimSet shared pointers in scope for as long as the clip lives.
     // On destruction if its the last instance of the lvl/animset the lvl will be closed and removed
     // from the cache, and the animset will be deleted/freed.
-    struct AnimationSetHolder
-    {
-    public:
-        AnimationSetHolder(std::shared_ptr<Oddlib::LvlArchive> sLvlPtr, std::shared_ptr<Oddlib::AnimationSet> sAnimSetPtr, u32 animIdx);
-        const Oddlib::Animation& Animation() const;
-        u32 MaxW() const;
-        u32 MaxH() const;
-    private:
-        std::shared_ptr<Oddlib::LvlArchive> mLvlPtr;
-        std::shared_ptr<Oddlib::AnimationSet> mAnimSetPtr;
-        const Oddlib::Animation* mAnim;
-    };
+    AnimationClip(std::shared_ptr<Oddlib::LvlArchive> sLvlPtr, std::shared_ptr<Oddlib::AnimationSet> sAnimSetPtr, u32 animIdx,
+        bool isPsx, bool scaleFrameOffsets, u32 defaultBlendingMode, const std::string& sourceDataSet);
+
+    // From frames that aren't in an AnimationSet, the surfaces must outlive the clip
+    AnimationClip(const std::vector<Oddlib::Animation::Frame>& frames, u32 fps, u32 maxW, u32 maxH, bool isPsx, bool scaleFrameOffsets);
+
+    u32 NumFrames() const { return static_cast<u32>(mSurface.size()); }
+    u32 Fps() const { return mFps; }
+    u32 LoopStartFrame() const { return mLoopStartFrame; }
+    bool Loop() const { return mLoop; }
+    u32 MaxW() const { return mMaxW; }
+    u32 MaxH() const { return mMaxH; }
+    bool IsPsx() const { return mIsPsx; }
+    AbstractRenderer::eBlendModes BlendingMode() const { return mBlendingMode; }
+    const std::string& SourceDataSet() const { return mSourceDataSet; }
+
+    // 640 (pc xres) / 368 (psx xres) = 1.73913043478 scale factor
+    const static f32 kPcToPsxScaleFactor;
+
+    // Indexed by frame number. Offsets and bounding boxes are relative to the animation's
+    // position, all are before the Animation's scale is applied.
+    std::vector<f32> mOffX;
+    std::vector<f32> mOffY;
+    std::vector<f32> mBoxX;
+    std::vector<f32> mBoxY;
+    std::vector<f32> mBoxW;
+    std::vector<f32> mBoxH;
+    std::vector<SDL_Surface*> mSurface;
+private:
+    void AddFrame(const Oddlib::Animation::Frame& frame, bool scaleFrameOffsets);
+
+    std::shared_ptr<Oddlib::LvlArchive> mLvlPtr;
+    std::shared_ptr<Oddlib::AnimationSet> mAnimSetPtr;
+
+    u32 mFps = 0;
+    u32 mLoopStartFrame = 0;
+    bool mLoop = false;
+    u32 mMaxW = 0;
+    u32 mMaxH = 0;
+    bool mIsPsx = false;
+    AbstractRenderer::eBlendModes mBlendingMode = AbstractRenderer::eBlendModes::eNormal;
+    std::string mSourceDataSet;
+};
+
+// Playback cursor in to an AnimationClip, this is all that each instance of an animation owns
+class Animation
+{
+public:
     Animation(const Animation&) = delete;
     Animation& operator = (const Animation&) = delete;
+    Animation(Animation&&) = default;
+    Animation& operator = (Animation&&) = default;
     Animation() = delete;
-    Animation(AnimationSetHolder anim, bool isPsx, bool scaleFrameOffsets, u32 defaultBlendingMode, const std::string& sourceDataSet);
+    explicit Animation(std::shared_ptr<const AnimationClip> clip);
+    const AnimationClip& Clip() const { return *mClip; }
     s32 FrameCounter() const;
     bool Update();
     bool IsLastFrame() const;
@@ -530,6 +579,9 @@ public:
     void SetFrame(u32 frame);
     void Restart();
     bool Collision(s32 x, s32 y) const;
+
+    // Area the current frame covers when rendered at the current position
+    WorldRect Bounds(bool flipX) const;
     void SetXPos(s32 xpos);
     void SetYPos(s32 ypos);
     s32 XPos() const;
@@ -540,17 +592,12 @@ public:
     u32 NumberOfFrames() const;
     void SetScale(f32 scale);
 private:
-
-    // 640 (pc xres) / 368 (psx xres) = 1.73913043478 scale factor
-    const static f32 kPcToPsxScaleFactor;
-
     f32 ScaleX() const;
 
-    AnimationSetHolder mAnim;
-    bool mIsPsx = false;
-    bool mScaleFrameOffsets = false;
-    std::string mSourceDataSet;
-    AbstractRenderer::eBlendModes mBlendingMode = AbstractRenderer::eBlendModes::eNormal;
+    // Frame to draw, before the first Update() that's the first frame
+    u32 RenderFrame() const { return mFrameNum == -1 ? 0 : static_cast<u32>(mFrameNum); }
+
+    std::shared_ptr<const AnimationClip> mClip;
 
     // The "FPS" of the animation, set to 1 first so that the first Update() brings us from frame -1 to 0
     u32 mFrameDelay = 1;
@@ -619,6 +666,19 @@ public:
         return Get<Oddlib::AnimationSet>(key, mAnimationSets);
     }
 
+    // Clips also depend on the resource name's mapping, i.e its blending mode
+    std::shared_ptr<AnimationClip> AddAnimClip(std::unique_ptr<AnimationClip> uptr, const std::string& resourceName, const std::string& dataSetName, const std::string& lvlArchiveFileName, const std::string& lvlFileName, u32 chunkId, u32 animIndex)
+    {
+        std::string key = resourceName + dataSetName + lvlArchiveFileName + lvlFileName + std::to_string(chunkId) + "_" + std::to_string(animIndex);
+        return Add(key, mAnimationClips, std::move(uptr));
+    }
+
+    std::shared_ptr<AnimationClip> GetAnimClip(const std::string& resourceName, const std::string& dataSetName, const std::string& lvlArchiveFileName, const std::string& lvlFileName, u32 chunkId, u32 animIndex)
+    {
+        std::string key = resourceName + dataSetName + lvlArchiveFileName + lvlFileName + std::to_string(chunkId) + "_" + std::to_string(animIndex);
+        return Get<AnimationClip>(key, mAnimationClips);
+    }
+
 private:
     template<class ObjectType, class KeyType, class Container>
     std::shared_ptr<ObjectType> Add(KeyType& key, Container& container, std::unique_ptr<ObjectType> uptr)
@@ -645,6 +705,7 @@ private:
     std::mutex mMutex;
     std::map<std::string, std::weak_ptr<Oddlib::LvlArchive>> mOpenLvls;
     std::map<std::string, std::weak_ptr<Oddlib::AnimationSet>> mAnimationSets;
+    std::map<std::string, std::weak_ptr<AnimationClip>> mAnimationClips;
 };
 
 // TODO: Provide higher level abstraction
@@ -660,6 +721,9 @@ public:
     virtual void Update() = 0;
     virtual void Stop() = 0;
     virtual const std::string& Name() const = 0;
+
+    // Called before Load when the sound is rendered by a converter rather than the audio callback
+    virtual void SetOfflineRendering(bool offline) = 0;
 };
 using UP_ISound = std::unique_ptr<ISound>;
 
@@ -674,10 +738,14 @@ public:
     virtual void Update() override;
     virtual void Stop() override;
     virtual const std::string& Name() const override;
+    virtual void SetOfflineRendering(bool offline) override { mOfflineRendering = offline; }
 
     std::unique_ptr<Vab> mVab;
     std::unique_ptr<class SequencePlayer> mSeqPlayer;
     std::string mSoundName;
+protected:
+    void CreatePlayer();
+    bool mOfflineRendering = false;
 };
 
 class SingleSeqSampleSound : public BaseSeqSound
@@ -740,8 +808,8 @@ public:
 
     std::future<std::unique_ptr<Vab>> LocateVab(const std::string& dataSetName, const std::string& baseVabName);
 private:
-    std::unique_ptr<ISound> DoLoadSoundEffect(const char* resourceName, const DataPaths::FileSystemInfo& fs, const std::string& strSb, const SoundEffectResource& sfxRes, const SoundEffectResourceLocation& sfxResLoc);
-    std::unique_ptr<ISound> DoLoadSoundMusic(const char* resourceName, const DataPaths::FileSystemInfo& fs, const std::string& strSb, const MusicResource& sfxRes);
+    std::unique_ptr<ISound> DoLoadSoundEffect(const char* resourceName, const DataPaths::FileSystemInfo& fs, SoundBankId soundBank, const SoundEffectResource& sfxRes, const SoundEffectResourceLocation& sfxResLoc);
+    std::unique_ptr<ISound> DoLoadSoundMusic(const char* resourceName, const DataPaths::FileSystemInfo& fs, SoundBankId soundBank, const MusicResource& sfxRes);
 
     std::unique_ptr<Animation> DoLocateAnimation(const DataPaths::FileSystemInfo& fs, const char* resourceName, const ResourceMapper::AnimMapping& animMapping);
 
@@ -749,7 +817,17 @@ private:
 
     std::unique_ptr<IMovie> DoLocateFmvFromFileLocation(const ResourceMapper::FmvFileLocation& location, const DataPaths::FileSystemInfo& fs, const char* resourceName, IAudioController& audioController);
 
-    std::unique_ptr<Oddlib::IBits> DoLocateCamera(const char* resourceName, bool ignoreMods);
+    // The encoded chunks of an original camera, read in to memory so that they can be decoded
+    // without holding mMutex
+    struct CameraStreams
+    {
+        std::unique_ptr<Oddlib::IStream> mBits;
+        std::unique_ptr<Oddlib::IStream> mFg1;
+    };
+
+    // When streams is set an original camera is only read in to it and nullptr is returned, mod
+    // cameras are always decoded here
+    std::unique_ptr<Oddlib::IBits> DoLocateCamera(const char* resourceName, bool ignoreMods, CameraStreams* streams);
 
     std::shared_ptr<Oddlib::LvlArchive> OpenLvl(IFileSystem& fs, const std::string& dataSetName, const std::string& lvlName);
 
@@ -765,4 +843,5 @@ private:
 public:
     const std::vector<SoundResource>& GetSoundResources() const;
     const std::vector<SoundBankLocation>& GetSoundBankResources() const;
+    const std::string& SoundBankName(SoundBankId soundBank) const;
 };
@@ -8,6 +8,7 @@ class ResourceLocator;
 class AbstractRenderer;
 class CoordinateSpace;
 class InputState;
+class IFileSystem;
 
 class PlayFmvState
 {
@@ -24,13 +25,14 @@ public:
 class RunGameState
 {
 public:
-    RunGameState(ResourceLocator& locator, AbstractRenderer& renderer);
+    RunGameState(ResourceLocator& locator, AbstractRenderer& renderer, IFileSystem& fs);
     ~RunGameState();
     void Render();
     void OnStartASync(const std::string& initScriptName, Sound* pSound);
     void LoadMap(const std::string& mapName);
     EngineStates Update(const InputState& input, CoordinateSpace& coords);
     bool IsLoading() const;
+    u32 StateHashValue() const;
 private:
     ResourceLocator& mResourceLocator;
     AbstractRenderer& mRenderer;
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include "types.hpp"
+
+// Backs squirrel's sq_vm_malloc/sq_vm_realloc/sq_vm_free (squirrel is built with
+// SQ_EXCLUDE_DEFAULT_MEMFUNCTIONS). Squirrel passes the size of a block when freeing it, so
+// small blocks come from per size class free lists without needing any block header.
+// Like the VM itself this isn't thread safe.
+namespace ScriptAllocator
+{
+    const u32 kSizeClassCount = 8;
+
+    struct Stats
+    {
+        // As requested by the VM
+        u64 mBytesInUse;
+
+        // Pool chunks plus the size of allocations too big for any size class
+        u64 mBytesReserved;
+
+        u64 mAllocations;
+        u64 mFrees;
+        std::array<u32, kSizeClassCount> mLiveBlocks;
+        u32 mLiveLargeBlocks;
+    };
+
+    const Stats& GetStats();
+    u32 SizeClassBytes(u32 sizeClass);
+}
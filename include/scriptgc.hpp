@@ -0,0 +1,38 @@
+#pragma once
+
+#include "types.hpp"
+#include "proxy_sqrat.hpp"
+
+// Squirrel frees most objects via ref counting, only cycles need sq_collectgarbage which is a
+// full stop the world mark and sweep. This runs it from the frame loop once the heap has grown
+// enough, and only in frames with enough spare time for how long collecting took last time.
+class ScriptGarbageCollector
+{
+public:
+    ScriptGarbageCollector(const ScriptGarbageCollector&) = delete;
+    ScriptGarbageCollector& operator = (const ScriptGarbageCollector&) = delete;
+    explicit ScriptGarbageCollector(HSQUIRRELVM vm);
+
+    void Step(f32 budgetMs);
+    void DebugUi();
+private:
+    void Collect();
+
+    // Growth since the last collection before trying to collect
+    static const u64 kCollectGrowthBytes = 512 * 1024;
+
+    // Growth at which to collect even if it doesn't fit in the frame budget
+    static const u64 kForceCollectGrowthBytes = 8 * 1024 * 1024;
+
+    HSQUIRRELVM mVm = nullptr;
+    u64 mBytesInUseAfterCollection = 0;
+
+    // Moving average, starts at 0 so that the first collection always happens and is timed
+    f32 mEstimatedCollectionMs = 0.0f;
+    f32 mLastCollectionMs = 0.0f;
+    f32 mMaxCollectionMs = 0.0f;
+    s32 mLastCollectedObjects = 0;
+    u32 mCollections = 0;
+    u32 mForcedCollections = 0;
+    u32 mDeferredSteps = 0;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include "types.hpp"
+#include "proxy_sqrat.hpp"
+
+class IFileSystem;
+
+// Profiles script functions via the squirrel native debug hook. Call/return events give the
+// inclusive/exclusive time of each function and its position in the call tree, line events
+// (only emitted for scripts compiled with debug info enabled) split the exclusive time per line.
+class ScriptProfiler
+{
+public:
+    ScriptProfiler(const ScriptProfiler&) = delete;
+    ScriptProfiler& operator = (const ScriptProfiler&) = delete;
+    ScriptProfiler(HSQUIRRELVM vm, IFileSystem& fs);
+    ~ScriptProfiler();
+
+    void SetEnabled(bool enabled);
+    bool Enabled() const { return mEnabled; }
+    void Reset();
+
+    // The file names are resolved by the file system, e.g {UserDir}/script_profile.json
+    bool DumpJson(const std::string& fileName) const;
+
+    // One "root;caller;callee exclusive_microseconds" line per call tree path, the input
+    // format of flamegraph.pl
+    bool DumpFoldedStacks(const std::string& fileName) const;
+
+    void DebugUi();
+
+    struct FunctionStats
+    {
+        std::string mName;
+        std::string mSource;
+        u32 mCalls = 0;
+        u64 mInclusiveNs = 0;
+        u64 mExclusiveNs = 0;
+        std::map<s32, u64> mLineExclusiveNs;
+
+        // Recursive calls are only counted once towards the inclusive time
+        u32 mActiveCalls = 0;
+    };
+
+    const std::vector<FunctionStats>& Functions() const { return mFunctions; }
+private:
+    using TClock = std::chrono::high_resolution_clock;
+
+    static void OnDebugHook(HSQUIRRELVM vm, SQInteger type, const SQChar* sourceName, SQInteger line, const SQChar* funcName);
+    void OnCall(const SQChar* sourceName, const SQChar* funcName);
+    void OnReturn();
+    void OnLine(s32 line);
+
+    // Charges the time since the last event to whatever is at the top of the stack
+    void AttributeElapsed(TClock::time_point now);
+
+    u32 FunctionIndex(const SQChar* sourceName, const SQChar* funcName);
+    u32 ChildNode(u32 parentNode, u32 function);
+    void FoldedStacks(u32 node, const std::string& prefix, std::string& out) const;
+    bool WriteFile(const std::string& fileName, const std::string& contents) const;
+
+    struct CallNode
+    {
+        u32 mFunction = 0;
+        u64 mExclusiveNs = 0;
+        std::vector<u32> mChildren;
+    };
+
+    struct Frame
+    {
+        u32 mNode;
+        u32 mFunction;
+        s32 mLine;
+        TClock::time_point mStartTime;
+    };
+
+    HSQUIRRELVM mVm = nullptr;
+    IFileSystem& mFs;
+    bool mEnabled = false;
+
+    std::vector<FunctionStats> mFunctions;
+    std::unordered_map<std::string, u32> mFunctionLookup;
+    std::string mLookupKey;
+
+    // Node 0 is the root, i.e native code calling in to the VM
+    std::vector<CallNode> mNodes;
+    std::vector<Frame> mStack;
+    TClock::time_point mLastEventTime;
+
+    static ScriptProfiler* sInstance;
+};
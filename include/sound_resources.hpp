@@ -2,11 +2,14 @@
 
 #include <string>
 #include <vector>
-#include <set>
 #include <map>
 #include "types.hpp"
+#include "nameindex.hpp"
 #include "proxy_rapidjson.hpp"
 
+// Index of a sound bank name interned by SoundResources::Parse, see SoundResources::BankName
+using SoundBankId = u32;
+
 class SoundBankLocation
 {
 public:
@@ -25,7 +28,7 @@ class MusicResource
 {
 public:
     u32 mResourceId;
-    std::set<std::string> mSoundBanks;
+    std::vector<SoundBankId> mSoundBanks; // In the order they are tried, no duplicates
 };
 
 class SoundEffectResourceLocation
@@ -35,7 +38,7 @@ public:
     // the program/tone can also change between them
     s32 mProgram;
     s32 mTone;
-    std::set<std::string> mSoundBanks;
+    std::vector<SoundBankId> mSoundBanks; // In the order they are tried, no duplicates
 };
 
 class SoundEffectResource
@@ -83,12 +86,33 @@ public:
 
     void Parse(const std::string& json);
     void Dump(const std::string& fileName);
+
+    // These are hashed lookups, the indexes are rebuilt at the end of Parse so anything added
+    // to the vectors by hand isn't found until the next Parse
     const SoundResource* FindSound(const char* resourceName) const;
     const SoundBankLocation* FindSoundBank(const std::string& soundBank) const;
+    const SoundBankLocation* FindSoundBank(SoundBankId soundBank) const;
     const MusicTheme* FindMusicTheme(const char* themeName) const;
+
+    // Sound bank names referred to by the sounds, a name that isn't in mSoundBanks still gets an id
+    const std::string& BankName(SoundBankId id) const { return mBankNames[id]; }
+    bool FindBankId(const char* soundBank, SoundBankId& id) const;
+    SoundBankId InternBank(const std::string& soundBank);
 private:
     void ParseSEQ(SoundResource& res, const rapidjson::Value& obj);
     void ParseSample(SoundResource& res, const rapidjson::Value& obj);
     void ParseSoundBanks(const rapidjson::Value& obj);
     void ParseThemes(const rapidjson::Value& obj);
+    void AddBank(std::vector<SoundBankId>& banks, const char* soundBank);
+    void BuildIndexes();
+
+    std::vector<std::string> mBankNames;
+    NameIndex mBankNameIndex;
+
+    // mSoundBanks index of each bank id, or -1 if there is no location for it
+    std::vector<s32> mBankLocations;
+
+    NameIndex mSoundIndex;
+    NameIndex mSoundBankIndex;
+    NameIndex mThemeIndex;
 };
@@ -39,12 +39,20 @@ glm::vec2 CoordinateSpace::ScreenToWorld(const glm::vec2& screenPos)
     return glm::inverse(mProjection * mView) * ((glm::vec4(screenPos.x ,screenPos.y, 1, 1) - glm::vec4(mW / 2, mH / 2, 0, 0)) / glm::vec4(mW / 2, -mH / 2, 1, 1));
 }
 
+WorldRect CoordinateSpace::VisibleWorldRect()
+{
+    const glm::vec2 topLeft = ScreenToWorld(glm::vec2(0, 0));
+    const glm::vec2 bottomRight = ScreenToWorld(glm::vec2(mW, mH));
+    return WorldRect{ glm::min(topLeft, bottomRight), glm::max(topLeft, bottomRight) };
+}
+
 AbstractRenderer::AbstractRenderer()
 {
     // These should be large enough so that no allocations are done during game
     mDestroyTextureList.reserve(1024);
     mPointersToOrderedCommands.reserve(1024*10);
     mDrawCommandBuffer.reserve(1024*1024);
+    mDebugOverlayRuns.reserve(1024*4);
 
     mFontStashParams = std::make_unique<FONSparams>();
     mFontStashParams->userPtr = this;
@@ -122,6 +130,9 @@ void AbstractRenderer::BeginFrame(int w, int h)
     if (mScreenSizeChanged)
     {
         fonsResetAtlas(mFontStashContext, 512, 512);
+
+        // The cached glyphs point in to the old atlas
+        mGlyphRuns.clear();
     }
 }
 
@@ -132,6 +143,10 @@ void AbstractRenderer::Clear(f32 r, f32 g, f32 b)
 
 void AbstractRenderer::EndFrame()
 {
+    if (!mDebugOverlay.Empty())
+    {
+        AddDebugOverlayCmd();
+    }
     AddUiCmd();
 
     if (!mDrawCommandBuffer.empty())
@@ -158,6 +173,7 @@ void AbstractRenderer::EndFrame()
     mScreenSizeChanged = false;
 
     mWritePos = 0;
+    mDebugOverlay.Clear();
     mDrawList.Clear();
     mDrawCommandBuffer.clear();
     mPointersToOrderedCommands.clear();
@@ -272,6 +288,15 @@ void AbstractRenderer::FontStashRenderDraw(void* uptr, const float* verts, const
 {
     auto pRenderer = reinterpret_cast<AbstractRenderer*>(uptr);
 
+    if (pRenderer->mGlyphCapture)
+    {
+        for (int i = 0; i < nverts; i++)
+        {
+            pRenderer->mGlyphCapture->push_back({ { verts[i * 2], verts[(i * 2) + 1] }, { tcoords[i * 2], tcoords[(i * 2) + 1] } });
+        }
+        return;
+    }
+
     const int numTris = nverts / 3;
     if (numTris)
     {
@@ -384,8 +409,8 @@ void AbstractRenderer::generateImGuiCommands()
             mDrawList.PrimRectUV(
                 { cmd->mX, cmd->mY },
                 { cmd->mX + cmd->mW, cmd->mY + cmd->mH },
-                { 0.0f, 0.0f },
-                { 1.0f, 1.0f },
+                { cmd->mUv.x, cmd->mUv.y },
+                { cmd->mUv.z, cmd->mUv.w },
                 ToImCol(cmd->mHeader.mColour));
         }
         break;
@@ -400,6 +425,19 @@ void AbstractRenderer::generateImGuiCommands()
         }
         break;
 
+        case eDebugOverlay:
+        {
+            CmdHeader* cmd = reinterpret_cast<CmdHeader*>(cmdType);
+            PushCallBack(lastCoordSystem, lastBlendMode, *cmd, true);
+
+            // Text commands push the font stash texture without going through PushTexture
+            lastTextureId = ImGui::GetIO().Fonts->TexID;
+            mDrawList.PushTextureID(lastTextureId);
+            mDrawList.PushClipRectFullScreen();
+            RenderDebugOverlay(lastTextureId);
+        }
+        break;
+
         case ePath:
         {
             CmdBeginPath* cmd = reinterpret_cast<CmdBeginPath*>(cmdType);
@@ -466,6 +504,11 @@ void AbstractRenderer::generateImGuiCommands()
 }
 
 void AbstractRenderer::TexturedQuad(TextureHandle texHandle, f32 x, f32 y, f32 w, f32 h, int layer, ColourU8 colour, eBlendModes blendMode, eCoordinateSystem coordinateSystem)
+{
+    TexturedQuad(texHandle, x, y, w, h, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), layer, colour, blendMode, coordinateSystem);
+}
+
+void AbstractRenderer::TexturedQuad(TextureHandle texHandle, f32 x, f32 y, f32 w, f32 h, const glm::vec4& uv, int layer, ColourU8 colour, eBlendModes blendMode, eCoordinateSystem coordinateSystem)
 {
     assert(mInPath == false);
     EnsureCmdFreeSpace(sizeof(CmdTexturedQuad));
@@ -480,6 +523,7 @@ void AbstractRenderer::TexturedQuad(TextureHandle texHandle, f32 x, f32 y, f32 w
     cmd->mY = y;
     cmd->mW = w;
     cmd->mH = h;
+    cmd->mUv = uv;
     cmd->mTexture = texHandle;
     cmd->mHeader.mState.mBlendMode = blendMode;
     cmd->mHeader.mState.mCoordinateSystem = coordinateSystem;
@@ -634,6 +678,135 @@ void AbstractRenderer::AddUiCmd()
     cmd->mState.mCoordinateSystem = eScreen;
 }
 
+void AbstractRenderer::AddDebugOverlayCmd()
+{
+    assert(mInPath == false);
+    EnsureCmdFreeSpace(sizeof(CmdHeader));
+    u8* const ptr = mDrawCommandBuffer.data() + mWritePos;
+    mWritePos += sizeof(CmdHeader);
+    CmdHeader* const cmd = new (ptr) CmdHeader;
+    cmd->mType = eDebugOverlay;
+    cmd->mLayer = eFmv;
+    cmd->mSize = sizeof(CmdHeader);
+    cmd->mState.mThisPtr = this;
+    cmd->mState.mBlendMode = eNormal;
+    cmd->mState.mCoordinateSystem = eScreen;
+}
+
+void AbstractRenderer::RenderDebugOverlay(ImTextureID& lastTextureId)
+{
+    const DebugOverlay& overlay = mDebugOverlay;
+    for (u32 i = 0; i < overlay.RectCount(); i++)
+    {
+        mDrawList.AddRect(
+            { overlay.mRectX[i], overlay.mRectY[i] },
+            { overlay.mRectX[i] + overlay.mRectW[i], overlay.mRectY[i] + overlay.mRectH[i] },
+            overlay.mRectColour[i]);
+    }
+
+    if (overlay.TextCount() == 0)
+    {
+        return;
+    }
+
+    // Nearly every part is the same as last frame, but numbers that keep changing would
+    // otherwise grow the cache forever
+    if (mGlyphRuns.size() > 1024 * 8)
+    {
+        mGlyphRuns.clear();
+    }
+
+    // Laying out a part that isn't cached can add glyphs to the atlas, which creates a new font
+    // texture, so everything is laid out before drawing with whatever the texture ends up as
+    mDebugOverlayRuns.clear();
+    for (u32 i = 0; i < overlay.TextCount(); i++)
+    {
+        for (u32 part = overlay.FirstPart(i); part < overlay.FirstPart(i + 1); part++)
+        {
+            mDebugOverlayRuns.push_back(&FindGlyphRun(overlay.mPartKey[part], overlay.mTextSize[i], overlay.Part(part)));
+        }
+    }
+
+    PushTexture(lastTextureId, mFontStashTexture.mData);
+
+    // All of the shadows go first so that none are drawn over another string
+    const u32 shadowColour = ColourU8{ 0, 0, 0, 255 }.To32Bit();
+    for (const bool shadow : { true, false })
+    {
+        u32 run = 0;
+        for (u32 i = 0; i < overlay.TextCount(); i++)
+        {
+            f32 x = overlay.mTextX[i];
+            for (u32 part = overlay.FirstPart(i); part < overlay.FirstPart(i + 1); part++)
+            {
+                const GlyphRun& glyphRun = *mDebugOverlayRuns[run++];
+                if (shadow)
+                {
+                    DrawGlyphRun(glyphRun.mShadow, x - 2.0f, overlay.mTextY[i] + 2.0f, shadowColour);
+                }
+                else
+                {
+                    DrawGlyphRun(glyphRun.mGlyphs, x, overlay.mTextY[i], overlay.mTextColour[i]);
+                }
+                x += glyphRun.mAdvance;
+            }
+        }
+    }
+}
+
+const AbstractRenderer::GlyphRun& AbstractRenderer::FindGlyphRun(u64 key, f32 fontSize, const char* text)
+{
+    u32 sizeBits = 0;
+    memcpy(&sizeBits, &fontSize, sizeof(sizeBits));
+    key ^= static_cast<u64>(sizeBits) * 1099511628211ull;
+
+    auto it = mGlyphRuns.find(key);
+    if (it != std::end(mGlyphRuns))
+    {
+        return it->second;
+    }
+
+    GlyphRun& run = mGlyphRuns[key];
+
+    fonsSetAlign(mFontStashContext, FONS_ALIGN_LEFT | FONS_ALIGN_TOP);
+    fonsSetFont(mFontStashContext, mFontStashFontHandles[0]);
+    fonsSetSize(mFontStashContext, fontSize);
+    fonsSetSpacing(mFontStashContext, 0.0f);
+
+    // Same as HandleTextCommand draws, but captured rather than drawn
+    fonsSetBlur(mFontStashContext, 2.0f);
+    mGlyphCapture = &run.mShadow;
+    fonsDrawText(mFontStashContext, 0.0f, 0.0f, text, nullptr);
+
+    fonsSetBlur(mFontStashContext, 0.0f);
+    mGlyphCapture = &run.mGlyphs;
+    run.mAdvance = fonsDrawText(mFontStashContext, 0.0f, 0.0f, text, nullptr);
+    mGlyphCapture = nullptr;
+
+    return run;
+}
+
+void AbstractRenderer::DrawGlyphRun(const std::vector<GlyphVertex>& vertices, f32 x, f32 y, u32 colour)
+{
+    if (vertices.empty())
+    {
+        return;
+    }
+
+    const int count = static_cast<int>(vertices.size());
+    mDrawList.PrimReserve(count, count);
+    ImDrawIdx idx = static_cast<ImDrawIdx>(mDrawList._VtxCurrentIdx);
+    for (const GlyphVertex& vertex : vertices)
+    {
+        mDrawList._VtxWritePtr->pos = ImVec2(vertex.mPos.x + x, vertex.mPos.y + y);
+        mDrawList._VtxWritePtr->uv = vertex.mUv;
+        mDrawList._VtxWritePtr->col = colour;
+        mDrawList._VtxWritePtr++;
+        *mDrawList._IdxWritePtr++ = idx++;
+    }
+    mDrawList._VtxCurrentIdx += count;
+}
+
 void AbstractRenderer::FontStashTextureDebug(f32 x, f32 y)
 {
     TexturedQuad(mFontStashTexture,
@@ -0,0 +1,63 @@
+#include "activationregions.hpp"
+#include "mapobjectstore.hpp"
+#include <cmath>
+
+void ActivationRegions::Update(const MapObjectStore& store, const MapObject* subject, const glm::vec2& blockSize)
+{
+    if (subject)
+    {
+        Update(store, glm::vec2(subject->XPos(), subject->YPos()), blockSize);
+    }
+    else
+    {
+        WakeAll(store);
+    }
+}
+
+void ActivationRegions::Update(const MapObjectStore& store, const glm::vec2& subjectPos, const glm::vec2& blockSize)
+{
+    // Free slots stay awake so that an object added in to one before the next Update is too
+    mAwake.assign(store.SlotCount(), 1);
+    mStats = {};
+
+    // Whole camera blocks around the one the subject is in, the same cells the game camera snaps to
+    const f32 minX = (std::floor(subjectPos.x / blockSize.x) - mRadius) * blockSize.x;
+    const f32 minY = (std::floor(subjectPos.y / blockSize.y) - mRadius) * blockSize.y;
+    const f32 maxX = minX + ((mRadius * 2) + 1) * blockSize.x;
+    const f32 maxY = minY + ((mRadius * 2) + 1) * blockSize.y;
+
+    for (u32 i = 0; i < store.Count(); i++)
+    {
+        const f32 x = store.mXPos[i];
+        const f32 y = store.mYPos[i];
+        const bool inRange = x >= minX && x < maxX && y >= minY && y < maxY;
+        if (store.mAlwaysActive[i])
+        {
+            mStats.mAlwaysActive++;
+        }
+
+        if (inRange || store.mAlwaysActive[i])
+        {
+            mStats.mAwake++;
+        }
+        else
+        {
+            mAwake[store.Slot(i)] = 0;
+            mStats.mAsleep++;
+        }
+    }
+}
+
+void ActivationRegions::WakeAll(const MapObjectStore& store)
+{
+    mAwake.assign(store.SlotCount(), 1);
+    mStats = {};
+    mStats.mAwake = store.Count();
+    for (u32 i = 0; i < store.Count(); i++)
+    {
+        if (store.mAlwaysActive[i])
+        {
+            mStats.mAlwaysActive++;
+        }
+    }
+}
@@ -1,39 +1,49 @@
 #include "audioconverter.hpp"
 #include "resourcemapper.hpp"
+#include <vector>
+#include <algorithm>
 
-template void AudioConverter::Convert<OggEncoder>(ISound& sound, const char* outputName, std::atomic<bool>& quitFlag);
-template void AudioConverter::Convert<WavEncoder>(ISound& sound, const char* outputName, std::atomic<bool>& quitFlag);
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ALIVE_AUDIO_SSE2
+#include <emmintrin.h>
+#endif
+
+/*static*/ const u32 AudioConverter::kDefaultBlockFrames;
+
+template void AudioConverter::Convert<OggEncoder>(ISound& sound, const char* outputName, std::atomic<bool>& quitFlag, u32 blockFrames);
+template void AudioConverter::Convert<WavEncoder>(ISound& sound, const char* outputName, std::atomic<bool>& quitFlag, u32 blockFrames);
 
 template<class EncoderAlgorithm>
-void AudioConverter::Convert(ISound& sound, const char* outputName, std::atomic<bool>& quitFlag)
+void AudioConverter::Convert(ISound& sound, const char* outputName, std::atomic<bool>& quitFlag, u32 blockFrames)
 {
     TRACE_ENTRYEXIT;
 
     EncoderAlgorithm encoder(outputName);
 
+    // One buffer for the whole conversion, big blocks keep the per block Update/Play and
+    // encoder overhead out of the way of the rendering
+    const u32 blockSamples = std::max(blockFrames, 1u) * 2;
+    std::vector<f32> buffer(blockSamples);
+
     for (;;)
     {
-        f32 buffer[1024] = {};
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
 
         sound.Update();
 
-        sound.Play(buffer, 1024);
+        sound.Play(buffer.data(), blockSamples);
         const bool endOfAudio = sound.AtEnd();
-        u32 numSamplesToUse = 1024;
+        u32 numSamplesToUse = blockSamples;
         if (endOfAudio)
         {
             // Trim down the buffer so the trailing silence is chopped off
-            for (u32 i = 1024; i-- > 0; )
-            {
-                if (buffer[i] != 0.0f)
-                {
-                    break;
-                }
-                numSamplesToUse--;
-            }
+            numSamplesToUse = TrimTrailingSilence(buffer.data(), blockSamples);
         }
 
-        encoder.Consume(buffer, numSamplesToUse * sizeof(f32));
+        if (numSamplesToUse > 0)
+        {
+            encoder.Consume(buffer.data(), numSamplesToUse * sizeof(f32));
+        }
 
         if (endOfAudio || quitFlag)
         {
@@ -44,6 +54,51 @@ void AudioConverter::Convert(ISound& sound, const char* outputName, std::atomic<
     encoder.Finish();
 }
 
+u32 AudioConverter::TrimTrailingSilence(const f32* samples, u32 numSamples)
+{
+    u32 end = numSamples;
+
+#ifdef ALIVE_AUDIO_SSE2
+    // Skip back over 4 silent samples at a time, stopping at the first group with any sound in it.
+    // Compared as floats so that -0.0f counts as silent the same as the scalar loop.
+    const __m128 zero = _mm_setzero_ps();
+    while (end >= 4 && _mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(samples + end - 4), zero)) == 0)
+    {
+        end -= 4;
+    }
+#endif
+
+    while (end > 0 && samples[end - 1] == 0.0f)
+    {
+        end--;
+    }
+
+    // Keep the right channel of the last frame that has sound in its left channel
+    return (end + 1) & ~1u;
+}
+
+void AudioConverter::Deinterleave(const f32* samples, u32 numFrames, f32* left, f32* right)
+{
+    u32 frame = 0;
+
+#ifdef ALIVE_AUDIO_SSE2
+    for (; frame + 4 <= numFrames; frame += 4)
+    {
+        // L0 R0 L1 R1 and L2 R2 L3 R3 in to L0 L1 L2 L3 and R0 R1 R2 R3
+        const __m128 a = _mm_loadu_ps(samples + (frame * 2));
+        const __m128 b = _mm_loadu_ps(samples + (frame * 2) + 4);
+        _mm_storeu_ps(left + frame, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + frame, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#endif
+
+    for (; frame < numFrames; frame++)
+    {
+        left[frame] = samples[frame * 2];
+        right[frame] = samples[(frame * 2) + 1];
+    }
+}
+
 void WavHeader::Write(Oddlib::IStream& stream)
 {
     stream.Write(mData.mRiff);
@@ -101,16 +156,13 @@ WavEncoder::WavEncoder(const char* outputName)
 
 void WavEncoder::Consume(float* readbuffer, long bufferSizeInBytes)
 {
-    const u32 kNumFloats = bufferSizeInBytes / sizeof(float);
-    const u32 kFloatsPerChannel = kNumFloats / 2;
-    u32 pos = 0;
-    for (u32 i = 0; i < kFloatsPerChannel; i++)
+    // The samples are already interleaved left/right 32bit floats, the same as the wav data
+    // so the whole block goes out in one write. Only whole frames are written.
+    const size_t frameSize = sizeof(float) * 2;
+    const size_t bytesToWrite = (static_cast<size_t>(bufferSizeInBytes) / frameSize) * frameSize;
+    if (bytesToWrite > 0)
     {
-        const float left = readbuffer[pos++];
-        const float right = readbuffer[pos++];
-
-        mStream.Write(left);
-        mStream.Write(right);
+        mStream.WriteBytes(reinterpret_cast<const u8*>(readbuffer), bytesToWrite);
     }
 }
 
@@ -152,13 +204,7 @@ void OggEncoder::Consume(float* readbuffer, long bufferSizeInBytes)
 
         /* expose the buffer to submit data */
         float** buffer = vorbis_analysis_buffer(&vd, floatsPerChannel); // 32bit float buffer
-
-        int pos = 0;
-        for (auto i = 0; i < floatsPerChannel; i++)
-        {
-            buffer[0][i] = readbuffer[pos++];
-            buffer[1][i] = readbuffer[pos++];
-        }
+        AudioConverter::Deinterleave(readbuffer, floatsPerChannel, buffer[0], buffer[1]);
 
         /* tell the library how much we actually submitted */
         vorbis_analysis_wrote(&vd, floatsPerChannel);
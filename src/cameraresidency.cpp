@@ -0,0 +1,102 @@
+#include "cameraresidency.hpp"
+#include "debug.hpp"
+#include "imgui/imgui.h"
+#include <algorithm>
+
+CameraResidency::CameraResidency(ResourceLocator& locator)
+    : mLocator(locator)
+{
+    mDebugSection = Debugging().AddSection([&]()
+    {
+        DebugUi();
+    });
+}
+
+CameraResidency::~CameraResidency()
+{
+    Debugging().RemoveSection(mDebugSection);
+}
+
+void CameraResidency::Update(AbstractRenderer& rend, const GridMapState& state, const ScreenGrid::Range& window, bool prefetch)
+{
+    mFrame++;
+    mStats = {};
+    mEvictable.clear();
+
+    for (u32 i = 0; i < state.mScreens.Count(); i++)
+    {
+        GridScreen& screen = state.mScreens[i];
+        if (!screen.hasTexture())
+        {
+            continue;
+        }
+
+        screen.FinishLoading(rend);
+
+        const ScreenGrid::Cell cell = state.mScreens.CellOfIndex(i);
+        const bool inWindow = window.Contains(cell.mX, cell.mY);
+        if (inWindow)
+        {
+            screen.MarkUsed(mFrame);
+            if (prefetch)
+            {
+                screen.RequestTextures(mLocator);
+            }
+        }
+
+        if (screen.IsLoading())
+        {
+            mStats.mLoading++;
+        }
+
+        if (screen.IsResident())
+        {
+            mStats.mResident++;
+            mStats.mGpuBytes += screen.GpuBytes();
+            mStats.mCpuBytes += screen.CpuBytes();
+            if (!inWindow)
+            {
+                mEvictable.push_back(&screen);
+            }
+        }
+    }
+
+    if (mStats.mGpuBytes + mStats.mCpuBytes <= mBudgetBytes)
+    {
+        return;
+    }
+
+    std::sort(mEvictable.begin(), mEvictable.end(), [](const GridScreen* a, const GridScreen* b)
+    {
+        return a->LastUsedFrame() < b->LastUsedFrame();
+    });
+
+    for (GridScreen* screen : mEvictable)
+    {
+        if (mStats.mGpuBytes + mStats.mCpuBytes <= mBudgetBytes)
+        {
+            break;
+        }
+
+        mStats.mGpuBytes -= screen->GpuBytes();
+        mStats.mCpuBytes -= screen->CpuBytes();
+        mStats.mResident--;
+        screen->UnLoadTextures(rend);
+        mEvictedCount++;
+    }
+}
+
+void CameraResidency::DebugUi()
+{
+    if (ImGui::CollapsingHeader("Camera residency"))
+    {
+        s32 budgetMb = static_cast<s32>(mBudgetBytes / (1024 * 1024));
+        if (ImGui::SliderInt("Budget (MB)", &budgetMb, 4, 512))
+        {
+            mBudgetBytes = static_cast<u32>(budgetMb) * 1024 * 1024;
+        }
+        ImGui::Text("Resident: %u loading: %u", mStats.mResident, mStats.mLoading);
+        ImGui::Text("GPU: %.1f MB CPU: %.1f MB", mStats.mGpuBytes / (1024.0f * 1024.0f), mStats.mCpuBytes / (1024.0f * 1024.0f));
+        ImGui::Text("Evicted: %u", mEvictedCount);
+    }
+}
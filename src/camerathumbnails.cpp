@@ -0,0 +1,380 @@
+#include "camerathumbnails.hpp"
+#include "gridmap.hpp"
+#include "resourcemapper.hpp"
+#include "filesystem.hpp"
+#include "replay.hpp"
+#include "oddlib/bits_factory.hpp"
+#include "oddlib/stream.hpp"
+#include "oddlib/exceptions.hpp"
+#include "logger.hpp"
+#include <SDL.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+static const u32 kCacheMagic = 0x424D4854; // "THMB"
+static const u32 kCacheVersion = 2;
+
+static u32 CellWidth(u32 level)
+{
+    return CameraThumbnails::kCellWidth >> level;
+}
+
+static u32 CellHeight(u32 level)
+{
+    return CameraThumbnails::kCellHeight >> level;
+}
+
+// Averages the source pixels under each destination pixel. 3 byte surfaces are copied, 4 byte
+// ones (FG1 layers) are alpha blended over what is already there.
+static void DownscaleInto(SDL_Surface* surface, u8* dst, u32 dstPitch, u32 dstW, u32 dstH)
+{
+    const u32 bpp = surface->format->BytesPerPixel;
+    if (bpp != 3 && bpp != 4)
+    {
+        LOG_WARNING("Can't make a thumbnail from a " << bpp << " byte per pixel surface");
+        return;
+    }
+
+    if (SDL_MUSTLOCK(surface))
+    {
+        SDL_LockSurface(surface);
+    }
+
+    const u32 srcW = static_cast<u32>(surface->w);
+    const u32 srcH = static_cast<u32>(surface->h);
+    const u8* srcPixels = static_cast<const u8*>(surface->pixels);
+
+    for (u32 y = 0; y < dstH; y++)
+    {
+        const u32 srcY0 = (y * srcH) / dstH;
+        const u32 srcY1 = std::max(srcY0 + 1, ((y + 1) * srcH) / dstH);
+        for (u32 x = 0; x < dstW; x++)
+        {
+            const u32 srcX0 = (x * srcW) / dstW;
+            const u32 srcX1 = std::max(srcX0 + 1, ((x + 1) * srcW) / dstW);
+
+            u32 sum[4] = {};
+            u32 count = 0;
+            for (u32 sy = srcY0; sy < srcY1; sy++)
+            {
+                const u8* row = srcPixels + (sy * surface->pitch);
+                for (u32 sx = srcX0; sx < srcX1; sx++)
+                {
+                    const u8* p = row + (sx * bpp);
+                    const u32 alpha = bpp == 4 ? p[3] : 255;
+
+                    // Weight by alpha so that transparent pixels don't darken the edges of the FG1
+                    sum[0] += p[0] * alpha;
+                    sum[1] += p[1] * alpha;
+                    sum[2] += p[2] * alpha;
+                    sum[3] += alpha;
+                    count++;
+                }
+            }
+
+            u8* out = dst + (y * dstPitch) + (x * 3);
+            if (sum[3] == 0)
+            {
+                continue;
+            }
+
+            const u32 coverage = sum[3] / count;
+            for (u32 c = 0; c < 3; c++)
+            {
+                const u32 colour = sum[c] / sum[3];
+                out[c] = static_cast<u8>(((colour * coverage) + (out[c] * (255 - coverage))) / 255);
+            }
+        }
+    }
+
+    if (SDL_MUSTLOCK(surface))
+    {
+        SDL_UnlockSurface(surface);
+    }
+}
+
+CameraThumbnails::CameraThumbnails(ResourceLocator& locator, IFileSystem& fs)
+    : mLocator(locator), mFs(fs)
+{
+
+}
+
+CameraThumbnails::~CameraThumbnails()
+{
+    assert(mTexture.IsValid() == false);
+}
+
+void CameraThumbnails::RequestCameras()
+{
+    while (mRequestedCount < CameraCount() && mPendingCameras.size() < kMaxPendingCameras)
+    {
+        const std::string& name = mNames[mRequestedCount];
+        mPendingCameras.push_back(name.empty() ? std::future<std::unique_ptr<Oddlib::IBits>>() : mLocator.LocateCamera(name));
+        mRequestedCount++;
+    }
+}
+
+void CameraThumbnails::SetScreens(const CameraGrid<GridScreen>& screens)
+{
+    // The atlas of the previous path must be unloaded first
+    assert(mTexture.IsValid() == false);
+
+    mNames.clear();
+    mYSize = screens.YSize();
+
+    StateHash hash;
+    for (const GridScreen& screen : screens)
+    {
+        mNames.push_back(screen.FileName());
+        hash.Add(mNames.back().c_str(), mNames.back().size() + 1);
+    }
+    hash.Add(mYSize);
+
+    for (const DataPaths::FileSystemInfo& fs : mLocator.GetDataPaths().ActiveDataPaths())
+    {
+        hash.Add(fs.mDataSetName.c_str(), fs.mDataSetName.size() + 1);
+        hash.Add(fs.mIsMod);
+
+        const std::string path = fs.mFileSystem->FsPath();
+        hash.Add(path.c_str(), path.size() + 1);
+
+        // A zip or iso data set is one file, directories only change when files come and go
+        u64 size = 0;
+        u64 modifiedTime = 0;
+        if (mFs.FileStamp(path, size, modifiedTime))
+        {
+            hash.Add(size);
+            hash.Add(modifiedTime);
+        }
+    }
+    mCacheKey = hash.Value64();
+
+    const u32 count = static_cast<u32>(mNames.size());
+    mColumns = std::max(1u, static_cast<u32>(std::ceil(std::sqrt(static_cast<f32>(count)))));
+    mRows = std::max(1u, (count + mColumns - 1) / mColumns);
+
+    // Level 0 on top, level 1 and 2 next to each other under it
+    mAtlasWidth = mColumns * kCellWidth;
+    mAtlasHeight = mRows * (kCellHeight + CellHeight(1));
+    mPixels.assign(mAtlasWidth * mAtlasHeight * 3, 0);
+
+    // Waits for any decodes of the previous path that are still running
+    mPendingCameras.clear();
+    mRequestedCount = 0;
+
+    mBuiltCount = 0;
+    mState = count > 0 ? eStates::eTryCache : eStates::eNoScreens;
+}
+
+bool CameraThumbnails::Build()
+{
+    if (mState == eStates::eTryCache)
+    {
+        mState = LoadFromCache() ? eStates::eReady : eStates::eBuilding;
+    }
+
+    if (mState == eStates::eBuilding)
+    {
+        Timer time;
+        while (mBuiltCount < CameraCount() && time.Elapsed() < kMaxExecutionTimeMs)
+        {
+            RequestCameras();
+
+            std::future<std::unique_ptr<Oddlib::IBits>>& next = mPendingCameras.front();
+            if (next.valid() && next.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                // Carry on next frame rather than block on the decode
+                break;
+            }
+
+            std::unique_ptr<Oddlib::IBits> cam = next.valid() ? next.get() : nullptr;
+            mPendingCameras.pop_front();
+            BuildCell(mBuiltCount, cam.get());
+            BuildLowerLevels(mBuiltCount);
+            mBuiltCount++;
+        }
+
+        // Keep the next cameras decoding whilst the frame carries on
+        RequestCameras();
+
+        if (mBuiltCount == CameraCount())
+        {
+            LOG_INFO("Built thumbnails for " << CameraCount() << " cameras");
+            SaveToCache();
+            mState = eStates::eReady;
+        }
+    }
+    return IsReady();
+}
+
+void CameraThumbnails::CellOrigin(u32 index, u32 level, u32& x, u32& y) const
+{
+    x = (index % mColumns) * CellWidth(level);
+    y = (index / mColumns) * CellHeight(level);
+    if (level > 0)
+    {
+        y += mRows * kCellHeight;
+        if (level > 1)
+        {
+            x += mColumns * CellWidth(1);
+        }
+    }
+}
+
+u8* CameraThumbnails::CellPixels(u32 index, u32 level)
+{
+    u32 x = 0;
+    u32 y = 0;
+    CellOrigin(index, level, x, y);
+    return mPixels.data() + (y * mAtlasWidth * 3) + (x * 3);
+}
+
+void CameraThumbnails::BuildCell(u32 index, Oddlib::IBits* cam)
+{
+    if (!cam)
+    {
+        return;
+    }
+
+    u8* cell = CellPixels(index, 0);
+    DownscaleInto(cam->GetSurface(), cell, mAtlasWidth * 3, kCellWidth, kCellHeight);
+    if (cam->GetFg1() && cam->GetFg1()->GetSurface())
+    {
+        DownscaleInto(cam->GetFg1()->GetSurface(), cell, mAtlasWidth * 3, kCellWidth, kCellHeight);
+    }
+}
+
+void CameraThumbnails::BuildLowerLevels(u32 index)
+{
+    const u32 pitch = mAtlasWidth * 3;
+    for (u32 level = 1; level < kLevelCount; level++)
+    {
+        const u8* src = CellPixels(index, level - 1);
+        u8* dst = CellPixels(index, level);
+        for (u32 y = 0; y < CellHeight(level); y++)
+        {
+            for (u32 x = 0; x < CellWidth(level); x++)
+            {
+                const u8* p = src + (y * 2 * pitch) + (x * 2 * 3);
+                for (u32 c = 0; c < 3; c++)
+                {
+                    const u32 sum = p[c] + p[c + 3] + p[pitch + c] + p[pitch + c + 3];
+                    dst[(y * pitch) + (x * 3) + c] = static_cast<u8>(sum / 4);
+                }
+            }
+        }
+    }
+}
+
+u32 CameraThumbnails::LevelForScreenWidth(f32 screenWidth)
+{
+    if (screenWidth > kCellWidth * 2)
+    {
+        return kLevelCount;
+    }
+
+    u32 level = 0;
+    while (level + 1 < kLevelCount && CellWidth(level + 1) >= screenWidth)
+    {
+        level++;
+    }
+    return level;
+}
+
+void CameraThumbnails::Render(AbstractRenderer& rend, u32 x, u32 y, u32 level, f32 xpos, f32 ypos, f32 w, f32 h)
+{
+    if (!IsReady())
+    {
+        return;
+    }
+
+    if (!mTexture.IsValid())
+    {
+        mTexture = rend.CreateTexture(AbstractRenderer::eTextureFormats::eRGB, mAtlasWidth, mAtlasHeight, AbstractRenderer::eTextureFormats::eRGB, mPixels.data(), true);
+    }
+
+    u32 cellX = 0;
+    u32 cellY = 0;
+    CellOrigin((x * mYSize) + y, level, cellX, cellY);
+    const f32 u0 = static_cast<f32>(cellX) / mAtlasWidth;
+    const f32 v0 = static_cast<f32>(cellY) / mAtlasHeight;
+    const f32 u1 = u0 + (static_cast<f32>(CellWidth(level)) / mAtlasWidth);
+    const f32 v1 = v0 + (static_cast<f32>(CellHeight(level)) / mAtlasHeight);
+
+    rend.TexturedQuad(mTexture, xpos, ypos, w, h, glm::vec4(u0, v0, u1, v1), AbstractRenderer::eForegroundLayer0, ColourU8{ 255, 255, 255, 255 });
+}
+
+void CameraThumbnails::UnloadTexture(AbstractRenderer& rend)
+{
+    if (mTexture.IsValid())
+    {
+        rend.DestroyTexture(mTexture);
+        mTexture = TextureHandle();
+    }
+}
+
+std::string CameraThumbnails::CacheFileName() const
+{
+    char name[64] = {};
+    sprintf(name, "{CacheDir}/CameraThumbnails_%016llX.bin", static_cast<unsigned long long>(mCacheKey));
+    return name;
+}
+
+bool CameraThumbnails::LoadFromCache()
+{
+    std::string fileName = CacheFileName();
+    if (!mFs.FileExists(fileName))
+    {
+        return false;
+    }
+
+    try
+    {
+        auto stream = mFs.Open(fileName);
+        u32 magic = 0;
+        u32 version = 0;
+        u64 cacheKey = 0;
+        u32 width = 0;
+        u32 height = 0;
+        stream->Read(magic);
+        stream->Read(version);
+        stream->Read(cacheKey);
+        stream->Read(width);
+        stream->Read(height);
+        if (magic != kCacheMagic || version != kCacheVersion || cacheKey != mCacheKey || width != mAtlasWidth || height != mAtlasHeight)
+        {
+            LOG_WARNING("Ignoring out of date camera thumbnails " << fileName);
+            return false;
+        }
+        stream->Read(mPixels);
+    }
+    catch (const Oddlib::Exception& ex)
+    {
+        LOG_WARNING("Failed to read camera thumbnails " << fileName << ": " << ex.what());
+        return false;
+    }
+
+    mBuiltCount = CameraCount();
+    return true;
+}
+
+void CameraThumbnails::SaveToCache()
+{
+    const std::string fileName = CacheFileName();
+    try
+    {
+        auto stream = mFs.Create(fileName);
+        stream->Write(kCacheMagic);
+        stream->Write(kCacheVersion);
+        stream->Write(mCacheKey);
+        stream->Write(mAtlasWidth);
+        stream->Write(mAtlasHeight);
+        stream->Write(mPixels);
+    }
+    catch (const Oddlib::Exception& ex)
+    {
+        LOG_WARNING("Failed to write camera thumbnails " << fileName << ": " << ex.what());
+    }
+}
@@ -0,0 +1,222 @@
+#include "collisiongraph.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+/*static*/ const s32 CollisionGraph::kNoLine;
+/*static*/ constexpr f32 CollisionGraph::kDefaultSnapTolerance;
+/*static*/ constexpr f32 CollisionGraph::kMaxFloorDrop;
+/*static*/ const u32 CollisionGraph::kMaxFollowSteps;
+
+static bool IsFloorType(CollisionLine::eLineTypes type)
+{
+    return type == CollisionLine::eFloor || type == CollisionLine::eBackGroundFloor || type == CollisionLine::eMineCarFloor;
+}
+
+// Closest distance between any end of a and any end of b
+static f32 EndDistance(const Line& a, const Line& b)
+{
+    return std::min(
+        std::min(glm::distance(a.mP1, b.mP1), glm::distance(a.mP1, b.mP2)),
+        std::min(glm::distance(a.mP2, b.mP1), glm::distance(a.mP2, b.mP2)));
+}
+
+void CollisionGraph::Build(const CollisionLines& lines, f32 snapTolerance)
+{
+    Clear();
+
+    mSegments.resize(lines.size());
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        const CollisionLine& line = *lines[i];
+        const glm::vec2 delta = line.mLine.Delta();
+
+        Segment& segment = mSegments[i];
+        segment.mP1 = line.mLine.mP1;
+        segment.mDirection = normalize_zero_safe(delta);
+        segment.mLength = glm::length(delta);
+        segment.mSlope = delta.x != 0.0f ? delta.y / delta.x : 0.0f;
+        segment.mMinX = std::min(line.mLine.mP1.x, line.mLine.mP2.x);
+        segment.mMaxX = std::max(line.mLine.mP1.x, line.mLine.mP2.x);
+        segment.mFloor = IsFloorType(line.mType) && delta.x != 0.0f;
+        segment.mPrevious = kNoLine;
+        segment.mNext = kNoLine;
+        segment.mLeft = kNoLine;
+        segment.mRight = kNoLine;
+    }
+
+    ConvertLinks(lines, snapTolerance);
+    JoinFloors(lines, snapTolerance);
+
+    if (mBrokenLinks > 0)
+    {
+        LOG_WARNING(mBrokenLinks << " collision line links were dropped as their lines don't meet");
+    }
+}
+
+void CollisionGraph::Clear()
+{
+    mSegments.clear();
+    mBrokenLinks = 0;
+    mSnappedJoins = 0;
+}
+
+void CollisionGraph::ConvertLinks(const CollisionLines& lines, f32 snapTolerance)
+{
+    std::unordered_map<const CollisionLine*, s32> indices;
+    indices.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        indices[lines[i].get()] = static_cast<s32>(i);
+    }
+
+    auto toIndex = [&](s32 from, const CollisionLine* to)
+    {
+        if (!to)
+        {
+            return kNoLine;
+        }
+
+        // A line that isn't in the path, such as one that has since been deleted
+        const auto it = indices.find(to);
+        if (it == std::end(indices))
+        {
+            LOG_WARNING("Collision line " << from << " links to a line that isn't in the path");
+            mBrokenLinks++;
+            return kNoLine;
+        }
+
+        const s32 index = it->second;
+        if (index == from || EndDistance(lines[from]->mLine, to->mLine) > snapTolerance)
+        {
+            LOG_WARNING("Collision line " << from << " links to line " << index << " which it doesn't touch");
+            mBrokenLinks++;
+            return kNoLine;
+        }
+        return index;
+    };
+
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        const s32 from = static_cast<s32>(i);
+        mSegments[i].mPrevious = toIndex(from, lines[i]->mLink.mPrevious);
+        mSegments[i].mNext = toIndex(from, lines[i]->mLink.mNext);
+    }
+}
+
+void CollisionGraph::JoinFloors(const CollisionLines& lines, f32 snapTolerance)
+{
+    // Valid links between floors of the same type join them directly
+    for (size_t i = 0; i < mSegments.size(); i++)
+    {
+        Segment& segment = mSegments[i];
+        if (!segment.mFloor)
+        {
+            continue;
+        }
+
+        for (s32 linked : { segment.mPrevious, segment.mNext })
+        {
+            if (linked == kNoLine || !mSegments[linked].mFloor || lines[linked]->mType != lines[i]->mType)
+            {
+                continue;
+            }
+
+            if (mSegments[linked].mMinX < segment.mMinX)
+            {
+                segment.mLeft = linked;
+            }
+            else
+            {
+                segment.mRight = linked;
+            }
+        }
+    }
+
+    // Then unlinked floors are joined by their ends, each right end is matched against the left
+    // ends sorted by x so that only the ends within the tolerance are compared
+    struct End
+    {
+        f32 mX;
+        s32 mLine;
+    };
+
+    std::vector<End> leftEnds;
+    for (size_t i = 0; i < mSegments.size(); i++)
+    {
+        if (mSegments[i].mFloor)
+        {
+            leftEnds.push_back(End{ mSegments[i].mMinX, static_cast<s32>(i) });
+        }
+    }
+    std::sort(leftEnds.begin(), leftEnds.end(), [](const End& a, const End& b) { return a.mX < b.mX; });
+
+    for (const End& end : leftEnds)
+    {
+        Segment& segment = mSegments[end.mLine];
+        if (segment.mRight != kNoLine)
+        {
+            continue;
+        }
+
+        const glm::vec2 rightEnd(segment.mMaxX, YAt(end.mLine, segment.mMaxX));
+        auto it = std::lower_bound(leftEnds.begin(), leftEnds.end(), rightEnd.x - snapTolerance, [](const End& a, f32 x) { return a.mX < x; });
+
+        s32 nearest = kNoLine;
+        f32 nearestDistance = snapTolerance;
+        for (; it != leftEnds.end() && it->mX <= rightEnd.x + snapTolerance; ++it)
+        {
+            if (it->mLine == end.mLine || mSegments[it->mLine].mLeft != kNoLine || lines[it->mLine]->mType != lines[end.mLine]->mType)
+            {
+                continue;
+            }
+
+            const f32 distance = glm::distance(rightEnd, glm::vec2(it->mX, YAt(it->mLine, it->mX)));
+            if (distance <= nearestDistance && (nearest == kNoLine || distance < nearestDistance))
+            {
+                nearest = it->mLine;
+                nearestDistance = distance;
+            }
+        }
+
+        if (nearest != kNoLine)
+        {
+            segment.mRight = nearest;
+            mSegments[nearest].mLeft = end.mLine;
+            mSnappedJoins++;
+        }
+    }
+}
+
+s32 CollisionGraph::FloorBelow(s32 lineIdx, const glm::vec2& pos) const
+{
+    if (lineIdx < 0 || lineIdx >= static_cast<s32>(mSegments.size()))
+    {
+        return kNoLine;
+    }
+
+    s32 idx = lineIdx;
+    for (u32 step = 0; step < kMaxFollowSteps && idx != kNoLine; step++)
+    {
+        const Segment& segment = mSegments[idx];
+        if (!segment.mFloor)
+        {
+            return kNoLine;
+        }
+
+        if (pos.x < segment.mMinX)
+        {
+            idx = segment.mLeft;
+        }
+        else if (pos.x > segment.mMaxX)
+        {
+            idx = segment.mRight;
+        }
+        else
+        {
+            const f32 drop = YAt(idx, pos.x) - pos.y;
+            return drop >= 0.0f && drop <= kMaxFloorDrop ? idx : kNoLine;
+        }
+    }
+    return kNoLine;
+}
@@ -2,6 +2,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/vector_angle.hpp>
 #include "reverse_for.hpp"
+#include "debug.hpp"
 
 /*static*/ const std::map<CollisionLine::eLineTypes, CollisionLine::LineData> CollisionLine::mData =
 {
@@ -131,17 +132,31 @@ static void RenderCircle(AbstractRenderer& rend, const glm::vec2& pos, const Col
     rend.CircleFilled(colour, pos.x, pos.y, radius, 12, AbstractRenderer::eLayers::eEditor + 1, AbstractRenderer::eNormal, AbstractRenderer::eScreen);
 }
 
-/*static*/ void CollisionLine::Render(AbstractRenderer& rend, const CollisionLines& lines)
+/*static*/ void CollisionLine::Render(AbstractRenderer& rend, const WorldRect& view, const CollisionLines& lines)
 {
+    // Arrow heads and connection points are drawn a little past the ends of the line
+    const WorldRect paddedView = view.Expanded(20.0f);
+    auto isVisible = [&](const CollisionLine& item)
+    {
+        return paddedView.Intersects(WorldRect{ glm::min(item.mLine.mP1, item.mLine.mP2), glm::max(item.mLine.mP1, item.mLine.mP2) });
+    };
+
+    u32 visible = 0;
     for (const std::unique_ptr<CollisionLine>& item : lines)
     {
-        RenderLine(rend, *item);
+        if (isVisible(*item))
+        {
+            RenderLine(rend, *item);
+            visible++;
+        }
     }
+    Debugging().mCulling.mVisibleLines += visible;
+    Debugging().mCulling.mCulledLines += static_cast<u32>(lines.size()) - visible;
 
     // Render would-be connection points - always on top of lines
     for (const std::unique_ptr<CollisionLine>& item : lines)
     {
-        if (item->mLink.mNext)
+        if (item->mLink.mNext && isVisible(*item))
         {
             const glm::vec2 p1 = rend.WorldToScreen(item->mLine.mP1);
             RenderCircle(rend, p1, ColourU8{ 0, 0, 0, 255 }, 5.0f);
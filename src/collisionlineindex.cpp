@@ -0,0 +1,190 @@
+#include "collisionlineindex.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*static*/ constexpr f32 CollisionLineIndex::kDefaultCellSize;
+
+// Liang-Barsky clip of the segment against the rect, true if any of it is left
+static bool IsSegmentInRect(const glm::vec2& p1, const glm::vec2& p2, const WorldRect& rect)
+{
+    const glm::vec2 delta = p2 - p1;
+    const f32 p[4] = { -delta.x, delta.x, -delta.y, delta.y };
+    const f32 q[4] = { p1.x - rect.mMin.x, rect.mMax.x - p1.x, p1.y - rect.mMin.y, rect.mMax.y - p1.y };
+
+    f32 tEnter = 0.0f;
+    f32 tExit = 1.0f;
+    for (u32 i = 0; i < 4; i++)
+    {
+        if (p[i] == 0.0f)
+        {
+            // Parallel to this edge and outside of it
+            if (q[i] < 0.0f)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const f32 t = q[i] / p[i];
+        if (p[i] < 0.0f)
+        {
+            tEnter = std::max(tEnter, t);
+        }
+        else
+        {
+            tExit = std::min(tExit, t);
+        }
+
+        if (tEnter > tExit)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static WorldRect LineBounds(const CollisionLine& line)
+{
+    return WorldRect{ glm::min(line.mLine.mP1, line.mLine.mP2), glm::max(line.mLine.mP1, line.mLine.mP2) };
+}
+
+void CollisionLineIndex::Build(const CollisionLines& lines, f32 cellSize)
+{
+    mDirty = false;
+    mCellSize = cellSize;
+    mCellStart.clear();
+    mCellLines.clear();
+    mVisited.assign(lines.size(), 0);
+    mQueryStamp = 0;
+
+    if (lines.empty())
+    {
+        mXCells = 0;
+        mYCells = 0;
+        mCellStart.push_back(0);
+        return;
+    }
+
+    glm::vec2 boundsMin = LineBounds(*lines[0]).mMin;
+    glm::vec2 boundsMax = LineBounds(*lines[0]).mMax;
+    for (const std::unique_ptr<CollisionLine>& line : lines)
+    {
+        const WorldRect bounds = LineBounds(*line);
+        boundsMin = glm::min(boundsMin, bounds.mMin);
+        boundsMax = glm::max(boundsMax, bounds.mMax);
+    }
+
+    mOrigin = boundsMin;
+    mXCells = static_cast<u32>((boundsMax.x - boundsMin.x) / cellSize) + 1;
+    mYCells = static_cast<u32>((boundsMax.y - boundsMin.y) / cellSize) + 1;
+
+    // Count the lines in each cell, then turn the counts in to where each cell starts
+    mCellStart.assign(CellCount() + 1, 0);
+    auto forEachCell = [&](const CollisionLine& line, auto fn)
+    {
+        const WorldRect bounds = LineBounds(line);
+        const u32 xEnd = ClampedCellX(bounds.mMax.x);
+        const u32 yEnd = ClampedCellY(bounds.mMax.y);
+        for (u32 x = ClampedCellX(bounds.mMin.x); x <= xEnd; x++)
+        {
+            for (u32 y = ClampedCellY(bounds.mMin.y); y <= yEnd; y++)
+            {
+                fn((x * mYCells) + y);
+            }
+        }
+    };
+
+    for (const std::unique_ptr<CollisionLine>& line : lines)
+    {
+        forEachCell(*line, [&](u32 cell) { mCellStart[cell + 1]++; });
+    }
+
+    for (u32 cell = 0; cell < CellCount(); cell++)
+    {
+        mCellStart[cell + 1] += mCellStart[cell];
+    }
+
+    mCellLines.resize(mCellStart.back());
+    std::vector<u32> cursor(mCellStart.begin(), mCellStart.end() - 1);
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        forEachCell(*lines[i], [&](u32 cell) { mCellLines[cursor[cell]++] = static_cast<s32>(i); });
+    }
+}
+
+u32 CollisionLineIndex::ClampedCellX(f32 x) const
+{
+    return static_cast<u32>(glm::clamp(std::floor((x - mOrigin.x) / mCellSize), 0.0f, static_cast<f32>(mXCells - 1)));
+}
+
+u32 CollisionLineIndex::ClampedCellY(f32 y) const
+{
+    return static_cast<u32>(glm::clamp(std::floor((y - mOrigin.y) / mCellSize), 0.0f, static_cast<f32>(mYCells - 1)));
+}
+
+void CollisionLineIndex::Candidates(const WorldRect& rect, std::vector<s32>& out) const
+{
+    out.clear();
+    if (CellCount() == 0)
+    {
+        return;
+    }
+
+    mQueryStamp++;
+    if (mQueryStamp == 0)
+    {
+        std::fill(mVisited.begin(), mVisited.end(), 0);
+        mQueryStamp = 1;
+    }
+
+    const u32 xEnd = ClampedCellX(rect.mMax.x);
+    const u32 yEnd = ClampedCellY(rect.mMax.y);
+    for (u32 x = ClampedCellX(rect.mMin.x); x <= xEnd; x++)
+    {
+        for (u32 y = ClampedCellY(rect.mMin.y); y <= yEnd; y++)
+        {
+            const u32 cell = (x * mYCells) + y;
+            for (u32 i = mCellStart[cell]; i < mCellStart[cell + 1]; i++)
+            {
+                const s32 line = mCellLines[i];
+                if (mVisited[line] != mQueryStamp)
+                {
+                    mVisited[line] = mQueryStamp;
+                    out.push_back(line);
+                }
+            }
+        }
+    }
+}
+
+void CollisionLineIndex::Query(const CollisionLines& lines, const WorldRect& rect, std::vector<s32>& out) const
+{
+    out.clear();
+    Candidates(rect, mCandidates);
+    for (s32 idx : mCandidates)
+    {
+        if (IsSegmentInRect(lines[idx]->mLine.mP1, lines[idx]->mLine.mP2, rect))
+        {
+            out.push_back(idx);
+        }
+    }
+    std::sort(out.begin(), out.end());
+}
+
+s32 CollisionLineIndex::Pick(const CollisionLines& lines, const glm::vec2& pos, f32 lineScale) const
+{
+    // The same thickness CollisionLine::Pick tests against
+    const f32 width = 10.0f * lineScale;
+    const f32 reach = (width / 2.0f) + 0.5f;
+    Candidates(WorldRect{ pos - glm::vec2(reach, reach), pos + glm::vec2(reach, reach) }, mCandidates);
+
+    s32 picked = -1;
+    for (s32 idx : mCandidates)
+    {
+        if (idx > picked && Physics::IsPointInThickLine(lines[idx]->mLine.mP1, lines[idx]->mLine.mP2, pos, width))
+        {
+            picked = idx;
+        }
+    }
+    return picked;
+}
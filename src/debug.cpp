@@ -1,6 +1,7 @@
 #include "debug.hpp"
 #include "engine.hpp"
 #include "abstractrenderer.hpp"
+#include <algorithm>
 
 struct Key
 {
@@ -21,13 +22,21 @@ Debug& Debugging()
     return d;
 }
 
-void Debug::Update(class InputState& input)
+void Debug::RemoveSection(SectionId id)
 {
-    if (input.mKeys[SDL_SCANCODE_F1].IsPressed())
+    // Only cleared as this may be called from a section, they're removed after they've all been drawn
+    for (Section& section : mSections)
     {
-        mShowDebugUi = !mShowDebugUi;
+        if (section.mId == id)
+        {
+            section.mFn = nullptr;
+            return;
+        }
     }
+}
 
+void Debug::Update(class InputState& input)
+{
     if (input.ActiveController() && input.ActiveController()->mGamePadButtons[SDL_CONTROLLER_BUTTON_GUIDE].IsPressed())
     {
         mFnNextPath();
@@ -50,6 +59,7 @@ void Debug::Update(class InputState& input)
                 ImGui::Checkbox("Object bounding boxes", &mObjectBoundingBoxes);
                 ImGui::Checkbox("Ray casts", &mRayCasts);
                 ImGui::Checkbox("Display font atlas", &mDrawFontAtlas);
+                ImGui::Checkbox("Cull to view", &mCullToView);
                 if (ImGui::Checkbox("VSync", &mVsync))
                 {
                     mChangeVSync = true;
@@ -68,11 +78,36 @@ void Debug::Update(class InputState& input)
                 ImGui::Checkbox("Animation browser", &Debugging().mBrowserUi.animationBrowserOpen);
             }
 
-            for (auto& section : mSections)
+            if (ImGui::CollapsingHeader("Culling"))
+            {
+                ImGui::Text("Objects: %u visible %u culled", mCulling.mVisibleObjects, mCulling.mCulledObjects);
+                ImGui::Text("Screens: %u visible %u culled", mCulling.mVisibleScreens, mCulling.mCulledScreens);
+                ImGui::Text("Collision lines: %u visible %u culled", mCulling.mVisibleLines, mCulling.mCulledLines);
+                ImGui::Text("Object rects: %u visible %u culled", mCulling.mVisibleObjectRects, mCulling.mCulledObjectRects);
+            }
+
+            if (ImGui::CollapsingHeader("Activation"))
+            {
+                ImGui::Checkbox("Sleep distant objects", &mSleepDistantObjects);
+                ImGui::Text("Objects: %u awake %u asleep", mActivation.mAwake, mActivation.mAsleep);
+                ImGui::Text("Always active: %u", mActivation.mAlwaysActive);
+            }
+
+            // Indexed as a section may add or remove others
+            for (size_t i = 0; i < mSections.size(); i++)
             {
-                section();
+                if (mSections[i].mFn)
+                {
+                    std::function<void()> fn = mSections[i].mFn;
+                    fn();
+                }
             }
 
+            mSections.erase(std::remove_if(std::begin(mSections), std::end(mSections), [](const Section& section)
+            {
+                return !section.mFn;
+            }), std::end(mSections));
+
             if (ImGui::CollapsingHeader("Paths"))
             {
                 if (ImGui::Button("Load next path"))
@@ -117,10 +152,7 @@ void Debug::Update(class InputState& input)
                     {
                         if (ImGui::Checkbox(key.mName, &key.mFakeDown))
                         {
-                            SDL_KeyboardEvent e = {};
-                            e.keysym.scancode = key.mScanCode;
-                            e.type = key.mFakeDown ? SDL_KEYDOWN : SDL_KEYUP;
-                            mInput->OnKeyEvent(e);
+                            mInput->mKeys[key.mScanCode].SetRawDownState(key.mFakeDown);
                         }
                     }
                 }
@@ -0,0 +1,126 @@
+#include "debugoverlay.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+// FNV-1a, the first byte says what kind of part it is so that "1" and 1 don't collide
+static u64 PartKey(char kind, const void* data, size_t size)
+{
+    u64 hash = 14695981039346656037ull;
+    hash ^= static_cast<u8>(kind);
+    hash *= 1099511628211ull;
+
+    const u8* bytes = static_cast<const u8*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+DebugOverlay::DebugOverlay()
+{
+    // Enough for a busy map, so that nothing is allocated during the game
+    const u32 kTexts = 512;
+    mRectX.reserve(kTexts);
+    mRectY.reserve(kTexts);
+    mRectW.reserve(kTexts);
+    mRectH.reserve(kTexts);
+    mRectColour.reserve(kTexts);
+    mTextX.reserve(kTexts);
+    mTextY.reserve(kTexts);
+    mTextSize.reserve(kTexts);
+    mTextColour.reserve(kTexts);
+    mTextFirstPart.reserve(kTexts);
+    mPartKey.reserve(kTexts * 8);
+    mPartStart.reserve(kTexts * 8);
+    mChars.reserve(kTexts * 64);
+}
+
+void DebugOverlay::Rect(f32 x, f32 y, f32 w, f32 h, u32 colour)
+{
+    mRectX.push_back(x);
+    mRectY.push_back(y);
+    mRectW.push_back(w);
+    mRectH.push_back(h);
+    mRectColour.push_back(colour);
+}
+
+void DebugOverlay::BeginText(f32 x, f32 y, f32 fontSize, u32 colour)
+{
+    assert(!mInText);
+    mInText = true;
+    mTextX.push_back(x);
+    mTextY.push_back(y);
+    mTextSize.push_back(fontSize);
+    mTextColour.push_back(colour);
+    mTextFirstPart.push_back(PartCount());
+}
+
+void DebugOverlay::Append(const char* text)
+{
+    assert(mInText);
+    const size_t length = strlen(text);
+    if (length == 0)
+    {
+        return;
+    }
+
+    const u32 start = static_cast<u32>(mChars.size());
+    mChars.insert(mChars.end(), text, text + length + 1);
+    AddPart(PartKey('s', text, length), start);
+}
+
+void DebugOverlay::Append(f32 value)
+{
+    assert(mInText);
+    const u32 start = static_cast<u32>(mChars.size());
+
+    // Same formatting as std::to_string
+    mChars.resize(start + 64);
+    const int length = snprintf(mChars.data() + start, 64, "%f", value);
+    mChars.resize(start + (length > 0 && length < 64 ? length : 63) + 1);
+    AddPart(PartKey('f', &value, sizeof(value)), start);
+}
+
+void DebugOverlay::Append(s32 value)
+{
+    assert(mInText);
+    const u32 start = static_cast<u32>(mChars.size());
+
+    mChars.resize(start + 16);
+    const int length = snprintf(mChars.data() + start, 16, "%d", value);
+    mChars.resize(start + length + 1);
+    AddPart(PartKey('d', &value, sizeof(value)), start);
+}
+
+void DebugOverlay::EndText()
+{
+    assert(mInText);
+    mInText = false;
+}
+
+void DebugOverlay::AddPart(u64 key, u32 start)
+{
+    mPartKey.push_back(key);
+    mPartStart.push_back(start);
+}
+
+void DebugOverlay::Clear()
+{
+    assert(!mInText);
+    mRectX.clear();
+    mRectY.clear();
+    mRectW.clear();
+    mRectH.clear();
+    mRectColour.clear();
+    mTextX.clear();
+    mTextY.clear();
+    mTextSize.clear();
+    mTextColour.clear();
+    mTextFirstPart.clear();
+    mPartKey.clear();
+    mPartStart.clear();
+    mChars.clear();
+}
@@ -1,42 +1,70 @@
 #include "editormode.hpp"
 #include "engine.hpp"
 #include "debug.hpp"
+#include <cmath>
+#include <algorithm>
 
 
+// Consecutive toggles in a group merge in to one command that keeps every line's change packed
 class CommandSelectOrDeselectLine : public ICommandWithId<CommandSelectOrDeselectLine>
 {
 public:
     NO_MOVE_OR_MOVE_ASSIGN(CommandSelectOrDeselectLine);
 
     CommandSelectOrDeselectLine(CollisionLines& lines, Selection& selection, s32 idx, bool select)
-        : mLines(lines), mSelection(selection), mIdx(idx), mSelect(select) { }
+        : mLines(lines), mSelection(selection)
+    {
+        mToggles.push_back(Toggle{ idx, select });
+    }
+
+    void Merge(CollisionLines& /*lines*/, Selection& /*selection*/, s32 idx, bool select)
+    {
+        mToggles.push_back(Toggle{ idx, select });
+    }
 
     virtual void Redo() final
     {
-        mSelection.Select(mLines, mIdx, mSelect);
+        for (const Toggle& toggle : mToggles)
+        {
+            mSelection.Select(mLines, toggle.mIdx, toggle.mSelect);
+        }
     }
 
     virtual void Undo() final
     {
-        mSelection.Select(mLines, mIdx, !mSelect);
+        for (auto it = mToggles.rbegin(); it != mToggles.rend(); ++it)
+        {
+            mSelection.Select(mLines, it->mIdx, !it->mSelect);
+        }
     }
 
+    virtual bool CanMerge() const final { return true; }
+
     virtual std::string Message() final
     {
-        if (mSelect)
+        if (mToggles.size() > 1)
+        {
+            return "Toggle selection of " + std::to_string(mToggles.size()) + " lines";
+        }
+        else if (mToggles[0].mSelect)
         {
-            return "Select line " + std::to_string(mIdx);
+            return "Select line " + std::to_string(mToggles[0].mIdx);
         }
         else
         {
-            return "De select line " + std::to_string(mIdx);
+            return "De select line " + std::to_string(mToggles[0].mIdx);
         }
     }
 private:
+    struct Toggle
+    {
+        s32 mIdx;
+        bool mSelect;
+    };
+
     CollisionLines& mLines;
     Selection& mSelection;
-    const s32 mIdx;
-    const bool mSelect;
+    std::vector<Toggle> mToggles;
 };
 
 class CommandClearSelection : public ICommandWithId<CommandClearSelection>
@@ -68,7 +96,47 @@ public:
 private:
     CollisionLines& mLines;
     Selection& mSelection;
-    std::set<s32> mOldSelection;
+    std::vector<s32> mOldSelection;
+};
+
+// Replaces the whole selection in one step, so selecting hundreds of lines with a box is one undo
+class CommandSetSelection : public ICommandWithId<CommandSetSelection>
+{
+public:
+    NO_MOVE_OR_MOVE_ASSIGN(CommandSetSelection);
+
+    CommandSetSelection(CollisionLines& lines, Selection& selection, std::vector<s32> newSelection)
+        : mLines(lines), mSelection(selection), mOldSelection(selection.SelectedLines()), mNewSelection(std::move(newSelection)) { }
+
+    virtual void Redo() final
+    {
+        Apply(mNewSelection);
+    }
+
+    virtual void Undo() final
+    {
+        Apply(mOldSelection);
+    }
+
+    virtual std::string Message() final
+    {
+        return "Select " + std::to_string(mNewSelection.size()) + " lines";
+    }
+
+private:
+    void Apply(const std::vector<s32>& selected)
+    {
+        mSelection.Clear(mLines);
+        for (s32 idx : selected)
+        {
+            mSelection.Select(mLines, idx, true);
+        }
+    }
+
+    CollisionLines& mLines;
+    Selection& mSelection;
+    const std::vector<s32> mOldSelection;
+    const std::vector<s32> mNewSelection;
 };
 
 inline std::string FormatVec2(const glm::vec2& vec)
@@ -129,54 +197,10 @@ private:
 };
 
 
-class MoveSelection : public ICommandWithId<MoveSelection>
+std::string MoveSelection::Message()
 {
-public:
-    NO_MOVE_OR_MOVE_ASSIGN(MoveSelection);
-
-    MoveSelection(CollisionLines& lines, Selection& selection, const glm::vec2& delta)
-        : mLines(lines), mSelection(selection), mDelta(delta)
-    {
-
-    }
-
-    void Merge(CollisionLines& /*lines*/, Selection& /*selection*/, const glm::vec2& delta)
-    {
-        mDelta += delta;
-    }
-
-    virtual void Redo() final
-    {
-        for (s32 idx : mSelection.SelectedLines())
-        {
-            mLines[idx]->mLine.mP1 += mDelta;
-            mLines[idx]->mLine.mP2 += mDelta;
-        }
-    }
-
-    virtual void Undo() final
-    {
-        for (s32 idx : mSelection.SelectedLines())
-        {
-            mLines[idx]->mLine.mP1 -= mDelta;
-            mLines[idx]->mLine.mP2 -= mDelta;
-        }
-    }
-
-    virtual std::string Message() final
-    {
-        return "Move selection by " + FormatVec2(mDelta);
-    }
-
-    virtual bool CanMerge() const final
-    {
-        return true;
-    }
-private:
-    CollisionLines& mLines;
-    Selection& mSelection;
-    glm::vec2 mDelta;
-};
+    return "Move selection by " + FormatVec2(mDelta);
+}
 
 static u32 gTypeIds = 0;
 u32 NextId()
@@ -185,25 +209,47 @@ u32 NextId()
     return gTypeIds;
 }
 
-std::set<s32> Selection::Clear(CollisionLines& items)
+std::vector<s32> Selection::Clear(CollisionLines& items)
 {
     for (s32 idx : mSelectedLines)
     {
         items[idx]->SetSelected(false);
+        mBits[static_cast<u32>(idx) / 64] &= ~Bit(idx);
     }
-    auto ret = std::move(mSelectedLines);
+    // Copied rather than moved out so the selection keeps its storage
+    std::vector<s32> ret = mSelectedLines;
+    mSelectedLines.clear();
     return ret;
 }
 
+void Selection::Reset()
+{
+    std::fill(mBits.begin(), mBits.end(), 0ull);
+    mSelectedLines.clear();
+}
+
 void Selection::Select(CollisionLines& items, s32 idx, bool select)
 {
-    if (items[idx]->SetSelected(select))
+    items[idx]->SetSelected(select);
+    if (select == IsSelected(idx))
+    {
+        return;
+    }
+
+    if (select)
     {
-        mSelectedLines.insert(idx);
+        const u32 word = static_cast<u32>(idx) / 64;
+        if (word >= mBits.size())
+        {
+            mBits.resize((items.size() + 63) / 64);
+        }
+        mBits[word] |= Bit(idx);
+        mSelectedLines.push_back(idx);
     }
     else
     {
-        mSelectedLines.erase(idx);
+        mBits[static_cast<u32>(idx) / 64] &= ~Bit(idx);
+        mSelectedLines.erase(std::find(mSelectedLines.begin(), mSelectedLines.end(), idx));
     }
 }
 
@@ -220,24 +266,105 @@ void UndoStack::DebugRenderCommandList() const
 {
     if (ImGui::CollapsingHeader("Undo stack"))
     {
-        for (const auto& cmd : mUndoStack)
-        {
-            ImGui::TextUnformatted(cmd->Message().c_str());
-        }
-
         if (mUndoStack.empty())
         {
             ImGui::TextUnformatted("(Empty)");
         }
+        else
+        {
+            // Only the rows in view are built, the stack grows over a long editing session
+            ImGuiListClipper clipper(static_cast<int>(mUndoStack.size()), ImGui::GetTextLineHeightWithSpacing());
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+            {
+                ImGui::TextUnformatted(mUndoStack[i]->Message().c_str());
+            }
+            clipper.End();
+        }
+    }
+}
+
+void UndoStack::Add(std::unique_ptr<ICommand> cmd)
+{
+    if (mGroup)
+    {
+        mGroup->Add(std::move(cmd));
+        return;
+    }
+
+    // If the active index isn't the latest item then remove everything after it
+    if (mCommandIndex != Count())
+    {
+        mUndoStack.erase(mUndoStack.begin() + mCommandIndex, mUndoStack.end());
+    }
+
+    mUndoStack.emplace_back(std::move(cmd));
+
+    // If we are over the stack limit remove the first item to stay within the limit
+    if (mStackLimit != -1 && static_cast<s32>(Count()) > mStackLimit)
+    {
+        mUndoStack.erase(mUndoStack.begin(), mUndoStack.begin() + 1);
+    }
+    else
+    {
+        mCommandIndex++;
+    }
+}
+
+ICommand* UndoStack::LastCommand() const
+{
+    if (mGroup)
+    {
+        return mGroup->Last();
+    }
+    return mUndoStack.empty() ? nullptr : mUndoStack.back().get();
+}
+
+void UndoStack::BeginGroup(const std::string& name)
+{
+    if (mGroupDepth++ == 0)
+    {
+        mGroup = std::make_unique<CommandGroup>(name);
+    }
+}
+
+void UndoStack::EndGroup()
+{
+    if (mGroupDepth > 0 && --mGroupDepth == 0)
+    {
+        CloseGroup();
+    }
+}
+
+void UndoStack::CloseGroup()
+{
+    mGroupDepth = 0;
+    std::unique_ptr<CommandGroup> group = std::move(mGroup);
+    if (!group || group->Count() == 0)
+    {
+        return;
+    }
+
+    if (group->Count() == 1)
+    {
+        Add(group->TakeFirst());
+    }
+    else
+    {
+        Add(std::move(group));
     }
 }
 
 void UndoStack::Clear()
 {
     mUndoStack.clear();
+    mCommandIndex = 0;
+    mGroup = nullptr;
+    mGroupDepth = 0;
 }
+
 void UndoStack::Undo()
 {
+    CloseGroup();
     if (Count() > 0 && mCommandIndex >= 1)
     {
         LOG_ERROR("Undoing command: " << mUndoStack[mCommandIndex - 1]->Message());
@@ -252,6 +379,7 @@ void UndoStack::Undo()
 
 void UndoStack::Redo()
 {
+    CloseGroup();
     if (mCommandIndex + 1 <= Count())
     {
         LOG_ERROR("Redoing command: " << mUndoStack[mCommandIndex]->Message());
@@ -264,8 +392,8 @@ void UndoStack::Redo()
     }
 }
 
-EditorMode::EditorMode(GridMapState& mapState)
-    : mMapState(mapState)
+EditorMode::EditorMode(GridMapState& mapState, ResourceLocator& locator)
+    : mMapState(mapState), mLocator(locator)
 {
 
 }
@@ -278,18 +406,15 @@ void EditorMode::Update(const InputState& input, CoordinateSpace& coords)
     {
         mMapState.mState = GridMapState::eStates::eToGame;
         coords.mSmoothCameraPosition = true;
-        mMapState.mModeSwitchTimeout = SDL_GetTicks() + kSwitchTimeMs;
-
-        const s32 mouseCamX = static_cast<s32>(mousePosWorld.x / mMapState.kCameraBlockSize.x);
-        const s32 mouseCamY = static_cast<s32>(mousePosWorld.y / mMapState.kCameraBlockSize.y);
+        mMapState.mModeSwitchTimeout = mMapState.mTickCounter + kSwitchTimeTicks;
 
-        mMapState.mCameraPosition.x = (mouseCamX * mMapState.kCameraBlockSize.x) + (mMapState.kVirtualScreenSize.x / 2);
-        mMapState.mCameraPosition.y = (mouseCamY * mMapState.kCameraBlockSize.y) + (mMapState.kVirtualScreenSize.y / 2);
+        const ScreenGrid::Cell mouseCam = mMapState.mScreens.CellAt(mousePosWorld);
+        mMapState.mCameraPosition = mMapState.mScreens.BlockOrigin(mouseCam.mX, mouseCam.mY) + (mMapState.kVirtualScreenSize / 2.0f);
 
         if (mMapState.mCameraSubject)
         {
-            mMapState.mCameraSubject->mXPos = mMapState.mCameraPosition.x;
-            mMapState.mCameraSubject->mYPos = mMapState.mCameraPosition.y;
+            mMapState.mCameraSubject->SetXPos(mMapState.mCameraPosition.x);
+            mMapState.mCameraSubject->SetYPos(mMapState.mCameraPosition.y);
         }
     }
 
@@ -321,10 +446,21 @@ void EditorMode::Update(const InputState& input, CoordinateSpace& coords)
     coords.SetScreenSize(glm::vec2(coords.Width(), coords.Height()) * mEditorCamZoom);
     coords.SetCameraPosition(mMapState.mCameraPosition);
 
+    // Lines being dragged move every frame, so nothing is picked until the drag is over and the
+    // index is only rebuilt once when the mouse is released. A drag only starts on a line so
+    // the cursor stays as it was.
+    const bool draggingLines = input.mMouseButtons[0].IsDown() && !input.mMouseButtons[0].IsPressed() &&
+        mSelectionState != eSelectionState::eNone && mSelectionState != eSelectionState::eBoxSelect;
+
     // Find out what line is under the mouse pos, if any
-    const s32 lineIdx = CollisionLine::Pick(mMapState.mCollisionItems, mousePosWorld, mMapState.mState == GridMapState::eStates::eInGame ? 1.0f : mEditorCamZoom);
+    s32 lineIdx = -1;
+    if (!draggingLines)
+    {
+        mLineIndex.Update(mMapState.mCollisionItems);
+        lineIdx = mLineIndex.Pick(mMapState.mCollisionItems, mousePosWorld, mMapState.mState == GridMapState::eStates::eInGame ? 1.0f : mEditorCamZoom);
+    }
 
-    if (lineIdx >= 0)
+    if (lineIdx >= 0 || draggingLines)
     {
         SDL_SetCursor(SDL_CreateSystemCursor(SDL_SYSTEM_CURSOR_HAND)); // SDL_SYSTEM_CURSOR_CROSSHAIR
     }
@@ -335,18 +471,30 @@ void EditorMode::Update(const InputState& input, CoordinateSpace& coords)
 
     if (input.mMouseButtons[0].IsReleased())
     {
+        if (mSelectionState == eSelectionState::eBoxSelect)
+        {
+            BoxSelect(mousePosWorld, input.mKeys[SDL_SCANCODE_LCTRL].IsDown());
+        }
         mSelectionState = eSelectionState::eNone;
     }
 
+    // Ends the Ctrl click toggle group
+    if (mUndoStack.InGroup() && !input.mKeys[SDL_SCANCODE_LCTRL].IsDown())
+    {
+        mUndoStack.EndGroup();
+    }
+
     if (input.mKeys[SDL_SCANCODE_LCTRL].IsDown())
     {
         if (input.mKeys[SDL_SCANCODE_Z].IsPressed())
         {
             mUndoStack.Undo();
+            mLineIndex.Invalidate();
         }
         else if (input.mKeys[SDL_SCANCODE_Y].IsPressed())
         {
             mUndoStack.Redo();
+            mLineIndex.Invalidate();
         }
     }
 
@@ -362,7 +510,13 @@ void EditorMode::Update(const InputState& input, CoordinateSpace& coords)
                 LOG_INFO("Toggle line selected status");
                 // Only change state if we select a new line, when we de-select there is no selection area to update
                 updateState = !mMapState.mCollisionItems[lineIdx]->IsSelected();
-                mUndoStack.Push<CommandSelectOrDeselectLine>(mMapState.mCollisionItems, mSelection, lineIdx, !mMapState.mCollisionItems[lineIdx]->IsSelected());
+
+                // Every toggle while Ctrl is held is one undo step
+                if (!mUndoStack.InGroup())
+                {
+                    mUndoStack.BeginGroup("Toggle line selection");
+                }
+                mUndoStack.PushMerge<CommandSelectOrDeselectLine>(true, mMapState.mCollisionItems, mSelection, lineIdx, !mMapState.mCollisionItems[lineIdx]->IsSelected());
                 if (!updateState)
                 {
                     mSelectionState = eSelectionState::eNone;
@@ -371,14 +525,16 @@ void EditorMode::Update(const InputState& input, CoordinateSpace& coords)
             else
             {
                 // If clicking on a line that is already selected then don't clear out any other lines that are already selected
-                if (mSelection.SelectedLines().find(lineIdx) == std::end(mSelection.SelectedLines()))
+                if (!mSelection.IsSelected(lineIdx))
                 {
                     LOG_INFO("Select single line");
+                    mUndoStack.BeginGroup("Select line " + std::to_string(lineIdx));
                     if (mSelection.HasSelection())
                     {
                         mUndoStack.Push<CommandClearSelection>(mMapState.mCollisionItems, mSelection);
                     }
                     mUndoStack.Push<CommandSelectOrDeselectLine>(mMapState.mCollisionItems, mSelection, lineIdx, true);
+                    mUndoStack.EndGroup();
                 }
                 else
                 {
@@ -419,11 +575,10 @@ void EditorMode::Update(const InputState& input, CoordinateSpace& coords)
         }
         else
         {
-            if (mSelection.HasSelection())
-            {
-                LOG_INFO("Nothing clicked, clear selected");
-                mUndoStack.Push<CommandClearSelection>(mMapState.mCollisionItems, mSelection);
-            }
+            // Nothing clicked, start a box selection. Releasing without dragging clears the selection.
+            mSelectionState = eSelectionState::eBoxSelect;
+            mBoxStart = mousePosWorld;
+            mBoxEnd = mousePosWorld;
         }
     }
     else if (input.mMouseButtons[0].IsDown() && mSelectionState != eSelectionState::eNone && mLastMousePos != mousePosWorld)
@@ -435,12 +590,18 @@ void EditorMode::Update(const InputState& input, CoordinateSpace& coords)
         case eSelectionState::eLineP2Selected:
             // TODO: Handle dis/connect to other lines when moving end points
             mUndoStack.PushMerge<CommandMoveLinePoint>(mMergeCommand, mMapState.mCollisionItems, mSelection, mousePosWorld, mSelectionState == eSelectionState::eLineP1Selected);
+            mLineIndex.Invalidate();
             break;
 
         case eSelectionState::eMoveSelected:
         case eSelectionState::eLineMiddleSelected:
             // TODO: Disconnect from other lines if moved away
             mUndoStack.PushMerge<MoveSelection>(mMergeCommand, mMapState.mCollisionItems, mSelection, mousePosWorld - mLastMousePos);
+            mLineIndex.Invalidate();
+            break;
+
+        case eSelectionState::eBoxSelect:
+            mBoxEnd = mousePosWorld;
             break;
 
         case eSelectionState::eNone:
@@ -452,34 +613,127 @@ void EditorMode::Update(const InputState& input, CoordinateSpace& coords)
     }
 }
 
+WorldRect EditorMode::SelectionBox() const
+{
+    return WorldRect{ glm::min(mBoxStart, mBoxEnd), glm::max(mBoxStart, mBoxEnd) };
+}
+
+void EditorMode::BoxSelect(const glm::vec2& mousePosWorld, bool addToSelection)
+{
+    mBoxEnd = mousePosWorld;
+    mLineIndex.Query(mMapState.mCollisionItems, SelectionBox(), mBoxLines);
+
+    if (mBoxLines.empty())
+    {
+        if (!addToSelection && mSelection.HasSelection())
+        {
+            LOG_INFO("Nothing selected, clear selected");
+            mUndoStack.Push<CommandClearSelection>(mMapState.mCollisionItems, mSelection);
+        }
+        return;
+    }
+
+    std::vector<s32> newSelection;
+    if (addToSelection)
+    {
+        newSelection = mSelection.SelectedLines();
+    }
+
+    for (s32 idx : mBoxLines)
+    {
+        if (!addToSelection || !mSelection.IsSelected(idx))
+        {
+            newSelection.push_back(idx);
+        }
+    }
+
+    if (newSelection != mSelection.SelectedLines())
+    {
+        LOG_INFO("Box selected " << mBoxLines.size() << " lines");
+        mUndoStack.Push<CommandSetSelection>(mMapState.mCollisionItems, mSelection, std::move(newSelection));
+    }
+}
+
 
 void EditorMode::Render(AbstractRenderer& rend) const
 {
     if (Debugging().mDrawCameras)
     {
-        // Draw every cam
-        for (auto x = 0u; x < mMapState.mScreens.size(); x++)
+        // Draw every cam in view, rendering a cam is what loads its textures so anything
+        // culled here is never loaded
+        const WorldRect view = mMapState.CullRect(rend);
+        const ScreenGrid::Range range = mMapState.mScreens.CellsOverlapping(view);
+
+        // When zoomed out far enough a thumbnail has as many pixels as the cam covers on screen
+        const glm::vec4 screenRect = rend.WorldToScreenRect(0.0f, 0.0f, mMapState.kVirtualScreenSize.x, mMapState.kVirtualScreenSize.y);
+        const u32 level = CameraThumbnails::LevelForScreenWidth(std::abs(screenRect.z));
+        const bool useThumbnails = level < CameraThumbnails::kLevelCount;
+
+        // Only visits the cells that have been loaded so far
+        u32 visible = 0;
+        mMapState.mScreens.ForEach(range, [&](u32 x, u32 y, GridScreen& screen)
         {
-            for (auto y = 0u; y < mMapState.mScreens[x].size(); y++)
+            if (!screen.hasTexture())
             {
-                // screen can be null while the array is being populated during loading
-                GridScreen* screen = mMapState.mScreens[x][y].get();
-                if (screen)
-                {
-                    if (!screen->hasTexture())
-                        continue;
+                return;
+            }
+
+            const WorldRect bounds = mMapState.mScreens.ImageBounds(x, y);
+            if (!view.Intersects(bounds))
+            {
+                return;
+            }
 
-                    screen->Render(rend, (x * mMapState.kCameraBlockSize.x) + mMapState.kCameraBlockImageOffset.x,
-                        (y * mMapState.kCameraBlockSize.y) + mMapState.kCameraBlockImageOffset.y,
+            if (useThumbnails)
+            {
+                // Drop the full size textures, they get streamed back in when zooming in again
+                screen.UnLoadTextures(rend);
+                if (mMapState.mThumbnails->IsReady())
+                {
+                    mMapState.mThumbnails->Render(rend, x, y, level, bounds.mMin.x, bounds.mMin.y,
                         mMapState.kVirtualScreenSize.x, mMapState.kVirtualScreenSize.y);
                 }
+                else
+                {
+                    rend.Rect(bounds.mMin.x, bounds.mMin.y,
+                        mMapState.kVirtualScreenSize.x, mMapState.kVirtualScreenSize.y,
+                        AbstractRenderer::eForegroundLayer0, ColourU8{ 64, 64, 64, 255 });
+                }
             }
-        }
+            else
+            {
+                screen.Render(rend, mLocator, bounds.mMin.x, bounds.mMin.y,
+                    mMapState.kVirtualScreenSize.x, mMapState.kVirtualScreenSize.y);
+            }
+            visible++;
+        });
+        Debugging().mCulling.mVisibleScreens += visible;
+        Debugging().mCulling.mCulledScreens += mMapState.mScreens.Count() - visible;
     }
     mMapState.RenderDebug(rend);
+
+    if (mSelectionState == eSelectionState::eBoxSelect)
+    {
+        const WorldRect box = SelectionBox();
+        const glm::vec2 topLeft = rend.WorldToScreen(box.mMin);
+        const glm::vec2 bottomRight = rend.WorldToScreen(box.mMax);
+
+        rend.Rect(topLeft.x, topLeft.y, bottomRight.x - topLeft.x, bottomRight.y - topLeft.y,
+            AbstractRenderer::eLayers::eEditor, ColourU8{ 255, 255, 255, 40 }, AbstractRenderer::eNormal, AbstractRenderer::eScreen);
+
+        rend.PathBegin();
+        rend.PathLineTo(topLeft.x, topLeft.y);
+        rend.PathLineTo(bottomRight.x, topLeft.y);
+        rend.PathLineTo(bottomRight.x, bottomRight.y);
+        rend.PathLineTo(topLeft.x, bottomRight.y);
+        rend.PathLineTo(topLeft.x, topLeft.y);
+        rend.PathStroke(ColourU8{ 255, 255, 255, 255 }, 1.0f, AbstractRenderer::eLayers::eEditor, AbstractRenderer::eNormal, AbstractRenderer::eScreen);
+    }
 }
 
 void EditorMode::OnMapChanged()
 {
     mUndoStack.Clear();
+    mSelection.Reset();
+    mLineIndex.Invalidate();
 }
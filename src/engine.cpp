@@ -17,6 +17,11 @@
 #include "rungamestate.hpp"
 #include "debug.hpp"
 #include "resourcemapper.hpp"
+#include "replay.hpp"
+#include "scriptprofiler.hpp"
+#include "scriptgc.hpp"
+#include "framepacer.hpp"
+#include <ctime>
 
 #ifdef _WIN32
 #ifndef NOMINMAX
@@ -202,9 +207,23 @@ void InputMapping::Update(const InputState& input)
 Engine::Engine(const std::vector<std::string>& commandLineArguments)
     : mAudioHandler(1024, 44100)
 {
-    for (const std::string& argument : commandLineArguments)
+    for (size_t i = 0; i < commandLineArguments.size(); i++)
     {
-        if (string_util::iequals("-opengl", argument))
+        const std::string& argument = commandLineArguments[i];
+        const bool hasValue = i + 1 < commandLineArguments.size();
+        if (string_util::iequals("-record", argument) && hasValue)
+        {
+            mRecordFileName = commandLineArguments[++i];
+        }
+        else if (string_util::iequals("-replay", argument) && hasValue)
+        {
+            mReplayFileName = commandLineArguments[++i];
+        }
+        else if (string_util::iequals("-profilescripts", argument))
+        {
+            mProfileScripts = true;
+        }
+        else if (string_util::iequals("-opengl", argument))
         {
             mTryDirectX9 = false;
         }
@@ -248,6 +267,17 @@ bool Engine::Init()
         return false;
     }
 
+    if (!mReplayFileName.empty())
+    {
+        mInputReplayer = std::make_unique<InputReplayer>(mFileSystem->Open(mReplayFileName));
+        Timings().SetEnabled(true);
+    }
+    else if (!mRecordFileName.empty())
+    {
+        mInputRecorder = std::make_unique<InputRecorder>(mFileSystem->Create(mRecordFileName));
+        Timings().SetEnabled(true);
+    }
+
     //InitResources();
 
     if (!InitSDL())
@@ -258,7 +288,35 @@ bool Engine::Init()
 
     InitSubSystems();
 
+    mScriptProfiler = std::make_unique<ScriptProfiler>(mSquirrelVm.Handle(), *mFileSystem);
+    if (mProfileScripts)
+    {
+        // Line events are only emitted for scripts compiled after this
+        sq_enabledebuginfo(mSquirrelVm.Handle(), SQTrue);
+        mScriptProfiler->SetEnabled(true);
+    }
+    Debugging().AddSection([&]()
+    {
+        mScriptProfiler->DebugUi();
+    });
+
+    mScriptGc = std::make_unique<ScriptGarbageCollector>(mSquirrelVm.Handle());
+    Debugging().AddSection([&]()
+    {
+        mScriptGc->DebugUi();
+    });
+
+    mFramePacer = std::make_unique<FramePacer>();
+    Debugging().AddSection([&]()
+    {
+        mFramePacer->DebugUi();
+    });
+
     Debugging().mInput = &mInputState;
+    mInputState.Events().Subscribe(InputEvent::eTypes::eKeyPressed, SDL_SCANCODE_F1, [](const InputEvent&)
+    {
+        Debugging().mShowDebugUi = !Debugging().mShowDebugUi;
+    });
 
     mState = EngineStates::eEngineInit;
 
@@ -395,29 +453,41 @@ static char* WindowTitle(const char* rendererName, f32 fps)
 int Engine::Run()
 {
     BasicFramesPerSecondCounter fpsCounter;
-    auto startTime = THighResClock::now();
+    THighResClock::duration renderTime = {};
 
     while (mState != EngineStates::eQuit)
     {
-        // Limit update to 60fps
-        const THighResClock::duration totalRunTime = THighResClock::now() - startTime;
-        const Sint64 timePassed = std::chrono::duration_cast<std::chrono::nanoseconds>(totalRunTime).count();
+        // Limit update to 60fps, replays run headless and as fast as possible
+        if (!mInputReplayer)
+        {
+            mFramePacer->WaitForNextFrame();
+        }
 
+        const auto updateStartTime = THighResClock::now();
+        Update();
+        ImGui::Render();
 
-        if (timePassed >= 16666666)
+        // Give script garbage collection whatever is left of the frame after updating and rendering
+        const f32 usedMs = std::chrono::duration<f32, std::milli>((THighResClock::now() - updateStartTime) + renderTime).count();
+        mScriptGc->Step(mFramePacer->FrameMs() - usedMs);
+
+        if (!mInputReplayer)
         {
-            Update();
-            ImGui::Render();
-            startTime = THighResClock::now();
+            const auto renderStartTime = THighResClock::now();
+            Render();
+            renderTime = THighResClock::now() - renderStartTime;
         }
-
-        Render();
         fpsCounter.Update([&](f32 fps)
         {
             SDL_SetWindowTitle(mWindow, WindowTitle(mRenderer->Name(), fps));
         });
     }
 
+    if (mInputRecorder)
+    {
+        LOG_INFO("Recorded " << mInputRecorder->TickCount() << " ticks\n" << Timings().Report());
+    }
+
     mRenderer->DestroyTexture(mGuiFontHandle);
 
     return 0;
@@ -703,6 +773,10 @@ void Engine::Update()
     mInputState.mMousePosition.mY = mouse_y;
 
     mInputState.Update();
+    if (!mInputReplayer)
+    {
+        mInputState.Events().Publish(mInputState);
+    }
 
     ImGui::NewFrame();
 
@@ -724,13 +798,32 @@ void Engine::Update()
         
         if (!mASyncJob)
         {
-            mState = mRunGameState->Update(mInputState, *mRenderer);
+            UpdateRunGameState();
         }
         break;
     case EngineStates::eGameSelection:
-        mState = mGameSelectionScreen->Update(mInputState, *mRenderer);
+        if (mInputReplayer)
+        {
+            // Skip the UI and start the same game the recording was made with
+            if (!mGameSelectionScreen->SelectGame(mInputReplayer->GameName()))
+            {
+                throw Oddlib::Exception("Game " + mInputReplayer->GameName() + " used by the recording was not found");
+            }
+
+            mState = mGameSelectionScreen->StartSelectedGame();
+            if (mState != EngineStates::eRunGameState)
+            {
+                throw Oddlib::Exception("Game " + mInputReplayer->GameName() + " used by the recording is missing data sets");
+            }
+        }
+        else
+        {
+            mState = mGameSelectionScreen->Update(mInputState, *mRenderer);
+        }
+
         if (mState == EngineStates::eRunGameState)
         {
+            SeedGame();
             mRunGameState->OnStartASync(mGameSelectionScreen->SelectedGame().GameScriptName(), mSound.get());
         }
         break;
@@ -758,7 +851,7 @@ void Engine::Update()
 
                     mSound = std::make_unique<Sound>(mAudioHandler, *mResourceLocator, *mFileSystem);
 
-                    mRunGameState = std::make_unique<RunGameState>(*mResourceLocator, *mRenderer);
+                    mRunGameState = std::make_unique<RunGameState>(*mResourceLocator, *mRenderer, *mFileSystem);
                     mGameSelectionScreen = std::make_unique<GameSelectionState>(mGameDefinitions, *mResourceLocator, *mFileSystem);
                     mPlayFmvState = std::make_unique<PlayFmvState>(mAudioHandler, *mResourceLocator);
 
@@ -774,6 +867,69 @@ void Engine::Update()
     mGlobalFrameCounter++;
 }
 
+void Engine::SeedGame()
+{
+    // Scripts and sound effects use rand(), so a replay must start from the seed the recording did
+    const u32 seed = mInputReplayer ? mInputReplayer->Seed() : static_cast<u32>(time(nullptr));
+    srand(seed);
+
+    if (mInputRecorder)
+    {
+        mInputRecorder->Start(mGameSelectionScreen->SelectedGame().Name(), seed);
+    }
+}
+
+void Engine::UpdateRunGameState()
+{
+    // Only ticks where the game is simulating are recorded, the number of ticks taken
+    // to load something depends on the wall clock.
+    const bool isSimulationTick = !mRunGameState->IsLoading();
+
+    if (isSimulationTick && mInputReplayer)
+    {
+        if (!mInputReplayer->ApplyNextTick(mInputState))
+        {
+            OnReplayFinished();
+            return;
+        }
+        mInputState.Events().Publish(mInputState);
+    }
+
+    {
+        ScopedSubsystemTimer timer(SubsystemTimings::eTick);
+        mState = mRunGameState->Update(mInputState, *mRenderer);
+    }
+
+    if (isSimulationTick && Timings().Enabled())
+    {
+        const u32 stateHash = mRunGameState->StateHashValue();
+        if (mInputRecorder)
+        {
+            mInputRecorder->RecordTick(mInputState, stateHash);
+        }
+        else if (mInputReplayer)
+        {
+            mInputReplayer->CheckTick(stateHash);
+        }
+        Timings().EndTick();
+    }
+}
+
+void Engine::OnReplayFinished()
+{
+    std::stringstream report;
+    report << "Replay of " << mReplayFileName << "\n";
+    report << "Mismatched ticks: " << mInputReplayer->MismatchedTickCount() << " of " << mInputReplayer->TickCount() << "\n";
+    report << Timings().Report();
+
+    LOG_INFO(report.str());
+
+    std::unique_ptr<Oddlib::IStream> reportStream = mFileSystem->Create(mReplayFileName + ".benchmark.txt");
+    reportStream->Write(report.str());
+
+    mState = EngineStates::eQuit;
+}
+
 void Engine::Render()
 {
     int w = 0;
@@ -894,68 +1050,156 @@ bool Engine::InitSDL()
     return true;
 }
 
-void Engine::AddGameDefinitionsFrom(const char* path)
+void Engine::AddGameDefinitionsFrom(GameDefinitionSources& sources, const char* path)
 {
     const auto jsonFiles = mFileSystem->EnumerateFiles(path, "*.json");
     for (const auto& gameDef : jsonFiles)
     {
-        mGameDefinitions.emplace_back(*mFileSystem, (std::string(path) + "/" + gameDef).c_str(), false);
+        sources.push_back({ GameDefinitionSource::eTypes::eDefinition, std::string(path) + "/" + gameDef, "" });
     }
 }
 
-void Engine::AddModDefinitionsFrom(const char* path)
+void Engine::AddModDefinitionsFrom(GameDefinitionSources& sources, const char* path)
 {
     std::string strPath(path);
-    AddDirectoryBasedModDefinitionsFrom(strPath);
-    AddZipedModDefinitionsFrom(strPath);
+    AddDirectoryBasedModDefinitionsFrom(sources, strPath);
+    AddZipedModDefinitionsFrom(sources, strPath);
 }
 
-void Engine::AddDirectoryBasedModDefinitionsFrom(std::string path)
+void Engine::AddDirectoryBasedModDefinitionsFrom(GameDefinitionSources& sources, std::string path)
 {
     const auto possibleModDirs = mFileSystem->EnumerateFolders(path);
     for (const auto& possibleModDir : possibleModDirs)
     {
-        auto modDefinitionFiles = mFileSystem->EnumerateFiles(path + "/" + possibleModDir, "game.json");
+        const std::string modPath = path + "/" + possibleModDir;
+        auto modDefinitionFiles = mFileSystem->EnumerateFiles(modPath, "game.json");
         if (!modDefinitionFiles.empty())
         {
-            auto fs = IFileSystem::Factory(*mFileSystem, path + "/" + possibleModDir + "/");
-            if (fs)
-            {
-                mGameDefinitions.emplace_back(*fs, modDefinitionFiles[0].c_str(), true);
-            }
+            sources.push_back({ GameDefinitionSource::eTypes::eModDirectory, modPath + "/" + modDefinitionFiles[0], modPath + "/" });
         }
     }
 }
 
-void Engine::AddZipedModDefinitionsFrom(std::string path)
+void Engine::AddZipedModDefinitionsFrom(GameDefinitionSources& sources, std::string path)
 {
+    // Whether a zip is a mod is only known once it is opened, which happens with the parsing
     const auto possibleModZips = mFileSystem->EnumerateFiles(path, "*.zip");
     for (const auto& possibleModZip : possibleModZips)
     {
-        auto fs = IFileSystem::Factory(*mFileSystem, path + "/" + possibleModZip);
-        if (fs)
+        sources.push_back({ GameDefinitionSource::eTypes::eModZip, path + "/" + possibleModZip, "" });
+    }
+}
+
+/*static*/ void Engine::ParseGameDefinition(IFileSystem& fs, const GameDefinitionSource& source, GameDefinitionCache::Entry& entry)
+{
+    switch (source.mType)
+    {
+    case GameDefinitionSource::eTypes::eDefinition:
+        entry.mDefinition = GameDefinition(fs, source.mPath.c_str(), false);
+        entry.mHasDefinition = true;
+        break;
+
+    case GameDefinitionSource::eTypes::eModDirectory:
+    {
+        auto modFs = IFileSystem::Factory(fs, source.mModPath);
+        if (modFs)
         {
-            auto modDefinitionFiles = fs->EnumerateFiles("", "game.json");
+            entry.mDefinition = GameDefinition(*modFs, source.mPath.substr(source.mModPath.length()).c_str(), true);
+            entry.mHasDefinition = true;
+        }
+    }
+    break;
+
+    case GameDefinitionSource::eTypes::eModZip:
+    {
+        auto modFs = IFileSystem::Factory(fs, source.mPath);
+        if (modFs)
+        {
+            auto modDefinitionFiles = modFs->EnumerateFiles("", "game.json");
             if (!modDefinitionFiles.empty())
             {
-                mGameDefinitions.emplace_back(*fs, modDefinitionFiles[0].c_str(), true);
+                entry.mDefinition = GameDefinition(*modFs, modDefinitionFiles[0].c_str(), true);
+                entry.mHasDefinition = true;
             }
         }
     }
+    break;
+    }
+}
+
+void Engine::LoadGameDefinitions(const GameDefinitionSources& sources)
+{
+    const char* kCacheFileName = "{CacheDir}/GameDefinitions.bin";
+
+    GameDefinitionCache cache;
+    cache.Load(*mFileSystem, kCacheFileName);
+
+    // Sources that are missing from the cache or have changed since are opened and parsed at the
+    // same time, the results keep the order of the sources so the game list doesn't depend on timing
+    std::vector<GameDefinitionCache::Entry> entries(sources.size());
+    std::vector<std::future<void>> parsing;
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        GameDefinitionCache::Entry& entry = entries[i];
+        // Keyed by the expanded path so moving the game or user directory doesn't reuse stale records
+        entry.mPath = mFileSystem->ExpandPath(sources[i].mPath);
+        mFileSystem->FileStamp(entry.mPath, entry.mSize, entry.mModifiedTime);
+
+        const GameDefinitionCache::Entry* cached = cache.Find(entry.mPath, entry.mSize, entry.mModifiedTime);
+        if (cached)
+        {
+            entry = *cached;
+        }
+        else
+        {
+            IFileSystem& fs = *mFileSystem;
+            const GameDefinitionSource& source = sources[i];
+            parsing.emplace_back(std::async(std::launch::async, [&fs, &source, &entry]()
+            {
+                ParseGameDefinition(fs, source, entry);
+            }));
+        }
+    }
+
+    for (auto& future : parsing)
+    {
+        future.get();
+    }
+
+    LOG_INFO(sources.size() - parsing.size() << " game definitions from cache, " << parsing.size() << " parsed");
+
+    for (const GameDefinitionCache::Entry& entry : entries)
+    {
+        if (entry.mHasDefinition)
+        {
+            mGameDefinitions.emplace_back(entry.mDefinition);
+        }
+    }
+
+    // Also rewritten when a source has gone so that the cache doesn't keep growing
+    if (!parsing.empty() || cache.mEntries.size() != entries.size())
+    {
+        cache.mEntries = std::move(entries);
+        cache.Save(*mFileSystem, kCacheFileName);
+    }
 }
 
 void Engine::InitResources()
 {
     TRACE_ENTRYEXIT;
 
+    GameDefinitionSources sources;
+
     // load the enumerated "built in" game defs
-    AddGameDefinitionsFrom("{GameDir}/data/GameDefinitions");
+    AddGameDefinitionsFrom(sources, "{GameDir}/data/GameDefinitions");
 
     // load the enumerated "mod" game defs
-    AddModDefinitionsFrom("{UserDir}/Mods");
+    AddModDefinitionsFrom(sources, "{UserDir}/Mods");
 
     // The engine probably won't ship with any mods, but while under development look here too
-    AddModDefinitionsFrom("{GameDir}/data/Mods");
+    AddModDefinitionsFrom(sources, "{GameDir}/data/Mods");
+
+    LoadGameDefinitions(sources);
 
     // create the resource mapper loading the resource maps from the json db
     DataPaths dataPaths(*mFileSystem,
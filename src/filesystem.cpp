@@ -293,6 +293,39 @@ void OSBaseFileSystem::RenameFile(const std::string& source, const std::string&
 #endif
 }
 
+#ifdef _WIN32
+bool OSBaseFileSystem::FileStamp(const std::string& fileName, u64& size, u64& modifiedTime)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!::GetFileAttributesExW(Utf8ToUtf16(ExpandPath(fileName)).c_str(), GetFileExInfoStandard, &data))
+    {
+        return false;
+    }
+    size = (static_cast<u64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    modifiedTime = (static_cast<u64>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+#else
+bool OSBaseFileSystem::FileStamp(const std::string& fileName, u64& size, u64& modifiedTime)
+{
+    struct stat statbuf;
+    if (stat(ExpandPath(fileName).c_str(), &statbuf) != 0)
+    {
+        return false;
+    }
+    size = static_cast<u64>(statbuf.st_size);
+
+    // In nanoseconds, whole seconds miss a file that is rewritten straight after it was read
+#ifdef __APPLE__
+    const timespec& mtime = statbuf.st_mtimespec;
+#else
+    const timespec& mtime = statbuf.st_mtim;
+#endif
+    modifiedTime = static_cast<u64>(mtime.tv_sec) * 1000000000ull + static_cast<u64>(mtime.tv_nsec);
+    return true;
+}
+#endif
+
 #ifdef _WIN32
 bool OSBaseFileSystem::FileExists(std::string& fileName)
 {
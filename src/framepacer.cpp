@@ -0,0 +1,152 @@
+#include "framepacer.hpp"
+#include "SDL.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+#include <chrono>
+#include "stdthread.h"
+
+namespace
+{
+    class SdlFrameClock : public IFrameClock
+    {
+    public:
+        u64 Frequency() const override { return SDL_GetPerformanceFrequency(); }
+        u64 Now() const override { return SDL_GetPerformanceCounter(); }
+
+        void SleepUs(f32 us) override
+        {
+            // On Windows this relies on SDL having raised the timer resolution to 1ms
+            std::this_thread::sleep_for(std::chrono::duration<f32, std::micro>(us));
+        }
+    };
+}
+
+static IFrameClock& DefaultClock()
+{
+    // Stateless so one is shared by every pacer
+    static SdlFrameClock clock;
+    return clock;
+}
+
+FramePacer::FramePacer(u32 framesPerSecond)
+    : FramePacer(DefaultClock(), framesPerSecond)
+{
+
+}
+
+FramePacer::FramePacer(IFrameClock& clock, u32 framesPerSecond)
+    : mClock(clock)
+{
+    mFrequency = mClock.Frequency();
+    mPeriodTicks = mFrequency / framesPerSecond;
+    mSpinMarginTicks = (mFrequency * kInitialSpinMarginUs) / 1000000;
+    mMinSpinMarginTicks = (mFrequency * kMinSpinMarginUs) / 1000000;
+}
+
+void FramePacer::WaitForNextFrame()
+{
+    u64 now = mClock.Now();
+    if (mNextFrame == 0)
+    {
+        // The first frame is due straight away
+        mNextFrame = now;
+        mWindowStart = now;
+    }
+
+    if (mSleepEnabled && mNextFrame > now + mSpinMarginTicks)
+    {
+        const u64 wakeAt = mNextFrame - mSpinMarginTicks;
+        mClock.SleepUs(TicksToUs(wakeAt - now));
+
+        const u64 woke = mClock.Now();
+        mWindowSleptTicks += woke - now;
+        AdaptSpinMargin(woke > wakeAt ? woke - wakeAt : 0);
+        now = woke;
+    }
+
+    while (now < mNextFrame)
+    {
+        now = mClock.Now();
+    }
+
+    EndFrame(now);
+}
+
+void FramePacer::AdaptSpinMargin(u64 oversleepTicks)
+{
+    // Grow straight away so that the next frame isn't late as well, shrink slowly back toward the
+    // usual oversleep so that one bad sleep doesn't turn the rest of the run in to a spin
+    if (oversleepTicks > mSpinMarginTicks)
+    {
+        mSpinMarginTicks = std::min(oversleepTicks + (oversleepTicks / 4), mPeriodTicks);
+    }
+    else
+    {
+        mSpinMarginTicks = std::max(mSpinMarginTicks - ((mSpinMarginTicks - oversleepTicks) / 16), mMinSpinMarginTicks);
+    }
+}
+
+void FramePacer::EndFrame(u64 now)
+{
+    const u64 error = now - mNextFrame;
+    mWindowErrorTicks += error;
+    mWindowMaxErrorTicks = std::max(mWindowMaxErrorTicks, error);
+    mWindowFrames++;
+
+    if (error >= mPeriodTicks)
+    {
+        mWindowDroppedFrames += static_cast<u32>(error / mPeriodTicks);
+        mNextFrame = now + mPeriodTicks;
+    }
+    else
+    {
+        mNextFrame += mPeriodTicks;
+    }
+
+    const u64 windowTicks = now - mWindowStart;
+    if (windowTicks >= mFrequency)
+    {
+        mStats.mCpuUsage = 1.0f - static_cast<f32>(static_cast<f64>(mWindowSleptTicks) / static_cast<f64>(windowTicks));
+        mStats.mAverageErrorUs = TicksToUs(mWindowErrorTicks) / mWindowFrames;
+        mStats.mMaxErrorUs = TicksToUs(mWindowMaxErrorTicks);
+        mStats.mFrames = mWindowFrames;
+        mStats.mDroppedFrames = mWindowDroppedFrames;
+
+        mWindowStart = now;
+        mWindowSleptTicks = 0;
+        mWindowErrorTicks = 0;
+        mWindowMaxErrorTicks = 0;
+        mWindowFrames = 0;
+        mWindowDroppedFrames = 0;
+    }
+}
+
+f32 FramePacer::FrameMs() const
+{
+    return TicksToUs(mPeriodTicks) / 1000.0f;
+}
+
+f32 FramePacer::MsUntilNextFrame() const
+{
+    const u64 now = mClock.Now();
+    return now < mNextFrame ? TicksToUs(mNextFrame - now) / 1000.0f : 0.0f;
+}
+
+f32 FramePacer::TicksToUs(u64 ticks) const
+{
+    return static_cast<f32>((static_cast<f64>(ticks) * 1000000.0) / static_cast<f64>(mFrequency));
+}
+
+void FramePacer::DebugUi()
+{
+    if (!ImGui::CollapsingHeader("Frame pacing"))
+    {
+        return;
+    }
+
+    ImGui::Checkbox("Sleep between frames", &mSleepEnabled);
+    ImGui::Text("CPU usage: %.1f%%", mStats.mCpuUsage * 100.0f);
+    ImGui::Text("Frames: %u (%u dropped)", mStats.mFrames, mStats.mDroppedFrames);
+    ImGui::Text("Late by: %.1f us average %.1f us max", mStats.mAverageErrorUs, mStats.mMaxErrorUs);
+    ImGui::Text("Spin margin: %.1f us", SpinMarginUs());
+}
@@ -35,6 +35,22 @@ void FsmStateTransition::AddCondition(StateCondition condition)
     mConditions.push_back(condition);
 }
 
+bool FsmStateTransition::Compile(const TConditions& conditions, s32 targetState)
+{
+    mTargetState = targetState;
+
+    bool ok = true;
+    for (StateCondition& condition : mConditions)
+    {
+        if (!condition.Compile(conditions))
+        {
+            LOG_ERROR("Missing condition: " << condition.Name() << " in transition to " << mTargetStateName);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
 bool FsmStateTransition::Evaulate(TConditions& events)
 {
     // Nothing to check, just move to next state
@@ -45,7 +61,8 @@ bool FsmStateTransition::Evaulate(TConditions& events)
 
     for (StateCondition& event : mConditions)
     {
-        if (!event.Execute(events))
+        // A condition that didn't compile fails whether it is negated or not
+        if (!event.Resolved() || event.Execute(events) == event.Negated())
         {
             // An event isn't true so can't go to next state yet
             return false;
@@ -58,53 +75,113 @@ bool FsmStateTransition::Evaulate(TConditions& events)
 
 // =========================================================================
 
+bool FsmState::Compile(const TActions& actions, const TConditions& conditions, const std::map<std::string, s32>& stateIds)
+{
+    bool ok = true;
+    for (StateAction& action : mEnterActions)
+    {
+        if (!action.Compile(actions))
+        {
+            LOG_ERROR("Missing action: " << action.Name() << " in state " << mStateName);
+            ok = false;
+        }
+    }
+
+    for (FsmStateTransition& trans : mTransistions)
+    {
+        const auto it = stateIds.find(trans.Name());
+        if (it == std::end(stateIds))
+        {
+            LOG_ERROR("State: " << trans.Name() << " not found, from state " << mStateName);
+            ok = false;
+        }
+
+        // A transition to a missing state stays compiled as kNoFsmState and so is never taken
+        if (!trans.Compile(conditions, it != std::end(stateIds) ? it->second : kNoFsmState))
+        {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
 void FsmState::Enter(TActions& actions)
 {
-    LOG_INFO(mStateName.c_str());
     for (StateAction& action : mEnterActions)
     {
         action.Execute(actions);
     }
 }
 
-const std::string* FsmState::Update(TConditions& states)
+s32 FsmState::Update(TConditions& states)
 {
     // TODO: Need "Running" actions - for playing sound effects
     // per anim frame?
 
     for (FsmStateTransition& trans : mTransistions)
     {
-        if (trans.Evaulate(states))
+        if (trans.TargetState() != kNoFsmState && trans.Evaulate(states))
         {
-            return &trans.Name();
+            return trans.TargetState();
         }
     }
-    return nullptr;
+    return kNoFsmState;
 }
 
 // =========================================================================
 
+bool FiniteStateMachine::Compile()
+{
+    std::map<std::string, s32> stateIds;
+    for (size_t i = 0; i < mStates.size(); i++)
+    {
+        stateIds[mStates[i].Name()] = static_cast<s32>(i);
+    }
+
+    bool ok = true;
+    for (FsmState& state : mStates)
+    {
+        if (!state.Compile(mActions, mConditions, stateIds))
+        {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
 void FiniteStateMachine::Update()
 {
-    if (mActiveState)
+    if (mActiveState != kNoFsmState)
     {
-        const std::string* nextState = mActiveState->Update(mConditions);
-        if (nextState)
+        const s32 nextState = mStates[mActiveState].Update(mConditions);
+        if (nextState != kNoFsmState)
         {
-            ToState(nextState->c_str());
+            ToState(nextState);
         }
     }
 }
 
+bool FiniteStateMachine::ToState(s32 stateId)
+{
+    if (stateId < 0 || stateId >= static_cast<s32>(mStates.size()))
+    {
+        LOG_ERROR("State id: " << stateId << " not found");
+        return false;
+    }
+
+    mActiveState = stateId;
+    mStates[mActiveState].Enter(mActions);
+    return true;
+}
+
 bool FiniteStateMachine::ToState(const char* stateName)
 {
-    for (FsmState& state : mStates)
+    for (size_t i = 0; i < mStates.size(); i++)
     {
-        if (state.Name() == stateName)
+        if (mStates[i].Name() == stateName)
         {
-            mActiveState = &state;
-            mActiveState->Enter(mActions);
-            return true;
+            LOG_INFO(stateName);
+            return ToState(static_cast<s32>(i));
         }
     }
 
@@ -195,5 +272,6 @@ void FiniteStateMachine::Construct()
         mStates.push_back(state);
     }
 
+    Compile();
     ToState("Idle");
 }
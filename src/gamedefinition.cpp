@@ -1,5 +1,27 @@
 #include "gamedefinition.hpp"
 #include <jsonxx/jsonxx.h>
+#include "oddlib/exceptions.hpp"
+
+static const u32 kCacheMagic = 0x46454447; // "GDEF"
+static const u32 kCacheVersion = 2;
+
+static void WriteString(Oddlib::IStream& stream, const std::string& str)
+{
+    stream.Write(static_cast<u32>(str.size()));
+    stream.Write(str);
+}
+
+static void ReadString(Oddlib::IStream& stream, std::string& str)
+{
+    u32 length = 0;
+    stream.Read(length);
+    if (length > stream.Size() - stream.Pos())
+    {
+        throw Oddlib::Exception("String length is past the end of " + stream.Name());
+    }
+    str.resize(length);
+    stream.Read(str);
+}
 
 DataSetIdentifiers::DataSetIdentifiers(IFileSystem& fs, const char* dataSetsIdsFileName)
 {
@@ -154,3 +176,123 @@ void GameDefinition::Parse(const std::string& json)
         }
     }
 }
+
+void GameDefinition::Write(Oddlib::IStream& stream) const
+{
+    WriteString(stream, mName);
+    WriteString(stream, mDescription);
+    WriteString(stream, mAuthor);
+    WriteString(stream, mGameScript);
+    WriteString(stream, mDataSetName);
+    stream.Write(static_cast<u8>(mHidden ? 1 : 0));
+    stream.Write(static_cast<u32>(mRequiredDataSets.size()));
+    for (const std::string& dataSet : mRequiredDataSets)
+    {
+        WriteString(stream, dataSet);
+    }
+    stream.Write(static_cast<u8>(mIsMod ? 1 : 0));
+    WriteString(stream, mContainingArchive);
+}
+
+void GameDefinition::Read(Oddlib::IStream& stream)
+{
+    ReadString(stream, mName);
+    ReadString(stream, mDescription);
+    ReadString(stream, mAuthor);
+    ReadString(stream, mGameScript);
+    ReadString(stream, mDataSetName);
+    mHidden = Oddlib::ReadU8(stream) != 0;
+    const u32 requiredCount = Oddlib::ReadU32(stream);
+    mRequiredDataSets.clear();
+    for (u32 i = 0; i < requiredCount; i++)
+    {
+        std::string dataSet;
+        ReadString(stream, dataSet);
+        mRequiredDataSets.emplace_back(std::move(dataSet));
+    }
+    mIsMod = Oddlib::ReadU8(stream) != 0;
+    ReadString(stream, mContainingArchive);
+}
+
+bool GameDefinitionCache::Load(IFileSystem& fs, const std::string& fileName)
+{
+    mEntries.clear();
+
+    std::string fileNameCopy = fileName;
+    if (!fs.FileExists(fileNameCopy))
+    {
+        return false;
+    }
+
+    try
+    {
+        auto stream = fs.Open(fileNameCopy);
+        const u32 magic = Oddlib::ReadU32(*stream);
+        const u32 version = Oddlib::ReadU32(*stream);
+        if (magic != kCacheMagic || version != kCacheVersion)
+        {
+            LOG_WARNING("Ignoring out of date game definition cache " << fileName);
+            return false;
+        }
+
+        const u32 count = Oddlib::ReadU32(*stream);
+        for (u32 i = 0; i < count; i++)
+        {
+            Entry entry;
+            ReadString(*stream, entry.mPath);
+            stream->Read(entry.mSize);
+            stream->Read(entry.mModifiedTime);
+            entry.mHasDefinition = Oddlib::ReadU8(*stream) != 0;
+            if (entry.mHasDefinition)
+            {
+                entry.mDefinition.Read(*stream);
+            }
+            mEntries.emplace_back(std::move(entry));
+        }
+    }
+    catch (const Oddlib::Exception& ex)
+    {
+        LOG_WARNING("Failed to read game definition cache " << fileName << ": " << ex.what());
+        mEntries.clear();
+        return false;
+    }
+    return true;
+}
+
+void GameDefinitionCache::Save(IFileSystem& fs, const std::string& fileName) const
+{
+    try
+    {
+        auto stream = fs.Create(fileName);
+        stream->Write(kCacheMagic);
+        stream->Write(kCacheVersion);
+        stream->Write(static_cast<u32>(mEntries.size()));
+        for (const Entry& entry : mEntries)
+        {
+            WriteString(*stream, entry.mPath);
+            stream->Write(entry.mSize);
+            stream->Write(entry.mModifiedTime);
+            stream->Write(static_cast<u8>(entry.mHasDefinition ? 1 : 0));
+            if (entry.mHasDefinition)
+            {
+                entry.mDefinition.Write(*stream);
+            }
+        }
+    }
+    catch (const Oddlib::Exception& ex)
+    {
+        LOG_WARNING("Failed to write game definition cache " << fileName << ": " << ex.what());
+    }
+}
+
+const GameDefinitionCache::Entry* GameDefinitionCache::Find(const std::string& path, u64 size, u64 modifiedTime) const
+{
+    for (const Entry& entry : mEntries)
+    {
+        if (entry.mPath == path)
+        {
+            return (entry.mSize == size && entry.mModifiedTime == modifiedTime) ? &entry : nullptr;
+        }
+    }
+    return nullptr;
+}
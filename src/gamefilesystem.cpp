@@ -20,18 +20,95 @@
 
 #include "string_util.hpp"
 #include "logger.hpp"
+#include <algorithm>
+
+void NamedPaths::Add(const std::string& name, const std::string& path)
+{
+    // Not normalized here as Expand normalizes whatever it copies
+    mLongestPath = std::max(mLongestPath, path.size());
+    mEntries.push_back(Entry{ name, path });
+}
+
+const std::string* NamedPaths::Find(const std::string& name) const
+{
+    for (const Entry& entry : mEntries)
+    {
+        if (entry.mName == name)
+        {
+            return &entry.mPath;
+        }
+    }
+    return nullptr;
+}
+
+// Back slashes become forward slashes and a run of slashes becomes one
+static void AppendNormalized(std::string& out, char c)
+{
+    if (c == '\\')
+    {
+        c = '/';
+    }
+
+    if (c == '/' && !out.empty() && out.back() == '/')
+    {
+        return;
+    }
+    out.push_back(c);
+}
+
+void NamedPaths::Expand(const std::string& path, std::string& out) const
+{
+    out.clear();
+    out.reserve(path.size() + mLongestPath);
+
+    const size_t length = path.size();
+    size_t pos = 0;
+    while (pos < length)
+    {
+        // Named directories all start with a brace so only those positions are compared
+        const Entry* matched = nullptr;
+        if (path[pos] == '{')
+        {
+            for (const Entry& entry : mEntries)
+            {
+                if (path.compare(pos, entry.mName.size(), entry.mName) == 0)
+                {
+                    matched = &entry;
+                    break;
+                }
+            }
+        }
+
+        if (matched)
+        {
+            for (char c : matched->mPath)
+            {
+                AppendNormalized(out, c);
+            }
+            pos += matched->mName.size();
+        }
+        else
+        {
+            AppendNormalized(out, path[pos]);
+            pos++;
+        }
+    }
+}
 
 bool GameFileSystem::Init()
 {
     std::unique_lock<std::recursive_mutex> lock(mMutex);
 
+    // Built up separately and only stored once complete, after this the table is read only
+    NamedPaths namedPaths;
+
     auto basePath = InitBasePath();
     if (basePath.empty())
     {
         LOG_ERROR("Failed to resolve {GameDir}");
         return false;
     }
-    mNamedPaths["{GameDir}"] = basePath;
+    namedPaths.Add("{GameDir}", basePath);
 
     auto userPath = InitUserPath();
     if (userPath.empty())
@@ -39,7 +116,7 @@ bool GameFileSystem::Init()
         LOG_ERROR("Failed to resolve {UserDir}");
         return false;
     }
-    mNamedPaths["{UserDir}"] = userPath;
+    namedPaths.Add("{UserDir}", userPath);
 
     auto cachePath = InitCachePath();
     if (cachePath.empty())
@@ -47,15 +124,15 @@ bool GameFileSystem::Init()
         LOG_ERROR("Failed to resolve {CacheDir}");
         return false;
     }
-    mNamedPaths["{CacheDir}"] = cachePath;
+    namedPaths.Add("{CacheDir}", cachePath);
 
+    mNamedPaths = std::move(namedPaths);
     return true;
 }
 
 std::string GameFileSystem::FsPath() const
 {
-    std::unique_lock<std::recursive_mutex> lock(mMutex);
-    return mNamedPaths.find("{GameDir}")->second;
+    return *mNamedPaths.Find("{GameDir}");
 }
 #ifdef _WIN32
 static std::string W32CreateDirectory(const wchar_t* dirName)
@@ -164,12 +241,8 @@ std::string GameFileSystem::InitBasePath()
 
 std::string GameFileSystem::ExpandPath(const std::string& path)
 {
-    std::unique_lock<std::recursive_mutex> lock(mMutex);
-    std::string ret = path;
-    for (const auto& namedPath : mNamedPaths)
-    {
-        string_util::replace_all(ret, namedPath.first, namedPath.second);
-    }
-    NormalizePath(ret);
+    // No lock needed as the named paths don't change after Init
+    std::string ret;
+    mNamedPaths.Expand(path, ret);
     return ret;
 }
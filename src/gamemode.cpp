@@ -1,9 +1,10 @@
 #include "gamemode.hpp"
 #include "engine.hpp"
 #include "debug.hpp"
+#include "replay.hpp"
 
-GameMode::GameMode(GridMapState& mapState)
-    : mMapState(mapState)
+GameMode::GameMode(GridMapState& mapState, ResourceLocator& locator)
+    : mMapState(mapState), mLocator(locator)
 {
 
 }
@@ -30,7 +31,7 @@ void GameMode::Update(const InputState& input, CoordinateSpace& coords)
         mMapState.mState = GridMapState::eStates::eToEditor;
         coords.mSmoothCameraPosition = true;
 
-        mMapState.mModeSwitchTimeout = SDL_GetTicks() + kSwitchTimeMs;
+        mMapState.mModeSwitchTimeout = mMapState.mTickCounter + kSwitchTimeTicks;
 
         //mCameraPosition.x = mPlayer.mXPos;
         //mCameraPosition.y = mPlayer.mYPos;
@@ -39,20 +40,37 @@ void GameMode::Update(const InputState& input, CoordinateSpace& coords)
     coords.SetScreenSize(mMapState.kVirtualScreenSize);
 
 
-    for (auto& obj : mMapState.mObjs)
     {
-        obj->Update(input);
+        ScopedSubsystemTimer timer(SubsystemTimings::eMapObjects);
+        if (Debugging().mSleepDistantObjects)
+        {
+            mMapState.mActivation.Update(mMapState.mObjectStore, mMapState.mCameraSubject, mMapState.kCameraBlockSize);
+        }
+        else
+        {
+            mMapState.mActivation.WakeAll(mMapState.mObjectStore);
+        }
+
+        for (auto& obj : mMapState.mObjs)
+        {
+            if (mMapState.mActivation.IsAwake(obj->Handle()))
+            {
+                obj->Update(input);
+            }
+            else if (ActivationRegions::WantsSleepTick(obj->Handle(), mMapState.mTickCounter))
+            {
+                obj->SleepUpdate();
+            }
+        }
+        Debugging().mActivation = mMapState.mActivation.GetStats();
     }
 
 
     if (mMapState.mCameraSubject)
     {
-        const s32 camX = static_cast<s32>(mMapState.mCameraSubject->mXPos / mMapState.kCameraBlockSize.x);
-        const s32 camY = static_cast<s32>(mMapState.mCameraSubject->mYPos / mMapState.kCameraBlockSize.y);
-
-        const glm::vec2 camPos = glm::vec2(
-            (camX * mMapState.kCameraBlockSize.x) + mMapState.kCameraBlockImageOffset.x,
-            (camY * mMapState.kCameraBlockSize.y) + mMapState.kCameraBlockImageOffset.y) + glm::vec2(mMapState.kVirtualScreenSize.x / 2, mMapState.kVirtualScreenSize.y / 2);
+        // Centre of the subject's camera image, stays on the edge cameras if the subject leaves the path
+        const ScreenGrid::Cell cam = mMapState.mScreens.CellAt(glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos()));
+        const glm::vec2 camPos = mMapState.mScreens.ImageBounds(cam.mX, cam.mY).mMin + (mMapState.kVirtualScreenSize / 2.0f);
 
         if (mMapState.mCameraPosition != camPos)
         {
@@ -70,26 +88,21 @@ void GameMode::Render(AbstractRenderer& rend) const
 {
     if (mMapState.mCameraSubject && Debugging().mDrawCameras)
     {
-        const s32 camX = static_cast<s32>(mMapState.mCameraSubject->mXPos / mMapState.kCameraBlockSize.x);
-        const s32 camY = static_cast<s32>(mMapState.mCameraSubject->mYPos / mMapState.kCameraBlockSize.y);
-
-
-        // Culling is disabled until proper camera position updating order is fixed
-        // ^ not sure what this means, but rendering things at negative cam index seems to go wrong
-        if (camX >= 0 && camY >= 0 &&
-            camX < static_cast<s32>(mMapState.mScreens.size()) &&
-            camY < static_cast<s32>(mMapState.mScreens[camX].size()))
+        // Only the subject's cam is ever drawn in game, nothing is drawn once it leaves the path
+        ScreenGrid::Cell cam;
+        if (mMapState.mScreens.CellContaining(glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos()), cam))
         {
-            GridScreen* screen = mMapState.mScreens[camX][camY].get();
-            if (screen)
+            GridScreen* screen = mMapState.mScreens.At(cam);
+            if (screen && screen->hasTexture())
             {
-                if (screen->hasTexture())
-                {
-                    screen->Render(rend,
-                        (camX * mMapState.kCameraBlockSize.x) + mMapState.kCameraBlockImageOffset.x,
-                        (camY * mMapState.kCameraBlockSize.y) + mMapState.kCameraBlockImageOffset.y,
-                        mMapState.kVirtualScreenSize.x, mMapState.kVirtualScreenSize.y);
-                }
+                // Normally prefetched already, but don't show a blank frame if it isn't
+                screen->LoadTextures(rend, mLocator);
+                Debugging().mCulling.mVisibleScreens++;
+                Debugging().mCulling.mCulledScreens += mMapState.mScreens.Count() - 1;
+
+                const WorldRect bounds = mMapState.mScreens.ImageBounds(cam.mX, cam.mY);
+                screen->Render(rend, mLocator, bounds.mMin.x, bounds.mMin.y,
+                    mMapState.kVirtualScreenSize.x, mMapState.kVirtualScreenSize.y);
             }
         }
     }
@@ -98,46 +111,43 @@ void GameMode::Render(AbstractRenderer& rend) const
 
     if (Debugging().mDrawObjects)
     {
-        for (const auto& obj : mMapState.mObjs)
-        {
-            obj->Render(rend, 0, 0, 1.0f, AbstractRenderer::eForegroundLayer0);
-        }
+        mMapState.mObjectStore.Render(rend, mMapState.CullRect(rend), 0, 0, 1.0f, AbstractRenderer::eForegroundLayer0);
     }
 
     if (mMapState.mCameraSubject)
     {
         // Test raycasting for shadows
         mMapState.DebugRayCast(rend,
-            glm::vec2(mMapState.mCameraSubject->mXPos, mMapState.mCameraSubject->mYPos),
-            glm::vec2(mMapState.mCameraSubject->mXPos, mMapState.mCameraSubject->mYPos + 500),
+            glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos()),
+            glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos() + 500),
             0,
             glm::vec2(0, -10)); // -10 so when we are *ON* a line you can see something
 
         mMapState.DebugRayCast(rend,
-            glm::vec2(mMapState.mCameraSubject->mXPos, mMapState.mCameraSubject->mYPos - 2),
-            glm::vec2(mMapState.mCameraSubject->mXPos, mMapState.mCameraSubject->mYPos - 60),
+            glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos() - 2),
+            glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos() - 60),
             3,
             glm::vec2(0, 0));
 
-        if (mMapState.mCameraSubject->mFlipX)
+        if (mMapState.mCameraSubject->FacingLeft())
         {
             mMapState.DebugRayCast(rend,
-                glm::vec2(mMapState.mCameraSubject->mXPos, mMapState.mCameraSubject->mYPos - 20),
-                glm::vec2(mMapState.mCameraSubject->mXPos - 25, mMapState.mCameraSubject->mYPos - 20), 1);
+                glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos() - 20),
+                glm::vec2(mMapState.mCameraSubject->XPos() - 25, mMapState.mCameraSubject->YPos() - 20), 1);
 
             mMapState.DebugRayCast(rend,
-                glm::vec2(mMapState.mCameraSubject->mXPos, mMapState.mCameraSubject->mYPos - 50),
-                glm::vec2(mMapState.mCameraSubject->mXPos - 25, mMapState.mCameraSubject->mYPos - 50), 1);
+                glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos() - 50),
+                glm::vec2(mMapState.mCameraSubject->XPos() - 25, mMapState.mCameraSubject->YPos() - 50), 1);
         }
         else
         {
             mMapState.DebugRayCast(rend,
-                glm::vec2(mMapState.mCameraSubject->mXPos, mMapState.mCameraSubject->mYPos - 20),
-                glm::vec2(mMapState.mCameraSubject->mXPos + 25, mMapState.mCameraSubject->mYPos - 20), 2);
+                glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos() - 20),
+                glm::vec2(mMapState.mCameraSubject->XPos() + 25, mMapState.mCameraSubject->YPos() - 20), 2);
 
             mMapState.DebugRayCast(rend,
-                glm::vec2(mMapState.mCameraSubject->mXPos, mMapState.mCameraSubject->mYPos - 50),
-                glm::vec2(mMapState.mCameraSubject->mXPos + 25, mMapState.mCameraSubject->mYPos - 50), 2);
+                glm::vec2(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos() - 50),
+                glm::vec2(mMapState.mCameraSubject->XPos() + 25, mMapState.mCameraSubject->YPos() - 50), 2);
         }
     }
 }
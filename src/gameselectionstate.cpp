@@ -113,6 +113,64 @@ void GameSelectionState::RenderFindDataSets()
     }
 }
 
+bool GameSelectionState::SelectGame(const std::string& gameName)
+{
+    for (size_t idx = 0; idx < mVisibleGameDefinitions.size(); idx++)
+    {
+        if (mVisibleGameDefinitions[idx]->Name() == gameName)
+        {
+            mSelectedGameDefintionIndex = idx;
+            return true;
+        }
+    }
+    return false;
+}
+
+EngineStates GameSelectionState::StartSelectedGame()
+{
+    const GameDefinition& userSelectedGameDef = *mVisibleGameDefinitions[mSelectedGameDefintionIndex];
+
+    std::set<std::string> missingDataSets;
+
+    std::vector<const GameDefinition*> allGameDefs;
+    for (const GameDefinition& t : mGameDefinitions)
+    {
+        allGameDefs.push_back(&t);
+    }
+
+    // Check we have the required data sets
+    GameDefinition::GetDependencies(mRequiredDataSets, missingDataSets, &userSelectedGameDef, allGameDefs);
+    if (missingDataSets.empty())
+    {
+        // Check we have a valid path to the "builtin" (i.e original) game files
+        mRequiredDataSetNames.clear();
+        for (const DataPaths::Path& dataSet : mRequiredDataSets)
+        {
+            if (!dataSet.mSourceGameDefinition->IsMod())
+            {
+                mRequiredDataSetNames.push_back(dataSet.mDataSetName);
+            }
+        }
+
+        mMissingDataPaths = mResLocator.GetDataPaths().MissingDataSetPaths(mRequiredDataSetNames);
+        if (!mMissingDataPaths.empty())
+        {
+            mState = GameSelectionStates::eFindDataSets;
+        }
+        else
+        {
+            LoadGameDefinition();
+            return EngineStates::eRunGameState;
+        }
+    }
+    else
+    {
+        // Need user to download missing game defs, no in game way to recover from this
+        LOG_ERROR(missingDataSets.size() << " data sets are missing");
+    }
+    return EngineStates::eGameSelection;
+}
+
 EngineStates GameSelectionState::RenderSelectGame()
 {
     EngineStates nextState = EngineStates::eGameSelection;
@@ -154,46 +212,7 @@ EngineStates GameSelectionState::RenderSelectGame()
             ImGui::BeginChild("buttons");
                 if (ImGui::Button("Start game"))
                 {
-                    const GameDefinition& userSelectedGameDef = *mVisibleGameDefinitions[mSelectedGameDefintionIndex];
-
-                    std::set<std::string> missingDataSets;
-
-                    std::vector<const GameDefinition*> allGameDefs;
-                    for (const GameDefinition& t : mGameDefinitions)
-                    {
-                        allGameDefs.push_back(&t);
-                    }
-
-                    // Check we have the required data sets
-                    GameDefinition::GetDependencies(mRequiredDataSets, missingDataSets, &userSelectedGameDef, allGameDefs);
-                    if (missingDataSets.empty())
-                    {
-                        // Check we have a valid path to the "builtin" (i.e original) game files
-                        mRequiredDataSetNames.clear();
-                        for (const DataPaths::Path& dataSet : mRequiredDataSets)
-                        {
-                            if (!dataSet.mSourceGameDefinition->IsMod())
-                            {
-                                mRequiredDataSetNames.push_back(dataSet.mDataSetName);
-                            }
-                        }
-
-                        mMissingDataPaths = mResLocator.GetDataPaths().MissingDataSetPaths(mRequiredDataSetNames);
-                        if (!mMissingDataPaths.empty())
-                        {
-                            mState = GameSelectionStates::eFindDataSets;
-                        }
-                        else
-                        {
-                            LoadGameDefinition();
-                            nextState = EngineStates::eRunGameState;
-                        }
-                    }
-                    else
-                    {
-                        // Need user to download missing game defs, no in game way to recover from this
-                        LOG_ERROR(missingDataSets.size() << " data sets are missing");
-                    }
+                    nextState = StartSelectedGame();
                 }
                 ImGui::SameLine();
                 if (ImGui::Button("Quit"))
@@ -6,20 +6,25 @@
 #include "logger.hpp"
 #include <cassert>
 #include "oddlib/sdl_raii.hpp"
+#include "oddlib/exceptions.hpp"
 #include <algorithm> // min/max
+#include <cstring>
 #include <cmath>
+#include <limits>
 #include "resourcemapper.hpp"
 #include "engine.hpp"
 #include "gamemode.hpp"
+#include "cameraresidency.hpp"
 #include "editormode.hpp"
 #include "fmv.hpp"
 #include "sound.hpp"
+#include "replay.hpp"
 
-Level::Level(ResourceLocator& locator)
+Level::Level(ResourceLocator& locator, IFileSystem& fs)
     : mLocator(locator)
 {
-    mMap = std::make_unique<GridMap>();
-    Debugging().AddSection([&]() 
+    mMap = std::make_unique<GridMap>(locator, fs);
+    mDebugSection = Debugging().AddSection([&]() 
     {
         RenderDebugPathSelection();
     });
@@ -38,6 +43,14 @@ void Level::Update(const InputState& input, CoordinateSpace& coords)
     }
 }
 
+void Level::AddToStateHash(StateHash& hash) const
+{
+    if (mMap)
+    {
+        mMap->AddToStateHash(hash);
+    }
+}
+
 void Level::Render(AbstractRenderer& rend)
 {
     if (mMap)
@@ -65,12 +78,45 @@ void Level::UnloadMap(AbstractRenderer& renderer)
     mMap->UnloadMap(renderer);
 }
 
-GridScreen::GridScreen(const Oddlib::Path::Camera& camera, ResourceLocator& locator)
-    : mFileName(camera.mName)
-    , mCamera(camera)
-    , mLocator(locator)
+GridScreen::GridScreen(const Oddlib::Path::Camera& camera)
+    : mObjects(camera.mObjects)
 {
-   
+    static const std::string kExtension = ".CAM";
+    std::string stem = camera.mName;
+    if (stem.size() > kExtension.size() && stem.compare(stem.size() - kExtension.size(), kExtension.size(), kExtension) == 0)
+    {
+        stem.resize(stem.size() - kExtension.size());
+    }
+
+    if (stem.size() > kNameSize)
+    {
+        throw Oddlib::Exception("Camera name " + camera.mName + " is too long");
+    }
+
+    std::fill(std::begin(mName), std::end(mName), '\0');
+    std::copy(stem.begin(), stem.end(), mName);
+
+    // Blank cameras are all nulls or spaces
+    mHasTexture = std::any_of(std::begin(mName), std::end(mName), [](char c) { return c != ' ' && c != '\0'; });
+}
+
+GridScreen::GridScreen(GridScreen&& other)
+    : mHasTexture(other.mHasTexture)
+    , mTexHandle(other.mTexHandle)
+    , mTexHandle2(other.mTexHandle2)
+    , mObjects(std::move(other.mObjects))
+    , mCam(std::move(other.mCam))
+    , mPendingCam(std::move(other.mPendingCam))
+    , mPendingAbandoned(other.mPendingAbandoned)
+    , mGpuBytes(other.mGpuBytes)
+    , mCpuBytes(other.mCpuBytes)
+    , mLastUsedFrame(other.mLastUsedFrame)
+{
+    std::copy(std::begin(other.mName), std::end(other.mName), mName);
+
+    // The textures belong to this screen now
+    other.mTexHandle = TextureHandle();
+    other.mTexHandle2 = TextureHandle();
 }
 
 GridScreen::~GridScreen()
@@ -79,25 +125,77 @@ GridScreen::~GridScreen()
     assert(mTexHandle2.IsValid() == false);
 }
 
-void GridScreen::LoadTextures(AbstractRenderer& rend)
+std::string GridScreen::FileName() const
+{
+    if (!mHasTexture)
+    {
+        return std::string();
+    }
+    return std::string(mName, strnlen(mName, kNameSize)) + ".CAM";
+}
+
+void GridScreen::LoadTextures(AbstractRenderer& rend, ResourceLocator& locator)
+{
+    if (!mTexHandle.IsValid())
+    {
+        RequestTextures(locator);
+        if (mPendingCam.valid())
+        {
+            CreateTextures(rend, mPendingCam.get());
+        }
+    }
+}
+
+void GridScreen::RequestTextures(ResourceLocator& locator)
 {
     if (!mTexHandle.IsValid())
     {
-        mCam = mLocator.LocateCamera(mFileName).get();
-        if (mCam) // One path trys to load BRP08C10.CAM which exists in no data sets anywhere!
+        if (mPendingCam.valid())
+        {
+            // Wanted again before an abandoned load finished
+            mPendingAbandoned = false;
+        }
+        else
         {
-            SDL_Surface* surf = mCam->GetSurface();
-            mTexHandle = rend.CreateTexture(AbstractRenderer::eTextureFormats::eRGB, surf->w, surf->h, AbstractRenderer::eTextureFormats::eRGB, surf->pixels, true);
+            mPendingCam = locator.LocateCamera(FileName());
+        }
+    }
+}
+
+void GridScreen::FinishLoading(AbstractRenderer& rend)
+{
+    if (mPendingCam.valid() && mPendingCam.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        std::unique_ptr<Oddlib::IBits> cam = mPendingCam.get();
+        if (mPendingAbandoned)
+        {
+            mPendingAbandoned = false;
+            return;
+        }
+        CreateTextures(rend, std::move(cam));
+    }
+}
+
+void GridScreen::CreateTextures(AbstractRenderer& rend, std::unique_ptr<Oddlib::IBits> cam)
+{
+    mCam = std::move(cam);
+    if (mCam) // One path trys to load BRP08C10.CAM which exists in no data sets anywhere!
+    {
+        SDL_Surface* surf = mCam->GetSurface();
+        mTexHandle = rend.CreateTexture(AbstractRenderer::eTextureFormats::eRGB, surf->w, surf->h, AbstractRenderer::eTextureFormats::eRGB, surf->pixels, true);
+        mGpuBytes = surf->w * surf->h * 3;
+        mCpuBytes = surf->h * surf->pitch;
 
-            if (!mTexHandle2.IsValid())
+        if (!mTexHandle2.IsValid())
+        {
+            if (mCam->GetFg1())
             {
-                if (mCam->GetFg1())
+                SDL_Surface* fg1Surf = mCam->GetFg1()->GetSurface();
+                if (fg1Surf)
                 {
-                    SDL_Surface* fg1Surf = mCam->GetFg1()->GetSurface();
-                    if (fg1Surf)
-                    {
-                        mTexHandle2 = rend.CreateTexture(AbstractRenderer::eTextureFormats::eRGBA, fg1Surf->w, fg1Surf->h, AbstractRenderer::eTextureFormats::eRGBA, fg1Surf->pixels, true);
-                    }
+                    mTexHandle2 = rend.CreateTexture(AbstractRenderer::eTextureFormats::eRGBA, fg1Surf->w, fg1Surf->h, AbstractRenderer::eTextureFormats::eRGBA, fg1Surf->pixels, true);
+                    mGpuBytes += fg1Surf->w * fg1Surf->h * 4;
+                    mCpuBytes += fg1Surf->h * fg1Surf->pitch;
                 }
             }
         }
@@ -116,25 +214,20 @@ void GridScreen::UnLoadTextures(AbstractRenderer& rend)
         rend.DestroyTexture(mTexHandle2);
         mTexHandle2.mData = nullptr;
     }
-}
+    mCam = nullptr;
+    mGpuBytes = 0;
+    mCpuBytes = 0;
 
-bool GridScreen::hasTexture() const
-{
-    bool onlySpaces = true;
-    for (size_t i = 0; i < mFileName.size(); ++i) 
+    if (mPendingCam.valid())
     {
-        if (mFileName[i] != ' ' && mFileName[i] != '\0')
-        {
-            onlySpaces = false;
-            break;
-        }
+        mPendingAbandoned = true;
     }
-    return !onlySpaces;
 }
 
-void GridScreen::Render(AbstractRenderer& rend, float x, float y, float w, float h)
+void GridScreen::Render(AbstractRenderer& rend, ResourceLocator& locator, float x, float y, float w, float h)
 {
-    LoadTextures(rend);
+    RequestTextures(locator);
+    FinishLoading(rend);
     if (mTexHandle.IsValid())
     {
         rend.TexturedQuad(mTexHandle, x, y, w, h, AbstractRenderer::eForegroundLayer0, ColourU8{ 255, 255, 255, 255 });
@@ -158,11 +251,13 @@ void GridScreen::Render(AbstractRenderer& rend, float x, float y, float w, float
     Sqrat::RootTable().Bind("GridMap", gm);
 }
 
-GridMap::GridMap()
+GridMap::GridMap(ResourceLocator& locator, IFileSystem& fs)
     : mLoader(*this), mScriptInstance("gMap", this)
 {
-    mEditorMode = std::make_unique<EditorMode>(mMapState);
-    mGameMode = std::make_unique<GameMode>(mMapState);
+    mMapState.mThumbnails = std::make_unique<CameraThumbnails>(locator, fs);
+    mEditorMode = std::make_unique<EditorMode>(mMapState, locator);
+    mGameMode = std::make_unique<GameMode>(mMapState, locator);
+    mResidency = std::make_unique<CameraResidency>(locator);
 
     // Size of the screen you see during normal game play, this is always less than the "block" the camera image fits into
     mMapState.kVirtualScreenSize = glm::vec2(368.0f, 240.0f);
@@ -179,6 +274,7 @@ void GridMap::Loader::SetupAndConvertCollisionItems(const Oddlib::Path& path)
     // Clear out existing objects from previous map
     mGm.mMapState.mObjs.clear();
     mGm.mMapState.mCollisionItems.clear();
+    mGm.mMapState.mCollisionGraph.Clear();
     mGm.mEditorMode->OnMapChanged();
 
     // The "block" or grid square that a camera fits into, it never usually fills the grid
@@ -189,18 +285,15 @@ void GridMap::Loader::SetupAndConvertCollisionItems(const Oddlib::Path& path)
     // of the block or else where.
     mGm.mMapState.kCameraBlockImageOffset = (path.IsAo()) ? glm::vec2(257, 114) : glm::vec2(0, 0);
 
-    mGm.ConvertCollisionItems(path.CollisionItems());
+    mGm.ConvertCollisionItems(path.Collisions());
 
     SetState(LoaderStates::eAllocateCameraMemory);
 }
 
 void GridMap::Loader::HandleAllocateCameraMemory(const Oddlib::Path& path)
 {
-    mGm.mMapState.mScreens.resize(path.XSize());
-    for (auto& col : mGm.mMapState.mScreens)
-    {
-        col.resize(path.YSize());
-    }
+    GridMapState& state = mGm.mMapState;
+    state.mScreens.Reset(path.XSize(), path.YSize(), state.kCameraBlockSize, state.kCameraBlockImageOffset, state.kVirtualScreenSize);
     SetState(LoaderStates::eLoadCameras);
 }
 
@@ -210,10 +303,13 @@ void GridMap::Loader::HandleLoadCameras(const Oddlib::Path& path, ResourceLocato
     {
         return mYForLoop.Iterate(path.YSize(), [&]()
         {
-            mGm.mMapState.mScreens[mXForLoop.Value()][mYForLoop.Value()] = std::make_unique<GridScreen>(path.CameraByPosition(mXForLoop.Value(), mYForLoop.Value()), locator);
+            // Loaded in the same x major order as the cells are laid out
+            assert(mGm.mMapState.mScreens.Count() == (mXForLoop.Value() * path.YSize()) + mYForLoop.Value());
+            mGm.mMapState.mScreens.Add(path.CameraByPosition(mXForLoop.Value(), mYForLoop.Value()));
         });
     }))
     {
+        mGm.mMapState.mThumbnails->SetScreens(mGm.mMapState.mScreens);
         SetState(LoaderStates::eObjectLoaderScripts);
     }
 }
@@ -245,12 +341,12 @@ void GridMap::Loader::HandleLoadObjects(const Oddlib::Path& path, ResourceLocato
     {
         return mYForLoop.IterateIf(path.YSize(), [&]()
         {
-            GridScreen* screen = mGm.mMapState.mScreens[mXForLoop.Value()][mYForLoop.Value()].get();
-            const Oddlib::Path::Camera& cam = screen->getCamera();
-            return mIForLoop.Iterate(static_cast<u32>(cam.mObjects.size()), [&]()
+            const GridScreen* screen = mGm.mMapState.mScreens.At(mXForLoop.Value(), mYForLoop.Value());
+            const std::vector<Oddlib::Path::MapObject>& objects = screen->Objects();
+            return mIForLoop.Iterate(static_cast<u32>(objects.size()), [&]()
             {
-                const Oddlib::Path::MapObject& obj = cam.mObjects[mIForLoop.Value()];
-                Oddlib::MemoryStream ms(std::vector<u8>(obj.mData.data(), obj.mData.data() + obj.mData.size()));
+                const Oddlib::Path::MapObject& obj = objects[mIForLoop.Value()];
+                Oddlib::SpanStream ms(path.ObjectData(obj), obj.mDataSize);
                 const ObjRect rect =
                 {
                     obj.mRectTopLeft.mX,
@@ -259,7 +355,7 @@ void GridMap::Loader::HandleLoadObjects(const Oddlib::Path& path, ResourceLocato
                     obj.mRectBottomRight.mY - obj.mRectTopLeft.mY
                 };
 
-                auto mapObj = std::make_unique<MapObject>(locator, rect);
+                auto mapObj = std::make_unique<MapObject>(locator, mGm.mMapState.mObjectStore, rect);
 
                 Sqrat::Function objFactory(Sqrat::RootTable(), "object_factory");
                 Oddlib::IStream* s = &ms; // Script only knows about IStream, not the derived types
@@ -294,18 +390,18 @@ void GridMap::Loader::HandleHackAbeIntoValidCamera(ResourceLocator& locator)
     {
         // TODO: Need to figure out what the right way to figure out where abe goes is
         // HACK: Place the player in the first screen that isn't blank
-        for (auto x = 0u; x < mGm.mMapState.mScreens.size(); x++)
+        for (auto x = 0u; x < mGm.mMapState.mScreens.XSize(); x++)
         {
-            for (auto y = 0u; y < mGm.mMapState.mScreens[x].size(); y++)
+            for (auto y = 0u; y < mGm.mMapState.mScreens.YSize(); y++)
             {
-                GridScreen *screen = mGm.mMapState.mScreens[x][y].get();
+                const GridScreen* screen = mGm.mMapState.mScreens.At(x, y);
                 if (screen->hasTexture())
                 {
 
                     auto xPos = (x * mGm.mMapState.kCamGapSize.x) + 100.0f;
                     auto yPos = (y * mGm.mMapState.kCamGapSize.y) + 100.0f;
 
-                    auto tmp = std::make_unique<MapObject>(locator, ObjRect{});
+                    auto tmp = std::make_unique<MapObject>(locator, mGm.mMapState.mObjectStore, ObjRect{});
 
                     Sqrat::Function onInitMap(Sqrat::RootTable(), "on_init_map");
                     Sqrat::SharedPtr<bool> ret = onInitMap.Evaluate<bool>(tmp.get(), &mGm, xPos, yPos);
@@ -382,6 +478,15 @@ GridMap::~GridMap()
 
 void GridMap::Update(const InputState& input, CoordinateSpace& coords)
 {
+    ScopedSubsystemTimer timer(SubsystemTimings::eGridMap);
+
+    mMapState.mTickCounter++;
+
+    if (mMapState.mState == GridMapState::eStates::eEditor || mMapState.mState == GridMapState::eStates::eToEditor)
+    {
+        mMapState.mThumbnails->Build();
+    }
+
     if (mMapState.mState == GridMapState::eStates::eEditor)
     {
         mEditorMode->Update(input, coords);
@@ -396,6 +501,18 @@ void GridMap::Update(const InputState& input, CoordinateSpace& coords)
     }
 }
 
+void GridMap::AddToStateHash(StateHash& hash) const
+{
+    hash.Add(mMapState.mState);
+    hash.Add(mMapState.mCameraPosition.x);
+    hash.Add(mMapState.mCameraPosition.y);
+    hash.Add(static_cast<u32>(mMapState.mObjs.size()));
+    for (const auto& obj : mMapState.mObjs)
+    {
+        obj->AddToStateHash(hash);
+    }
+}
+
 void GridMap::UpdateToEditorOrToGame(const InputState& input, CoordinateSpace& coords)
 {
     std::ignore = input;
@@ -403,7 +520,7 @@ void GridMap::UpdateToEditorOrToGame(const InputState& input, CoordinateSpace& c
     if (mMapState.mState == GridMapState::eStates::eToEditor)
     {
         coords.SetScreenSize(glm::vec2(coords.Width(), coords.Height()) * mEditorMode->mEditorCamZoom);
-        if (SDL_TICKS_PASSED(SDL_GetTicks(), mMapState.mModeSwitchTimeout))
+        if (mMapState.mTickCounter >= mMapState.mModeSwitchTimeout)
         {
             mMapState.mState = GridMapState::eStates::eEditor;
         }
@@ -411,8 +528,9 @@ void GridMap::UpdateToEditorOrToGame(const InputState& input, CoordinateSpace& c
     else if (mMapState.mState == GridMapState::eStates::eToGame)
     {
         coords.SetScreenSize(mMapState.kVirtualScreenSize);
-        if (SDL_TICKS_PASSED(SDL_GetTicks(), mMapState.mModeSwitchTimeout))
+        if (mMapState.mTickCounter >= mMapState.mModeSwitchTimeout)
         {
+            mMapState.mCollisionGraph.Build(mMapState.mCollisionItems);
             mMapState.mState = GridMapState::eStates::eInGame;
         }
     }
@@ -452,14 +570,26 @@ void GridMapState::RenderGrid(AbstractRenderer& rend) const
     }
 }
 
+WorldRect GridMapState::CullRect(AbstractRenderer& rend) const
+{
+    if (Debugging().mCullToView)
+    {
+        return rend.VisibleWorldRect();
+    }
+    const f32 kMax = std::numeric_limits<f32>::max();
+    return WorldRect{ glm::vec2(-kMax, -kMax), glm::vec2(kMax, kMax) };
+}
+
 void GridMapState::RenderDebug(AbstractRenderer& rend) const
 {
     //rend.SetActiveLayer(AbstractRenderer::eEditor);
 
+    const WorldRect view = CullRect(rend);
+
     // Draw collisions
     if (Debugging().mCollisionLines)
     {
-        CollisionLine::Render(rend, mCollisionItems);
+        CollisionLine::Render(rend, view, mCollisionItems);
     }
 
     // Draw grid
@@ -471,34 +601,36 @@ void GridMapState::RenderDebug(AbstractRenderer& rend) const
     // Draw objects
     if (Debugging().mObjectBoundingBoxes)
     {
-        for (auto x = 0u; x < mScreens.size(); x++)
+        // Objects are stored with the camera they're in, so only the cameras around the view need checking.
+        // Some sit a little outside their camera, so look one camera further out.
+        u32 visible = 0;
+        u32 checked = 0;
+        const ScreenGrid::Range range = mScreens.CellsOverlapping(view.Expanded(std::max(kCameraBlockSize.x, kCameraBlockSize.y)));
+        mScreens.ForEach(range, [&](u32, u32, const GridScreen& screen)
         {
-            for (auto y = 0u; y < mScreens[x].size(); y++)
+            for (const Oddlib::Path::MapObject& obj : screen.Objects())
             {
-                GridScreen* screen = mScreens[x][y].get();
-                if (!screen)
+                glm::vec2 topLeft = glm::vec2(obj.mRectTopLeft.mX, obj.mRectTopLeft.mY);
+                glm::vec2 bottomRight = glm::vec2(obj.mRectBottomRight.mX, obj.mRectBottomRight.mY);
+
+                checked++;
+                if (!view.Intersects(WorldRect{ glm::min(topLeft, bottomRight), glm::max(topLeft, bottomRight) }))
                 {
                     continue;
                 }
-                const Oddlib::Path::Camera& cam = screen->getCamera();
-                for (size_t i = 0; i < cam.mObjects.size(); ++i)
-                {
-                    const Oddlib::Path::MapObject& obj = cam.mObjects[i];
-
-                    glm::vec2 topLeft = glm::vec2(obj.mRectTopLeft.mX, obj.mRectTopLeft.mY);
-                    glm::vec2 bottomRight = glm::vec2(obj.mRectBottomRight.mX, obj.mRectBottomRight.mY);
-
-                    glm::vec2 objPos = rend.WorldToScreen(glm::vec2(topLeft.x, topLeft.y));
-                    glm::vec2 objSize = rend.WorldToScreen(glm::vec2(bottomRight.x, bottomRight.y)) - objPos;
-                   
-                    rend.Rect(
-                        objPos.x, objPos.y,
-                        objSize.x, objSize.y,
-                        AbstractRenderer::eLayers::eEditor, ColourU8{ 255, 255, 255, 255 }, AbstractRenderer::eNormal, AbstractRenderer::eScreen);
-                   
-                }
+                visible++;
+
+                glm::vec2 objPos = rend.WorldToScreen(glm::vec2(topLeft.x, topLeft.y));
+                glm::vec2 objSize = rend.WorldToScreen(glm::vec2(bottomRight.x, bottomRight.y)) - objPos;
+
+                rend.Rect(
+                    objPos.x, objPos.y,
+                    objSize.x, objSize.y,
+                    AbstractRenderer::eLayers::eEditor, ColourU8{ 255, 255, 255, 255 }, AbstractRenderer::eNormal, AbstractRenderer::eScreen);
             }
-        }
+        });
+        Debugging().mCulling.mVisibleObjectRects += visible;
+        Debugging().mCulling.mCulledObjectRects += checked - visible;
     }
 }
 
@@ -547,28 +679,24 @@ static CollisionLine* GetCollisionIndexByIndex(CollisionLines& lines, s16 index)
     return nullptr;
 }
 
-static void ConvertLink(CollisionLines& lines, const Oddlib::Path::Links& oldLink, CollisionLine::Link& newLink)
+static void ConvertLink(CollisionLines& lines, s16 previous, s16 next, CollisionLine::Link& newLink)
 {
-    newLink.mPrevious = GetCollisionIndexByIndex(lines, oldLink.mPrevious);
-    newLink.mNext = GetCollisionIndexByIndex(lines, oldLink.mNext);
+    newLink.mPrevious = GetCollisionIndexByIndex(lines, previous);
+    newLink.mNext = GetCollisionIndexByIndex(lines, next);
 }
 
-void GridMap::ConvertCollisionItems(const std::vector<Oddlib::Path::CollisionItem>& items)
+void GridMap::ConvertCollisionItems(const Oddlib::Path::CollisionItems& items)
 {
-    const s32 count = static_cast<s32>(items.size());
+    const s32 count = static_cast<s32>(items.Count());
     mMapState.mCollisionItems.resize(count);
 
     // First pass to create/convert from original/"raw" path format
     for (auto i = 0; i < count; i++)
     {
-        mMapState.mCollisionItems[i] = std::make_unique<CollisionLine>();
-        mMapState.mCollisionItems[i]->mLine.mP1.x = items[i].mP1.mX;
-        mMapState.mCollisionItems[i]->mLine.mP1.y = items[i].mP1.mY;
-
-        mMapState.mCollisionItems[i]->mLine.mP2.x = items[i].mP2.mX;
-        mMapState.mCollisionItems[i]->mLine.mP2.y = items[i].mP2.mY;
-
-        mMapState.mCollisionItems[i]->mType = CollisionLine::ToType(items[i].mType);
+        mMapState.mCollisionItems[i] = std::make_unique<CollisionLine>(
+            glm::vec2(items.mP1X[i], items.mP1Y[i]),
+            glm::vec2(items.mP2X[i], items.mP2Y[i]),
+            CollisionLine::ToType(items.mType[i]));
     }
 
     // Second pass to set up raw pointers to existing lines for connected segments of 
@@ -576,8 +704,8 @@ void GridMap::ConvertCollisionItems(const std::vector<Oddlib::Path::CollisionIte
     for (auto i = 0; i < count; i++)
     {
         // TODO: Check if optional link is ever used in conjunction with link
-        ConvertLink(mMapState.mCollisionItems, items[i].mLinks[0], mMapState.mCollisionItems[i]->mLink);
-        ConvertLink(mMapState.mCollisionItems, items[i].mLinks[1], mMapState.mCollisionItems[i]->mOptionalLink);
+        ConvertLink(mMapState.mCollisionItems, items.mLinkPrevious[i], items.mLinkNext[i], mMapState.mCollisionItems[i]->mLink);
+        ConvertLink(mMapState.mCollisionItems, items.mOptionalLinkPrevious[i], items.mOptionalLinkNext[i], mMapState.mCollisionItems[i]->mOptionalLink);
     }
 
     // Now we can re-order collision items without breaking prev/next links, thus we want to ensure
@@ -598,31 +726,42 @@ void GridMap::ConvertCollisionItems(const std::vector<Oddlib::Path::CollisionIte
         }
     }
 
+    // Built last as it indexes the sorted lines and checks the links against the final geometry
+    mMapState.mCollisionGraph.Build(mMapState.mCollisionItems);
+
     // TODO: Render connected segments as one with control points
 }
 
 void GridMap::UnloadMap(AbstractRenderer& renderer)
 {
-    for (auto x = 0u; x < mMapState.mScreens.size(); x++)
+    for (GridScreen& screen : mMapState.mScreens)
     {
-        for (auto y = 0u; y < mMapState.mScreens[x].size(); y++)
-        {
-            GridScreen* screen = mMapState.mScreens[x][y].get();
-            if (!screen)
-            {
-                continue;
-            }
-            screen->UnLoadTextures(renderer);
-        }
+        screen.UnLoadTextures(renderer);
     }
+    mMapState.mThumbnails->UnloadTexture(renderer);
 
     mMapState.mObjs.clear();
     mMapState.mCollisionItems.clear();
-    mMapState.mScreens.clear();
+    mMapState.mCollisionGraph.Clear();
+    mMapState.mScreens.Clear();
 }
 
 void GridMap::Render(AbstractRenderer& rend) const
 {
+    Debugging().mCulling = {};
+
+    // In game the cameras around the subject are loaded before they are needed, in the editor
+    // only what gets drawn is loaded
+    if (mMapState.mState == GridMapState::eStates::eInGame && mMapState.mCameraSubject)
+    {
+        const glm::vec2 subjectPos(mMapState.mCameraSubject->XPos(), mMapState.mCameraSubject->YPos());
+        mResidency->Update(rend, mMapState, mMapState.mScreens.CellsAround(subjectPos, CameraResidency::kNeighbourRadius), true);
+    }
+    else
+    {
+        mResidency->Update(rend, mMapState, mMapState.mScreens.CellsOverlapping(mMapState.CullRect(rend)), false);
+    }
+
     if (mMapState.mState == GridMapState::eStates::eEditor)
     {
         mEditorMode->Render(rend);
@@ -0,0 +1,174 @@
+#include "inputevents.hpp"
+#include "engine.hpp"
+#include <algorithm>
+#include <cassert>
+
+void InputEventBus::Publish(const InputState& input)
+{
+    InputSnapshot snapshot;
+    snapshot.Capture(input);
+    Publish(snapshot);
+}
+
+void InputEventBus::Publish(const InputSnapshot& snapshot)
+{
+    mHistory[mTick % kHistoryTicks] = snapshot;
+    mTick++;
+
+    mEvents.clear();
+    AddKeyEvents(snapshot.mKeys[InputSnapshot::ePressed], InputEvent::eTypes::eKeyPressed);
+    AddKeyEvents(snapshot.mKeys[InputSnapshot::eReleased], InputEvent::eTypes::eKeyReleased);
+
+    for (u32 i = 0; i < snapshot.mMouseButtons.size(); i++)
+    {
+        // Packed the same way as InputSnapshot::Capture does
+        if (snapshot.mMouseButtons[i] & 2)
+        {
+            mEvents.push_back({ InputEvent::eTypes::eMouseButtonPressed, i });
+        }
+
+        if (snapshot.mMouseButtons[i] & 4)
+        {
+            mEvents.push_back({ InputEvent::eTypes::eMouseButtonReleased, i });
+        }
+    }
+
+    AddActionEvents(snapshot.mActions[InputSnapshot::ePressed], InputEvent::eTypes::eActionPressed);
+    AddActionEvents(snapshot.mActions[InputSnapshot::eReleased], InputEvent::eTypes::eActionReleased);
+
+    Dispatch();
+}
+
+void InputEventBus::AddKeyEvents(const std::bitset<SDL_NUM_SCANCODES>& keys, InputEvent::eTypes type)
+{
+    // Nearly every tick has no edges at all
+    if (keys.none())
+    {
+        return;
+    }
+
+    for (u32 i = 0; i < keys.size(); i++)
+    {
+        if (keys[i])
+        {
+            mEvents.push_back({ type, i });
+        }
+    }
+}
+
+void InputEventBus::AddActionEvents(u32 actions, InputEvent::eTypes type)
+{
+    for (u32 i = 0; actions != 0; i++, actions >>= 1)
+    {
+        if (actions & 1)
+        {
+            mEvents.push_back({ type, i });
+        }
+    }
+}
+
+void InputEventBus::Dispatch()
+{
+    if (mSubscribers.empty())
+    {
+        return;
+    }
+
+    mDispatching = true;
+    for (const InputEvent& event : mEvents)
+    {
+        auto it = mSubscribers.find(SubscriberKey(event.mType, event.mCode));
+        if (it != std::end(mSubscribers))
+        {
+            // A handler may subscribe to any edge. Subscribing to another edge can rehash the map,
+            // which moves the iterator but not the vector, and subscribing to this edge can grow
+            // the vector so it is indexed.
+            std::vector<Subscriber>& subscribers = it->second;
+            for (size_t i = 0; i < subscribers.size(); i++)
+            {
+                if (subscribers[i].mHandler)
+                {
+                    Handler handler = subscribers[i].mHandler;
+                    handler(event);
+                }
+            }
+        }
+    }
+    mDispatching = false;
+
+    if (mHaveUnsubscribed)
+    {
+        mHaveUnsubscribed = false;
+        for (auto& subscribers : mSubscribers)
+        {
+            subscribers.second.erase(std::remove_if(std::begin(subscribers.second), std::end(subscribers.second), [](const Subscriber& subscriber)
+            {
+                return !subscriber.mHandler;
+            }), std::end(subscribers.second));
+        }
+    }
+}
+
+InputEventBus::SubscriptionId InputEventBus::Subscribe(InputEvent::eTypes type, u32 code, Handler handler)
+{
+    const SubscriptionId id = mNextId++;
+    mSubscribers[SubscriberKey(type, code)].push_back({ id, handler });
+    return id;
+}
+
+void InputEventBus::Unsubscribe(SubscriptionId id)
+{
+    for (auto& subscribers : mSubscribers)
+    {
+        auto it = std::find_if(std::begin(subscribers.second), std::end(subscribers.second), [id](const Subscriber& subscriber)
+        {
+            return subscriber.mId == id;
+        });
+
+        if (it != std::end(subscribers.second))
+        {
+            if (mDispatching)
+            {
+                it->mHandler = nullptr;
+                mHaveUnsubscribed = true;
+            }
+            else
+            {
+                subscribers.second.erase(it);
+            }
+            return;
+        }
+    }
+}
+
+const InputSnapshot& InputEventBus::Snapshot(u32 ticksAgo) const
+{
+    assert(ticksAgo < HistorySize());
+    return mHistory[(mTick - 1 - ticksAgo) % kHistoryTicks];
+}
+
+bool InputEventBus::KeyPressedWithin(u32 key, u32 ticks) const
+{
+    const u32 count = std::min(ticks, HistorySize());
+    for (u32 i = 0; i < count; i++)
+    {
+        if (Snapshot(i).mKeys[InputSnapshot::ePressed][key])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool InputEventBus::ActionPressedWithin(u32 action, u32 ticks) const
+{
+    const u32 count = std::min(ticks, HistorySize());
+    for (u32 i = 0; i < count; i++)
+    {
+        if (Snapshot(i).mActions[InputSnapshot::ePressed] & (1u << action))
+        {
+            return true;
+        }
+    }
+    return false;
+}
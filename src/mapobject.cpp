@@ -5,6 +5,9 @@
 #include "collisionline.hpp"
 #include "gridmap.hpp"
 #include "resourcemapper.hpp"
+#include "replay.hpp"
+#include "mapobjectstore.hpp"
+#include <cassert>
 
 /*static*/ void MapObject::RegisterScriptBindings()
 {
@@ -37,8 +40,9 @@
 
         c.Func("FacingRight", &MapObject::FacingRight);
         c.Func("FlipXDirection", &MapObject::FlipXDirection);
-        c.Var("mXPos", &MapObject::mXPos);
-        c.Var("mYPos", &MapObject::mYPos);
+        c.Func("SetAlwaysActive", &MapObject::SetAlwaysActive);
+        c.Prop("mXPos", &MapObject::XPos, &MapObject::SetXPos);
+        c.Prop("mYPos", &MapObject::YPos, &MapObject::SetYPos);
         c.Var("mName", &MapObject::mName);
         Sqrat::RootTable().Bind("MapObject", c);
     }
@@ -153,13 +157,114 @@ void MapObject::Loader::SetState(MapObject::Loader::LoaderStates state)
     }
 }
 
+MapObject::MapObject(ResourceLocator& locator, MapObjectStore& store, const ObjRect& rect, MapObjectHandle parent)
+    : mLocator(locator), mStore(store)
+{
+    mHandle = mStore.Add(this, rect, parent);
+}
+
 MapObject::~MapObject()
 {
+    // Destructors can't throw, a stale handle means the store was changed behind this object's back
+    if (!mStore.TryRemove(mHandle))
+    {
+        LOG_ERROR("MapObject " << mName << " wasn't in the store when destroyed");
+        assert(false);
+    }
+}
+
+f32 MapObject::XPos() const
+{
+    return mStore.mXPos[mStore.Index(mHandle)];
+}
+
+f32 MapObject::YPos() const
+{
+    return mStore.mYPos[mStore.Index(mHandle)];
+}
+
+void MapObject::SetXPos(f32 xpos)
+{
+    mStore.mXPos[mStore.Index(mHandle)] = xpos;
+}
+
+void MapObject::SetYPos(f32 ypos)
+{
+    mStore.mYPos[mStore.Index(mHandle)] = ypos;
+}
+
+bool MapObject::FacingLeft() const
+{
+    return mStore.mFlipX[mStore.Index(mHandle)] != 0;
+}
+
+void MapObject::SetAlwaysActive(bool alwaysActive)
+{
+    mStore.mAlwaysActive[mStore.Index(mHandle)] = alwaysActive ? 1 : 0;
+}
+
+bool MapObject::AlwaysActive() const
+{
+    return mStore.mAlwaysActive[mStore.Index(mHandle)] != 0;
+}
+
+void MapObject::FlipXDirection()
+{
+    u8& flipX = mStore.mFlipX[mStore.Index(mHandle)];
+    flipX = !flipX;
+}
+
+Animation* MapObject::CurrentAnimation() const
+{
+    return mStore.mAnim[mStore.Index(mHandle)];
+}
+
+void MapObject::SetCurrentAnimation(Animation* anim)
+{
+    mStore.mAnim[mStore.Index(mHandle)] = anim;
+}
+
+Animation* MapObject::FindAnimation(const std::string& name)
+{
+    for (size_t i = 0; i < mAnimNames.size(); i++)
+    {
+        if (mAnimNames[i] == name)
+        {
+            return &mAnims[i];
+        }
+    }
+    return nullptr;
 }
 
 void MapObject::LoadAnimation(const std::string& name)
 {
-    mAnims[name] = mLocator.LocateAnimation(name).get();
+    // Already loaded when the script is reloaded
+    if (FindAnimation(name))
+    {
+        return;
+    }
+
+    std::unique_ptr<Animation> anim = mLocator.LocateAnimation(name).get();
+    if (!anim)
+    {
+        LOG_ERROR("Animation " << name << " not found");
+        return;
+    }
+    AddAnimation(name, std::move(*anim));
+}
+
+Animation* MapObject::AddAnimation(const std::string& name, Animation anim)
+{
+    // Adding may move the animations, so the current one has to be pointed at again
+    Animation* current = CurrentAnimation();
+    const size_t currentIndex = current ? static_cast<size_t>(current - mAnims.data()) : 0;
+    mAnimNames.push_back(name);
+    mAnims.push_back(std::move(anim));
+    if (current)
+    {
+        SetCurrentAnimation(&mAnims[currentIndex]);
+    }
+    return &mAnims.back();
 }
 
 bool MapObject::Init()
@@ -183,38 +288,57 @@ bool MapObject::WallCollision(IMap& map, f32 dx, f32 dy) const
     // The game checks for both kinds of walls no matter the direction
     // ddcheat into a tunnel and the "inside out" wall will still force
     // a crouch.
+    const u32 index = mStore.Index(mHandle);
+    const f32 xpos = mStore.mXPos[index];
+    const f32 ypos = mStore.mYPos[index];
     return
         CollisionLine::RayCast<2>(map.Lines(),
-            glm::vec2(mXPos, mYPos + dy),
-            glm::vec2(mXPos + (mFlipX ? -dx : dx), mYPos + dy),
+            glm::vec2(xpos, ypos + dy),
+            glm::vec2(xpos + (mStore.mFlipX[index] ? -dx : dx), ypos + dy),
             { 1u, 2u }, nullptr);
 }
 
 bool MapObject::CellingCollision(IMap& map, f32 dx, f32 dy) const
 {
+    const u32 index = mStore.Index(mHandle);
+    const f32 xpos = mStore.mXPos[index] + (mStore.mFlipX[index] ? -dx : dx);
+    const f32 ypos = mStore.mYPos[index];
     return CollisionLine::RayCast<1>(map.Lines(),
-        glm::vec2(mXPos + (mFlipX ? -dx : dx), mYPos - 2), // avoid collision if we are standing on a celling
-        glm::vec2(mXPos + (mFlipX ? -dx : dx), mYPos + dy),
+        glm::vec2(xpos, ypos - 2), // avoid collision if we are standing on a celling
+        glm::vec2(xpos, ypos + dy),
         { 3u }, nullptr);
 }
 
 CollisionResult MapObject::FloorCollision(IMap& map) const
 {
+    const f32 xpos = XPos();
+    const f32 ypos = YPos();
+
+    const s32 floorLine = map.Graph().FloorBelow(mFloorLine, glm::vec2(xpos, ypos));
+    if (floorLine != CollisionGraph::kNoLine)
+    {
+        mFloorLine = floorLine;
+        const f32 floorY = map.Graph().YAt(floorLine, xpos);
+        return{ true, xpos, floorY, floorY - ypos };
+    }
+
     Physics::raycast_collision c;
     if (CollisionLine::RayCast<1>(map.Lines(),
-        glm::vec2(mXPos, mYPos),
-        glm::vec2(mXPos, mYPos + 260 * 3), // Check up to 3 screen down
+        glm::vec2(xpos, ypos),
+        glm::vec2(xpos, ypos + 260 * 3), // Check up to 3 screen down
         { 0u }, &c))
     {
-        const f32 distance = glm::distance(mYPos, c.intersection.y);
+        mFloorLine = c.lineIndex;
+        const f32 distance = glm::distance(ypos, c.intersection.y);
         return{ true, c.intersection.x, c.intersection.y, distance };
     }
+    mFloorLine = CollisionGraph::kNoLine;
     return{};
 }
 
 MapObject* MapObject::AddChildObject()
 {
-    auto ptr = std::make_unique<MapObject>(mLocator, mRect);
+    auto ptr = std::make_unique<MapObject>(mLocator, mStore, mStore.mRect[mStore.Index(mHandle)], mHandle);
     MapObject* pRaw = ptr.get();
     mChildren.push_back(std::move(ptr));
     return pRaw;
@@ -277,6 +401,18 @@ void MapObject::LoadScript()
     */
 }
 
+void MapObject::SleepUpdate()
+{
+    // Optional, most objects do nothing at all while asleep
+    Sqrat::Function sleepUpdateFn(mScriptObject, "SleepUpdate");
+    if (!sleepUpdateFn.IsNull())
+    {
+        ScopedSubsystemTimer scriptTimer(SubsystemTimings::eScripts);
+        sleepUpdateFn.Execute();
+        SquirrelVm::CheckError();
+    }
+}
+
 void MapObject::Update(const InputState& input)
 {
     //TRACE_ENTRYEXIT;
@@ -290,6 +426,7 @@ void MapObject::Update(const InputState& input)
     //if (mAnim)
     {
 
+        ScopedSubsystemTimer scriptTimer(SubsystemTimings::eScripts);
         Sqrat::Function updateFn(mScriptObject, "Update");
         updateFn.Execute(input.Mapping().GetActions());
         SquirrelVm::CheckError();
@@ -307,17 +444,20 @@ void MapObject::Update(const InputState& input)
 
     //::Sleep(300);
 
+    const f32 xpos = XPos();
+    const f32 ypos = YPos();
+
     static float prevX = 0.0f;
     static float prevY = 0.0f;
-    if (prevX != mXPos || prevY != mYPos)
+    if (prevX != xpos || prevY != ypos)
     {
-        //LOG_INFO("Player X Delta " << mXPos - prevX << " Y Delta " << mYPos - prevY << " frame " << mAnim->FrameNumber());
+        //LOG_INFO("Player X Delta " << xpos - prevX << " Y Delta " << ypos - prevY << " frame " << FrameNumber());
     }
-    prevX = mXPos;
-    prevY = mYPos;
+    prevX = xpos;
+    prevY = ypos;
 
-    Debugging().mInfo.mXPos = mXPos;
-    Debugging().mInfo.mYPos = mYPos;
+    Debugging().mInfo.mXPos = xpos;
+    Debugging().mInfo.mYPos = ypos;
     Debugging().mInfo.mFrameToRender = FrameNumber();
 
     if (Debugging().mSingleStepObject && Debugging().mDoSingleStepObject)
@@ -329,19 +469,21 @@ void MapObject::Update(const InputState& input)
 
 bool MapObject::AnimationComplete() const
 {
-    if (!mAnim) { return false; }
-    return mAnim->IsComplete();
+    Animation* anim = CurrentAnimation();
+    if (!anim) { return false; }
+    return anim->IsComplete();
 }
 
 void MapObject::SetAnimation(const std::string& animation)
 {
     if (animation.empty())
     {
-        mAnim = nullptr;
+        SetCurrentAnimation(nullptr);
     }
     else
     {
-        if (mAnims.find(animation) == std::end(mAnims))
+        Animation* anim = FindAnimation(animation);
+        if (!anim)
         {
             abort();
             /*
@@ -354,97 +496,140 @@ void MapObject::SetAnimation(const std::string& animation)
             mAnims[animation] = std::move(anim);
             */
         }
-        mAnim = mAnims[animation].get();
-        mAnim->Restart();
+        anim->Restart();
+        SetCurrentAnimation(anim);
     }
 }
 
 void MapObject::SetAnimationFrame(s32 frame)
 {
-    if (mAnim)
+    Animation* anim = CurrentAnimation();
+    if (anim)
     {
-        mAnim->SetFrame(frame);
+        anim->SetFrame(frame);
     }
 }
 
 void MapObject::SetAnimationAtFrame(const std::string& animation, u32 frame)
 {
     SetAnimation(animation);
-    mAnim->SetFrame(frame);
+    CurrentAnimation()->SetFrame(frame);
 }
 
 bool MapObject::AnimUpdate()
 {
-    return mAnim->Update();
+    return CurrentAnimation()->Update();
 }
 
 s32 MapObject::FrameCounter() const
 {
-    return mAnim->FrameCounter();
+    return CurrentAnimation()->FrameCounter();
 }
 
 s32 MapObject::NumberOfFrames() const
 {
-    return mAnim->NumberOfFrames();
+    return CurrentAnimation()->NumberOfFrames();
 }
 
 bool MapObject::IsLastFrame() const
 {
-    return mAnim->IsLastFrame();
+    return CurrentAnimation()->IsLastFrame();
 }
 
 s32 MapObject::FrameNumber() const
 {
-    if (!mAnim) { return 0; }
-    return mAnim->FrameNumber();
+    Animation* anim = CurrentAnimation();
+    if (!anim) { return 0; }
+    return anim->FrameNumber();
 }
 
-void MapObject::ReloadScript()
+void MapObject::AddToStateHash(StateHash& hash) const
 {
-    LoadScript();
-    SnapXToGrid();
-}
+    hash.Add(mId);
+    hash.Add(XPos());
+    hash.Add(YPos());
+    hash.Add(FacingLeft());
+    hash.Add(FrameNumber());
 
-void MapObject::Render(AbstractRenderer& rend, int x, int y, float scale, int layer) const
-{
-    if (mAnim)
+    // Which animation is playing, by name so that the order they were loaded in doesn't matter
+    Animation* anim = CurrentAnimation();
+    const std::string& animName = anim ? mAnimNames[static_cast<size_t>(anim - mAnims.data())] : std::string();
+    hash.Add(static_cast<u32>(animName.size()));
+    hash.Add(animName.data(), animName.size());
+
+    // Script state that the position and animation don't capture, such as which state Abe is in
+    Sqrat::Object scriptObject = mScriptObject;
+    Sqrat::Array slotsArray;
+    if (GetArray(scriptObject, "kStateHashSlots", slotsArray))
     {
-        mAnim->SetXPos(static_cast<s32>(mXPos) + x);
-        mAnim->SetYPos(static_cast<s32>(mYPos) + y);
-        mAnim->SetScale(scale);
-        mAnim->Render(rend, mFlipX, layer);
+        for (SQInteger i = 0; i < slotsArray.GetSize(); i++)
+        {
+            Sqrat::SharedPtr<std::string> slotName = slotsArray.GetValue<std::string>(static_cast<int>(i));
+            if (!slotName)
+            {
+                continue;
+            }
+
+            Sqrat::Object slot = scriptObject.GetSlot(slotName->c_str());
+            switch (slot.GetType())
+            {
+            case OT_INTEGER:
+                hash.Add(static_cast<u64>(slot.Cast<SQInteger>()));
+                break;
+            case OT_FLOAT:
+                hash.Add(static_cast<f32>(slot.Cast<SQFloat>()));
+                break;
+            case OT_BOOL:
+                hash.Add(slot.Cast<bool>());
+                break;
+            default:
+                // Only values are hashed, a missing slot or a reference hashes as its type
+                hash.Add(static_cast<s32>(slot.GetType()));
+                break;
+            }
+        }
     }
-    for (auto& child : mChildren)
+
+    for (const auto& child : mChildren)
     {
-        child->Render(rend, x, y, scale, layer);
+        child->AddToStateHash(hash);
     }
 }
 
+void MapObject::ReloadScript()
+{
+    LoadScript();
+    SnapXToGrid();
+}
+
 bool MapObject::ContainsPoint(s32 x, s32 y) const
 {
-    if (!mAnim)
+    const u32 index = mStore.Index(mHandle);
+    Animation* anim = mStore.mAnim[index];
+    if (!anim)
     {
         // For animationless objects use the object rect
-        return PointInRect(x, y, mRect.x, mRect.y, mRect.w, mRect.h);
+        const ObjRect& rect = mStore.mRect[index];
+        return PointInRect(x, y, rect.x, rect.y, rect.w, rect.h);
     }
 
-    return mAnim->Collision(x, y);
+    return anim->Collision(x, y);
 }
 
 void MapObject::SnapXToGrid()
 {
     //25x20 grid hack
-    const float oldX = mXPos;
-    const s32 xpos = static_cast<s32>(mXPos);
+    const float oldX = XPos();
+    const s32 xpos = static_cast<s32>(oldX);
     const s32 gridPos = (xpos - 12) % 25;
     if (gridPos >= 13)
     {
-        mXPos = static_cast<float>(xpos - gridPos + 25);
+        SetXPos(static_cast<float>(xpos - gridPos + 25));
     }
     else
     {
-        mXPos = static_cast<float>(xpos - gridPos);
+        SetXPos(static_cast<float>(xpos - gridPos));
     }
 
-    LOG_INFO("SnapX: " << oldX << " to " << mXPos);
+    LOG_INFO("SnapX: " << oldX << " to " << XPos());
 }
@@ -0,0 +1,160 @@
+#include "mapobjectstore.hpp"
+#include "resourcemapper.hpp"
+#include "oddlib/exceptions.hpp"
+#include "debug.hpp"
+#include <algorithm>
+
+MapObjectHandle MapObjectStore::Add(MapObject* owner, const ObjRect& rect, MapObjectHandle parent)
+{
+    u32 slot = 0;
+    if (mFreeSlots.empty())
+    {
+        slot = static_cast<u32>(mSlotToIndex.size());
+        mSlotToIndex.push_back(0);
+        mSlotGeneration.push_back(0);
+        mSlotParent.emplace_back();
+        mSlotSequence.push_back(0);
+    }
+    else
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+
+    mSlotToIndex[slot] = Count();
+    mIndexToSlot.push_back(slot);
+
+    mXPos.push_back(50.0f);
+    mYPos.push_back(100.0f);
+    mFlipX.push_back(0);
+    mAnim.push_back(nullptr);
+    mRect.push_back(rect);
+    mAlwaysActive.push_back(0);
+    mOwner.push_back(owner);
+
+    mSlotParent[slot] = parent;
+    mSlotSequence[slot] = mNextSequence++;
+    mDrawOrderDirty = true;
+
+    MapObjectHandle handle;
+    handle.mSlot = slot;
+    handle.mGeneration = mSlotGeneration[slot];
+    return handle;
+}
+
+template<class T>
+static void RemoveBySwap(std::vector<T>& v, u32 index)
+{
+    v[index] = v.back();
+    v.pop_back();
+}
+
+void MapObjectStore::Remove(MapObjectHandle handle)
+{
+    if (!TryRemove(handle))
+    {
+        throw Oddlib::Exception("Removing a MapObject that isn't in the store");
+    }
+}
+
+bool MapObjectStore::TryRemove(MapObjectHandle handle)
+{
+    if (!IsValid(handle))
+    {
+        return false;
+    }
+
+    const u32 index = mSlotToIndex[handle.mSlot];
+    const u32 lastSlot = mIndexToSlot.back();
+
+    RemoveBySwap(mXPos, index);
+    RemoveBySwap(mYPos, index);
+    RemoveBySwap(mFlipX, index);
+    RemoveBySwap(mAnim, index);
+    RemoveBySwap(mRect, index);
+    RemoveBySwap(mAlwaysActive, index);
+    RemoveBySwap(mOwner, index);
+    RemoveBySwap(mIndexToSlot, index);
+
+    // The last object now lives where the removed one was
+    mSlotToIndex[lastSlot] = index;
+
+    mSlotGeneration[handle.mSlot]++;
+    mFreeSlots.push_back(handle.mSlot);
+    mDrawOrderDirty = true;
+    return true;
+}
+
+bool MapObjectStore::IsValid(MapObjectHandle handle) const
+{
+    return handle.mSlot < mSlotGeneration.size() && mSlotGeneration[handle.mSlot] == handle.mGeneration;
+}
+
+const std::vector<u32>& MapObjectStore::DrawOrder() const
+{
+    if (!mDrawOrderDirty)
+    {
+        return mDrawOrder;
+    }
+    mDrawOrderDirty = false;
+
+    // Creation order, a child is always created after its parent
+    std::vector<u32> slots = mIndexToSlot;
+    std::sort(slots.begin(), slots.end(), [&](u32 a, u32 b) { return mSlotSequence[a] < mSlotSequence[b]; });
+
+    std::vector<std::vector<u32>> children(SlotCount());
+    std::vector<u32> stack;
+    for (auto it = slots.rbegin(); it != slots.rend(); ++it)
+    {
+        // Reversed so that popping the stack gives creation order
+        const MapObjectHandle parent = mSlotParent[*it];
+        if (IsValid(parent))
+        {
+            children[parent.mSlot].push_back(*it);
+        }
+        else
+        {
+            stack.push_back(*it);
+        }
+    }
+
+    mDrawOrder.clear();
+    while (!stack.empty())
+    {
+        const u32 slot = stack.back();
+        stack.pop_back();
+        mDrawOrder.push_back(slot);
+        stack.insert(stack.end(), children[slot].begin(), children[slot].end());
+    }
+    return mDrawOrder;
+}
+
+void MapObjectStore::Render(AbstractRenderer& rend, const WorldRect& view, int x, int y, float scale, int layer) const
+{
+    u32 visible = 0;
+    u32 culled = 0;
+    for (const u32 slot : DrawOrder())
+    {
+        const u32 i = mSlotToIndex[slot];
+        Animation* anim = mAnim[i];
+        if (anim)
+        {
+            anim->SetXPos(static_cast<s32>(mXPos[i]) + x);
+            anim->SetYPos(static_cast<s32>(mYPos[i]) + y);
+            anim->SetScale(scale);
+
+            const bool flipX = mFlipX[i] != 0;
+            if (view.Intersects(anim->Bounds(flipX)))
+            {
+                anim->Render(rend, flipX, layer);
+                visible++;
+            }
+            else
+            {
+                culled++;
+            }
+        }
+    }
+    Debugging().mCulling.mVisibleObjects += visible;
+    Debugging().mCulling.mCulledObjects += culled;
+}
@@ -4,7 +4,7 @@
 void AliveAudio::CleanVoices()
 {
     std::vector<AliveAudioVoice *> deadVoices;
-    std::unique_lock<std::recursive_mutex> voiceLock(mVoiceMutex);
+    auto voiceLock = VoiceLock();
     for (auto& voice : m_Voices)
     {
         if (voice->b_Dead)
@@ -31,7 +31,7 @@ void AliveAudio::AliveRenderAudio(f32 * AudioStream, int StreamLength)
     }
 
     {
-        std::unique_lock<std::recursive_mutex> voiceLock(mVoiceMutex);
+        auto voiceLock = VoiceLock();
         const size_t voiceCount = m_Voices.size();
 
         AliveAudioVoice ** rawPointer = m_Voices.data(); // Real nice speed boost here.
@@ -106,12 +106,24 @@ void AliveAudio::AliveRenderAudio(f32 * AudioStream, int StreamLength)
         m_ReverbChannelBuffer[i + 1] = right;
     }
    
-    for (int i = 0; i < StreamLength; i += 2)
+    if (mOffline)
+    {
+        // Same clamped add as SDL's float mixing without a call per sample
+        for (int i = 0; i < StreamLength; i++)
+        {
+            const f32 mixed = AudioStream[i] + m_DryChannelBuffer[i] + m_ReverbChannelBuffer[i];
+            AudioStream[i] = std::max(-1.0f, std::min(mixed, 1.0f));
+        }
+    }
+    else
     {
-        const f32 left = m_DryChannelBuffer[i] + m_ReverbChannelBuffer[i];
-        const f32 right = m_DryChannelBuffer[i + 1] + m_ReverbChannelBuffer[i + 1];
-        SDL_MixAudioFormat((u8 *)(AudioStream + i), (const u8*)&left, AUDIO_F32, sizeof(f32), SDL_MIX_MAXVOLUME);
-        SDL_MixAudioFormat((u8 *)(AudioStream + i + 1), (const u8*)&right, AUDIO_F32, sizeof(f32), SDL_MIX_MAXVOLUME);
+        for (int i = 0; i < StreamLength; i += 2)
+        {
+            const f32 left = m_DryChannelBuffer[i] + m_ReverbChannelBuffer[i];
+            const f32 right = m_DryChannelBuffer[i + 1] + m_ReverbChannelBuffer[i + 1];
+            SDL_MixAudioFormat((u8 *)(AudioStream + i), (const u8*)&left, AUDIO_F32, sizeof(f32), SDL_MIX_MAXVOLUME);
+            SDL_MixAudioFormat((u8 *)(AudioStream + i + 1), (const u8*)&right, AUDIO_F32, sizeof(f32), SDL_MIX_MAXVOLUME);
+        }
     }
 
     CleanVoices();
@@ -120,10 +132,11 @@ void AliveAudio::AliveRenderAudio(f32 * AudioStream, int StreamLength)
 
 void AliveAudio::Play(f32* stream, u32 len)
 {
-    if (m_DryChannelBuffer.size() != len)
+    if (m_DryChannelBuffer.size() < len)
     {
         // Maybe it's ok to have some crackles when the buffer size changes.
         // (This allocates memory, which you should never do in audio thread.)
+        // Only ever grows as offline rendering plays varying lengths between events.
         m_DryChannelBuffer.resize(len);
         m_ReverbChannelBuffer.resize(len);
     }
@@ -226,7 +239,7 @@ void AliveAudio::NoteOn(int program, int note, char velocity, f64 trackDelay, f6
             voice->f_TrackDelay = trackDelay;
             voice->m_DebugDisableResampling = DebugDisableVoiceResampling;
             voice->mbIgnoreLoops = ignoreLoops;
-            std::unique_lock<std::recursive_mutex> voiceLock(mVoiceMutex);
+            auto voiceLock = VoiceLock();
             m_Voices.push_back(voice);
         }
     }
@@ -234,7 +247,7 @@ void AliveAudio::NoteOn(int program, int note, char velocity, f64 trackDelay, f6
 
 void AliveAudio::NoteOff(int program, int note)
 {
-    std::unique_lock<std::recursive_mutex> voiceLock(mVoiceMutex);
+    auto voiceLock = VoiceLock();
     for (auto& voice : m_Voices)
     {
         if (voice->i_Note == note && voice->i_Program == program)
@@ -246,7 +259,7 @@ void AliveAudio::NoteOff(int program, int note)
 
 void AliveAudio::NoteOffDelay(int program, int note, f32 trackDelay)
 {
-    std::unique_lock<std::recursive_mutex> voiceLock(mVoiceMutex);
+    auto voiceLock = VoiceLock();
     for (auto& voice : m_Voices)
     {
         if (voice->i_Note == note && voice->i_Program == program && voice->f_TrackDelay < trackDelay && voice->f_NoteOffDelay <= 0)
@@ -262,7 +275,7 @@ void AliveAudio::ClearAllVoices(bool forceKill)
 {
     std::vector<AliveAudioVoice *> deadVoices;
 
-    std::unique_lock<std::recursive_mutex> voiceLock(mVoiceMutex);
+    auto voiceLock = VoiceLock();
     for (auto& voice : m_Voices)
     {
         if (forceKill)
@@ -292,7 +305,7 @@ void AliveAudio::ClearAllTrackVoices(bool forceKill)
 {
     std::vector<AliveAudioVoice *> deadVoices;
 
-    std::unique_lock<std::recursive_mutex> voiceLock(mVoiceMutex);
+    auto voiceLock = VoiceLock();
     for (auto& voice : m_Voices)
     {
         if (forceKill)
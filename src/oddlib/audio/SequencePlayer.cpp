@@ -1,5 +1,7 @@
 #include "oddlib/audio/SequencePlayer.h"
 #include "imgui/imgui.h"
+#include <algorithm>
+#include <cmath>
 
 SequencePlayer::SequencePlayer(const std::string& name, Vab& soundBank)
     : mName(name)
@@ -42,11 +44,64 @@ f64 SequencePlayer::MidiTimeToSample(int time)
     return ((60 * time) / m_SongTempo) * (kAliveAudioSampleRate / 500.0);
 }
 
-void SequencePlayer::Restart()
+// A voice's track delay is counted down before each sample it renders, so it is first heard
+// on the sample the delay reaches 0 or less
+static u64 DelayToSampleOffset(f64 trackDelay)
+{
+    return trackDelay > 1.0 ? static_cast<u64>(std::ceil(trackDelay)) - 1 : 0;
+}
+
+void SequencePlayer::SetOfflineRendering(bool offline)
 {
     std::lock_guard<std::mutex> lock(mMutex);
+    mOffline = offline;
+    mAliveAudio.SetOfflineRendering(offline);
+}
+
+void SequencePlayer::Restart()
+{
+    auto lock = Lock();
     m_PlayerState = ALIVE_SEQUENCER_PLAYING;
     mAliveAudio.mCurrentSampleIndex = 0;
+    mNextEvent = 0;
+}
+
+void SequencePlayer::ScheduleEvents()
+{
+    int channels[16] = {};
+    bool firstNote = true;
+
+    mSchedule.clear();
+    mNextEvent = 0;
+    for (const AliveAudioMidiMessage& m : m_MessageList)
+    {
+        const f64 trackDelay = MidiTimeToSample(m.TimeOffset);
+        switch (m.Type)
+        {
+        case ALIVE_MIDI_NOTE_ON:
+        case ALIVE_MIDI_NOTE_OFF:
+            mSchedule.push_back(ScheduledEvent{ mAliveAudio.mCurrentSampleIndex + DelayToSampleOffset(trackDelay), m.Type, channels[m.Channel], m.Note, m.Velocity });
+            if (firstNote && m.Type == ALIVE_MIDI_NOTE_ON)
+            {
+                m_SongBeginSample = static_cast<int>(mAliveAudio.mCurrentSampleIndex + trackDelay);
+                firstNote = false;
+            }
+            break;
+        case ALIVE_MIDI_PROGRAM_CHANGE:
+            channels[m.Channel] = m.Special;
+            break;
+        case ALIVE_MIDI_ENDTRACK:
+            m_PlayerState = ALIVE_SEQUENCER_PLAYING;
+            m_SongFinishSample = static_cast<Uint64>(mAliveAudio.mCurrentSampleIndex + trackDelay);
+            break;
+        }
+    }
+
+    // A note off only stops the voices started before it, so on the same sample it goes first
+    std::stable_sort(mSchedule.begin(), mSchedule.end(), [](const ScheduledEvent& a, const ScheduledEvent& b)
+    {
+        return a.mSample < b.mSample || (a.mSample == b.mSample && a.mType == ALIVE_MIDI_NOTE_OFF && b.mType == ALIVE_MIDI_NOTE_ON);
+    });
 }
 
 // TODO: This thread spin locks
@@ -54,9 +109,13 @@ void SequencePlayer::Update()
 {
     int channels[16] = {};
 
-    std::lock_guard<std::mutex> lock(mMutex);
+    auto lock = Lock();
 
-    if (m_PlayerState == ALIVE_SEQUENCER_INIT_VOICES)
+    if (m_PlayerState == ALIVE_SEQUENCER_INIT_VOICES && mOffline)
+    {
+        ScheduleEvents();
+    }
+    else if (m_PlayerState == ALIVE_SEQUENCER_INIT_VOICES)
     {
         bool firstNote = true;
 
@@ -112,18 +171,56 @@ void SequencePlayer::Update()
 
 bool SequencePlayer::AtEnd() const
 {
-    std::lock_guard<std::mutex> lock(mMutex);
+    auto lock = Lock();
 
     return m_PlayerState == ALIVE_SEQUENCER_FINISHED && mAliveAudio.NumberOfActiveVoices() == 0;
 }
 
 void SequencePlayer::Play(f32* stream, u32 len)
 {
+    if (mOffline)
+    {
+        PlayOffline(stream, len);
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mMutex);
 
     mAliveAudio.Play(stream, len);
 }
 
+void SequencePlayer::PlayOffline(f32* stream, u32 len)
+{
+    u32 rendered = 0;
+    while (rendered < len)
+    {
+        // Start and stop everything that is due and then render up to the next event
+        const u64 sample = mAliveAudio.mCurrentSampleIndex;
+        for (; mNextEvent < mSchedule.size() && mSchedule[mNextEvent].mSample <= sample; mNextEvent++)
+        {
+            const ScheduledEvent& event = mSchedule[mNextEvent];
+            if (event.mType == ALIVE_MIDI_NOTE_ON)
+            {
+                mAliveAudio.NoteOn(event.mProgram, event.mNote, event.mVelocity);
+            }
+            else
+            {
+                mAliveAudio.NoteOff(event.mProgram, event.mNote);
+            }
+        }
+
+        // Both channels of each sample
+        u32 toRender = len - rendered;
+        if (mNextEvent < mSchedule.size())
+        {
+            toRender = static_cast<u32>(std::min<u64>(toRender, (mSchedule[mNextEvent].mSample - sample) * 2));
+        }
+
+        mAliveAudio.Play(stream + rendered, toRender);
+        rendered += toRender;
+    }
+}
+
 u64 SequencePlayer::GetPlaybackPositionSample()
 {
 
@@ -132,6 +229,16 @@ u64 SequencePlayer::GetPlaybackPositionSample()
 
 void SequencePlayer::StopSequence()
 {
+    if (mOffline)
+    {
+        // Not played by the audio thread
+        mAliveAudio.ClearAllTrackVoices();
+        m_PlayerState = ALIVE_SEQUENCER_STOPPED;
+        m_PrevBar = 0;
+        mNextEvent = mSchedule.size();
+        return;
+    }
+
     // Ensure the audio thread isn't in Play()
     std::lock_guard<std::mutex> lock(mMutex);
 
@@ -147,14 +254,14 @@ void SequencePlayer::StopSequence()
 
 void SequencePlayer::NoteOnSingleShot(int program, int note, char velocity, f64 trackDelay, f64 pitch)
 {
-    std::lock_guard<std::mutex> lock(mMutex);
+    auto lock = Lock();
     m_PlayerState = ALIVE_SEQUENCER_FINISHED;
     mAliveAudio.NoteOn(program, note, velocity, trackDelay, pitch, true);
 }
 
 void SequencePlayer::PlaySequence()
 {
-    std::lock_guard<std::mutex> lock(mMutex);
+    auto lock = Lock();
     if (m_PlayerState == ALIVE_SEQUENCER_STOPPED || m_PlayerState == ALIVE_SEQUENCER_FINISHED)
     {
         m_PrevBar = 0;
@@ -2,52 +2,88 @@
 #include "oddlib/stream.hpp"
 #include "logger.hpp"
 #include <array>
+#include <cstring>
+#include <cassert>
 
 namespace Oddlib
 {
-    void Path::Point16::Read(IStream& stream)
+    void Path::CollisionItems::Resize(u32 count)
     {
-        stream.Read(mX);
-        stream.Read(mY);
+        mP1X.resize(count);
+        mP1Y.resize(count);
+        mP2X.resize(count);
+        mP2Y.resize(count);
+        mType.resize(count);
+        mLinkPrevious.resize(count);
+        mLinkNext.resize(count);
+        mOptionalLinkPrevious.resize(count);
+        mOptionalLinkNext.resize(count);
+        mLineLength.resize(count);
     }
 
-    void Path::Links::Read(IStream& stream)
+    Path::CollisionItem Path::CollisionItems::At(u32 index) const
     {
-        stream.Read(mPrevious);
-        stream.Read(mNext);
+        CollisionItem item = {};
+        item.mP1 = { mP1X[index], mP1Y[index] };
+        item.mP2 = { mP2X[index], mP2Y[index] };
+        item.mType = mType[index];
+        item.mLinks[0] = { mLinkPrevious[index], mLinkNext[index] };
+        item.mLinks[1] = { mOptionalLinkPrevious[index], mOptionalLinkNext[index] };
+        item.mLineLength = mLineLength[index];
+        return item;
     }
 
-    void Path::CollisionItem::Read(IStream& stream)
+    Path::Path( const std::string& musicThemeName,
+                IStream& pathChunkStream,
+                u32 collisionDataOffset,
+                u32 objectIndexTableOffset,
+                u32 objectDataOffset,
+                u32 mapXSize, u32 mapYSize,
+                bool isAo)
+     : Path(musicThemeName, IStream::ReadAll(pathChunkStream), collisionDataOffset, objectIndexTableOffset, objectDataOffset, mapXSize, mapYSize, isAo)
     {
-        mP1.Read(stream);
-        mP2.Read(stream);
-        stream.Read(mType);
-        mLinks[0].Read(stream);
-        mLinks[1].Read(stream);
-        stream.Read(mLineLength);
+
     }
 
     Path::Path( const std::string& musicThemeName,
-                IStream& pathChunkStream,
+                std::vector<u8>&& pathChunkData,
                 u32 collisionDataOffset,
                 u32 objectIndexTableOffset,
                 u32 objectDataOffset,
                 u32 mapXSize, u32 mapYSize,
                 bool isAo)
-     : mMusicThemeName(musicThemeName), mXSize(mapXSize), mYSize(mapYSize), mIsAo(isAo)
+     : mMusicThemeName(musicThemeName), mXSize(mapXSize), mYSize(mapYSize), mData(std::move(pathChunkData)), mIsAo(isAo)
     {
         TRACE_ENTRYEXIT;
-        ReadPath(pathChunkStream, collisionDataOffset, objectIndexTableOffset, objectDataOffset);
+        ReadPath(collisionDataOffset, objectIndexTableOffset, objectDataOffset);
+    }
+
+    template<class T>
+    T Path::ReadAt(u32 pos) const
+    {
+        // Callers must have already called CheckBounds() for the range being read
+        static_assert(std::is_fundamental<T>::value, "Can only read fundamental types");
+        T ret;
+        std::memcpy(&ret, mData.data() + pos, sizeof(T));
+        return ret;
     }
 
-    void Path::ReadPath(IStream& stream, u32 collisionDataOffset, u32 objectIndexTableOffset, u32 objectDataOffset)
+    void Path::CheckBounds(u32 pos, u32 size, const char* what) const
     {
-        ReadCameraArray(stream);
+        const size_t dataSize = mData.size();
+        if (pos > dataSize || dataSize - pos < size)
+        {
+            throw InvalidPath(std::string(what) + " at " + std::to_string(pos) + " of size " + std::to_string(size) + " is outside of the path data (" + std::to_string(dataSize) + " bytes)");
+        }
+    }
+
+    void Path::ReadPath(u32 collisionDataOffset, u32 objectIndexTableOffset, u32 objectDataOffset)
+    {
+        const u32 pos = ReadCameraArray();
 
         if (collisionDataOffset != 0)
         {
-            //pathChunkStream.BinaryDump("PATH.DUMP");
-            assert(stream.Pos() + 16 == collisionDataOffset);
+            assert(pos + 16 == collisionDataOffset);
         }
 
         // TODO: Psx data != pc data for Ao
@@ -56,10 +92,15 @@ namespace Oddlib
 
         if (collisionDataOffset != 0)
         {
+            if (objectDataOffset < collisionDataOffset)
+            {
+                throw InvalidPath("Object data offset " + std::to_string(objectDataOffset) + " is before the collision data offset " + std::to_string(collisionDataOffset));
+            }
+
             const u32 numCollisionDataBytes = objectDataOffset - collisionDataOffset;
             const u32 numCollisionItems = numCollisionDataBytes / kCollisionItemSize;
-            ReadCollisionItemArray(stream, numCollisionItems);
-            ReadMapObjectsArray(stream, objectIndexTableOffset);
+            ReadCollisionItemArray(pos, numCollisionItems);
+            ReadMapObjectsArray(pos + (numCollisionItems * kCollisionItemSize), objectIndexTableOffset);
         }
     }
 
@@ -78,7 +119,7 @@ namespace Oddlib
         if (x >= XSize() || y >= YSize())
         {
             LOG_ERROR("Out of bounds x:y"
-                << std::to_string(x) << " " << std::to_string(y) <<" vs " 
+                << std::to_string(x) << " " << std::to_string(y) <<" vs "
                 << std::to_string(XSize()) << " " << std::to_string(YSize()));
             abort();
         }
@@ -86,105 +127,96 @@ namespace Oddlib
         return mCameras[(y * XSize()) + x];
     }
 
-    void Path::ReadCameraArray(IStream& stream)
+    u32 Path::ReadCameraArray()
     {
+        const u32 kCameraNameSize = 8;
         const u32 numberOfCameras = XSize() * YSize();
-        mCameras.reserve(numberOfCameras);
+        CheckBounds(0, numberOfCameras * kCameraNameSize, "Camera array");
 
+        mCameras.reserve(numberOfCameras);
         for (u32 i = 0; i < numberOfCameras; i++)
         {
-            ReadCamera(stream);
+            std::string tmpStr(reinterpret_cast<const char*>(mData.data() + (i * kCameraNameSize)), kCameraNameSize);
+            if (tmpStr[0] != 0)
+            {
+                tmpStr += ".CAM";
+            }
+            mCameras.emplace_back(std::move(tmpStr));
         }
+        return numberOfCameras * kCameraNameSize;
     }
 
-    void Path::ReadCamera(IStream& stream)
+    void Path::ReadCollisionItemArray(u32 pos, u32 numberOfCollisionItems)
     {
-        std::array<char, 8> nameBuffer;
-        stream.Read(nameBuffer);
-        std::string tmpStr(nameBuffer.data(), nameBuffer.size());
-        if (tmpStr[0] != 0)
-        {
-            tmpStr += ".CAM";
-        }
-        mCameras.emplace_back(Camera(std::move(tmpStr)));
-    }
+        CheckBounds(pos, numberOfCollisionItems * kCollisionItemSize, "Collision item array");
 
-    void Path::ReadCollisionItemArray(IStream& stream, u32 numberOfCollisionItems)
-    {
-        mCollisionItems.resize(numberOfCollisionItems);
+        mCollisionItems.Resize(numberOfCollisionItems);
         for (u32 i = 0; i < numberOfCollisionItems; i++)
         {
-            mCollisionItems[i].Read(stream);
-        }
-    }
-
-    std::vector<u32> Path::ReadOffsetsToPerCameraObjectLists(IStream& stream, u32 objectIndexTableOffset)
-    {
-        // TODO -16 is for the chunk header, probably shouldn't have this already included in the
-        // pathdb, may also apply to collision info
-        stream.Seek(objectIndexTableOffset - 16);
-
-        const u32 numberOfCameras = XSize() * YSize();
-        std::vector<u32> cameraObjectOffsets;
-        cameraObjectOffsets.reserve(numberOfCameras);
-        for (u32 i = 0; i < numberOfCameras; i++)
-        {
-            u32 offset = 0;
-            stream.Read(offset);
-            cameraObjectOffsets.push_back(offset);
+            const u32 itemPos = pos + (i * kCollisionItemSize);
+            mCollisionItems.mP1X[i] = ReadAt<u16>(itemPos + 0);
+            mCollisionItems.mP1Y[i] = ReadAt<u16>(itemPos + 2);
+            mCollisionItems.mP2X[i] = ReadAt<u16>(itemPos + 4);
+            mCollisionItems.mP2Y[i] = ReadAt<u16>(itemPos + 6);
+            mCollisionItems.mType[i] = ReadAt<u16>(itemPos + 8);
+            mCollisionItems.mLinkPrevious[i] = ReadAt<s16>(itemPos + 10);
+            mCollisionItems.mLinkNext[i] = ReadAt<s16>(itemPos + 12);
+            mCollisionItems.mOptionalLinkPrevious[i] = ReadAt<s16>(itemPos + 14);
+            mCollisionItems.mOptionalLinkNext[i] = ReadAt<s16>(itemPos + 16);
+            mCollisionItems.mLineLength[i] = ReadAt<u16>(itemPos + 18);
         }
-
-        return cameraObjectOffsets;
     }
 
-    void Path::ReadMapObject(IStream& stream, Path::MapObject& mapObject)
+    u32 Path::ReadMapObject(u32 pos, Path::MapObject& mapObject) const
     {
-        stream.Read(mapObject.mFlags);
-        stream.Read(mapObject.mLength);
-        stream.Read(mapObject.mType);
+        // Ao has an extra unknown u32 after the TLV and duplicates the first XY of the rect
+        const u32 headerSize = static_cast<u32>(sizeof(u16) * (mIsAo ? 12 : 8));
+        CheckBounds(pos, headerSize, "Map object header");
 
-        LOG_INFO("Object TLV: " << mapObject.mType << " " << mapObject.mLength << " " << mapObject.mLength);
+        mapObject.mFlags = ReadAt<u16>(pos + 0);
+        mapObject.mLength = ReadAt<u16>(pos + 2);
+        mapObject.mType = ReadAt<u32>(pos + 4);
 
+        u32 rectPos = pos + 8;
         if (mIsAo)
         {
-            // Don't know what this is for
-            u32 unknownData = 0;
-            stream.Read(unknownData);
+            rectPos += sizeof(u32);
         }
 
+        mapObject.mRectTopLeft.mX = ReadAt<u16>(rectPos + 0);
+        mapObject.mRectTopLeft.mY = ReadAt<u16>(rectPos + 2);
+        rectPos += sizeof(u32);
 
-        stream.Read(mapObject.mRectTopLeft.mX);
-        stream.Read(mapObject.mRectTopLeft.mY);
-
-        // Ao duplicated the first two parts of data for some reason
         if (mIsAo)
         {
-            u32 duplicatedXY = 0;
-            stream.Read(duplicatedXY);
+            rectPos += sizeof(u32);
         }
 
-        stream.Read(mapObject.mRectBottomRight.mX);
-        stream.Read(mapObject.mRectBottomRight.mY);
+        mapObject.mRectBottomRight.mX = ReadAt<u16>(rectPos + 0);
+        mapObject.mRectBottomRight.mY = ReadAt<u16>(rectPos + 2);
+
+        mapObject.mDataOffset = pos + headerSize;
+        mapObject.mDataSize = 0;
 
         if (mapObject.mLength > 0)
         {
-            const u32 len = mapObject.mLength - (sizeof(u16) * (mIsAo ? 12 : 8));
-            if (len > 512)
+            if (mapObject.mLength < headerSize)
             {
-                LOG_ERROR("Map object data length " << mapObject.mLength << " is larger than fixed size");
-                abort();
+                throw InvalidPath("Map object length " + std::to_string(mapObject.mLength) + " is smaller than its header at " + std::to_string(pos));
             }
-            stream.ReadBytes(mapObject.mData.data(), len);
+            mapObject.mDataSize = mapObject.mLength - headerSize;
+            CheckBounds(mapObject.mDataOffset, mapObject.mDataSize, "Map object data");
         }
 
+        return mapObject.mDataOffset + mapObject.mDataSize;
     }
 
-    void Path::ReadMapObjectsForCamera(IStream& stream, Camera& camera)
+    void Path::ReadMapObjectsForCamera(u32 pos, Camera& camera)
     {
         for (;;)
         {
             MapObject mapObject;
-            ReadMapObject(stream, mapObject);
+            pos = ReadMapObject(pos, mapObject);
             camera.mObjects.emplace_back(mapObject);
             if (mapObject.mFlags & 0x4)
             {
@@ -193,23 +225,30 @@ namespace Oddlib
         }
     }
 
-    void Path::ReadMapObjectsArray(IStream& stream, u32 objectIndexTableOffset)
+    void Path::ReadMapObjectsArray(u32 collisionEndPos, u32 objectIndexTableOffset)
     {
-        const size_t collisionEndPos = stream.Pos();
+        // TODO -16 is for the chunk header, probably shouldn't have this already included in the
+        // pathdb, may also apply to collision info
+        if (objectIndexTableOffset < 16)
+        {
+            throw InvalidPath("Object index table offset " + std::to_string(objectIndexTableOffset) + " is inside the chunk header");
+        }
 
         // Read the pointers to the object list for each camera
-        const std::vector<u32> cameraObjectOffsets = ReadOffsetsToPerCameraObjectLists(stream, objectIndexTableOffset);
-        
+        const u32 tablePos = objectIndexTableOffset - 16;
+        const u32 numberOfCameras = XSize() * YSize();
+        CheckBounds(tablePos, numberOfCameras * static_cast<u32>(sizeof(u32)), "Object index table");
+
         // Now load the objects for each camera
-        for (auto i = 0u; i < cameraObjectOffsets.size(); i++)
+        for (u32 i = 0; i < numberOfCameras; i++)
         {
             // If max u32/-1 then it means there are no objects for this camera
-            const auto objectsOffset = cameraObjectOffsets[i];
+            const u32 objectsOffset = ReadAt<u32>(tablePos + (i * sizeof(u32)));
             if (objectsOffset != 0xFFFFFFFF)
             {
-                stream.Seek(collisionEndPos + objectsOffset);
-                ReadMapObjectsForCamera(stream, mCameras[i]);
+                CheckBounds(collisionEndPos, objectsOffset, "Camera object list");
+                ReadMapObjectsForCamera(collisionEndPos + objectsOffset, mCameras[i]);
             }
         }
     }
-}
\ No newline at end of file
+}
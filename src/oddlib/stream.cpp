@@ -31,6 +31,56 @@ namespace Oddlib
         return new MemoryStream(std::move(streamData));
     }
 
+    SpanStream::SpanStream(const u8* data, size_t size)
+        : mData(data), mSize(size), mName("Span buffer (" + std::to_string(size) + ") bytes")
+    {
+
+    }
+
+    IStream* SpanStream::Clone()
+    {
+        return new MemoryStream(std::vector<u8>(mData, mData + mSize));
+    }
+
+    IStream* SpanStream::Clone(u32 start, u32 size)
+    {
+        if (start > mSize || mSize - start < size)
+        {
+            throw Exception("Sub clone is out of bounds");
+        }
+        return new SpanStream(mData + start, size);
+    }
+
+    void SpanStream::ReadBytes(u8* pDest, size_t destSize)
+    {
+        if (mSize - mPos < destSize)
+        {
+            throw Exception("ReadBytes failure");
+        }
+        std::copy(mData + mPos, mData + mPos + destSize, pDest);
+        mPos += destSize;
+    }
+
+    void SpanStream::WriteBytes(const u8* /*pSrc*/, size_t /*srcSize*/)
+    {
+        throw Exception("WriteBytes not supported on span streams");
+    }
+
+    void SpanStream::Seek(size_t pos)
+    {
+        if (pos > mSize)
+        {
+            throw Exception("Seek get failure");
+        }
+        mPos = pos;
+    }
+
+    std::string SpanStream::LoadAllToString()
+    {
+        mPos = mSize;
+        return std::string(reinterpret_cast<const char*>(mData), mSize);
+    }
+
     FileStream::FileStream(const std::string& fileName, ReadMode mode)
         : mMode(mode)
     {
@@ -0,0 +1,372 @@
+#include "replay.hpp"
+#include "engine.hpp"
+#include "oddlib/stream.hpp"
+#include "oddlib/exceptions.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+    const u32 kReplayMagic = 0x50524C41; // "ALRP"
+    const u32 kReplayVersion = 1;
+
+    enum eChangedFlags : u8
+    {
+        eKeysChanged = 0x0F, // One bit per InputSnapshot::eItemStates
+        eMouseButtonsChanged = 0x10,
+        eMousePositionChanged = 0x20,
+        eActionsChanged = 0x40
+    };
+
+    template<class T>
+    u8 PackItemState(const T& item)
+    {
+        return static_cast<u8>(
+            (item.RawDownState() ? 1 : 0) |
+            (item.IsPressed() ? 2 : 0) |
+            (item.IsReleased() ? 4 : 0) |
+            (item.IsDown() ? 8 : 0));
+    }
+
+    template<class T>
+    void UnpackItemState(u8 packed, T& item)
+    {
+        item.SetRawDownState((packed & 1) != 0);
+        item.SetIsPressed((packed & 2) != 0);
+        item.SetIsReleased((packed & 4) != 0);
+        item.SetIsDown((packed & 8) != 0);
+    }
+}
+
+void InputSnapshot::Capture(const InputState& input)
+{
+    for (u32 i = 0; i < SDL_NUM_SCANCODES; i++)
+    {
+        const InputItemState& key = input.mKeys[i];
+        mKeys[eRawDown][i] = key.RawDownState();
+        mKeys[ePressed][i] = key.IsPressed();
+        mKeys[eReleased][i] = key.IsReleased();
+        mKeys[eDown][i] = key.IsDown();
+    }
+
+    for (size_t i = 0; i < mMouseButtons.size(); i++)
+    {
+        mMouseButtons[i] = PackItemState(input.mMouseButtons[i]);
+    }
+
+    mMouseX = input.mMousePosition.mX;
+    mMouseY = input.mMousePosition.mY;
+
+    const Actions& actions = input.Mapping().GetActions();
+    mActions[eRawDown] = actions.mRawDownState;
+    mActions[ePressed] = actions.mIsPressed;
+    mActions[eReleased] = actions.mIsReleased;
+    mActions[eDown] = actions.mIsDown;
+}
+
+void InputSnapshot::Apply(InputState& input) const
+{
+    for (u32 i = 0; i < SDL_NUM_SCANCODES; i++)
+    {
+        InputItemState& key = input.mKeys[i];
+        key.SetRawDownState(mKeys[eRawDown][i]);
+        key.SetIsPressed(mKeys[ePressed][i]);
+        key.SetIsReleased(mKeys[eReleased][i]);
+        key.SetIsDown(mKeys[eDown][i]);
+    }
+
+    for (size_t i = 0; i < mMouseButtons.size(); i++)
+    {
+        UnpackItemState(mMouseButtons[i], input.mMouseButtons[i]);
+    }
+
+    input.mMousePosition.mX = mMouseX;
+    input.mMousePosition.mY = mMouseY;
+
+    Actions actions = input.Mapping().GetActions();
+    actions.mRawDownState = mActions[eRawDown];
+    actions.mIsPressed = mActions[ePressed];
+    actions.mIsReleased = mActions[eReleased];
+    actions.mIsDown = mActions[eDown];
+    input.Mapping().SetActions(actions);
+}
+
+void InputSnapshot::Write(Oddlib::IStream& stream, const InputSnapshot& previous) const
+{
+    u8 changed = 0;
+    for (u32 i = 0; i < eItemStateCount; i++)
+    {
+        if (mKeys[i] != previous.mKeys[i])
+        {
+            changed |= static_cast<u8>(1 << i);
+        }
+    }
+
+    if (mMouseButtons != previous.mMouseButtons)
+    {
+        changed |= eMouseButtonsChanged;
+    }
+
+    if (mMouseX != previous.mMouseX || mMouseY != previous.mMouseY)
+    {
+        changed |= eMousePositionChanged;
+    }
+
+    if (mActions != previous.mActions)
+    {
+        changed |= eActionsChanged;
+    }
+
+    stream.Write(changed);
+
+    // Keys are written as the list of scan codes that toggled
+    for (u32 i = 0; i < eItemStateCount; i++)
+    {
+        if (changed & (1 << i))
+        {
+            const std::bitset<SDL_NUM_SCANCODES> toggled = mKeys[i] ^ previous.mKeys[i];
+            stream.Write(static_cast<u16>(toggled.count()));
+            for (u16 scanCode = 0; scanCode < SDL_NUM_SCANCODES; scanCode++)
+            {
+                if (toggled[scanCode])
+                {
+                    stream.Write(scanCode);
+                }
+            }
+        }
+    }
+
+    if (changed & eMouseButtonsChanged)
+    {
+        for (u8 button : mMouseButtons)
+        {
+            stream.Write(button);
+        }
+    }
+
+    if (changed & eMousePositionChanged)
+    {
+        stream.Write(mMouseX);
+        stream.Write(mMouseY);
+    }
+
+    if (changed & eActionsChanged)
+    {
+        for (u32 action : mActions)
+        {
+            stream.Write(action);
+        }
+    }
+}
+
+void InputSnapshot::Read(Oddlib::IStream& stream, const InputSnapshot& previous)
+{
+    *this = previous;
+
+    u8 changed = 0;
+    stream.Read(changed);
+
+    for (u32 i = 0; i < eItemStateCount; i++)
+    {
+        if (changed & (1 << i))
+        {
+            u16 count = 0;
+            stream.Read(count);
+            for (u16 j = 0; j < count; j++)
+            {
+                u16 scanCode = 0;
+                stream.Read(scanCode);
+                if (scanCode >= SDL_NUM_SCANCODES)
+                {
+                    throw Oddlib::Exception("Replay contains an invalid scan code: " + std::to_string(scanCode));
+                }
+                mKeys[i].flip(scanCode);
+            }
+        }
+    }
+
+    if (changed & eMouseButtonsChanged)
+    {
+        for (u8& button : mMouseButtons)
+        {
+            stream.Read(button);
+        }
+    }
+
+    if (changed & eMousePositionChanged)
+    {
+        stream.Read(mMouseX);
+        stream.Read(mMouseY);
+    }
+
+    if (changed & eActionsChanged)
+    {
+        for (u32& action : mActions)
+        {
+            stream.Read(action);
+        }
+    }
+}
+
+// ==============================================================
+
+InputRecorder::InputRecorder(std::unique_ptr<Oddlib::IStream> stream)
+    : mStream(std::move(stream))
+{
+
+}
+
+void InputRecorder::Start(const std::string& gameName, u32 seed)
+{
+    if (mStarted)
+    {
+        LOG_WARNING("Input recording already started, ignoring start of " << gameName);
+        return;
+    }
+
+    LOG_INFO("Recording input of " << gameName << " to " << mStream->Name() << " with seed " << seed);
+
+    mStream->Write(kReplayMagic);
+    mStream->Write(kReplayVersion);
+    mStream->Write(seed);
+    mStream->Write(static_cast<u32>(gameName.size()));
+    mStream->Write(gameName);
+    mStarted = true;
+}
+
+void InputRecorder::RecordTick(const InputState& input, u32 stateHash)
+{
+    if (!mStarted)
+    {
+        return;
+    }
+
+    // Already captured when the tick was published
+    const InputSnapshot& snapshot = input.Events().Snapshot();
+    snapshot.Write(*mStream, mPrevious);
+    mStream->Write(stateHash);
+    mPrevious = snapshot;
+    mTickCount++;
+}
+
+// ==============================================================
+
+InputReplayer::InputReplayer(std::unique_ptr<Oddlib::IStream> stream)
+    : mStream(std::move(stream))
+{
+    u32 magic = 0;
+    mStream->Read(magic);
+    if (magic != kReplayMagic)
+    {
+        throw Oddlib::Exception(mStream->Name() + " is not an input recording");
+    }
+
+    u32 version = 0;
+    mStream->Read(version);
+    if (version != kReplayVersion)
+    {
+        throw Oddlib::Exception(mStream->Name() + " is an unsupported input recording version: " + std::to_string(version));
+    }
+
+    mStream->Read(mSeed);
+
+    u32 gameNameLength = 0;
+    mStream->Read(gameNameLength);
+    mGameName.resize(gameNameLength);
+    mStream->Read(mGameName);
+
+    LOG_INFO("Replaying input of " << mGameName << " from " << mStream->Name() << " with seed " << mSeed);
+}
+
+bool InputReplayer::ApplyNextTick(InputState& input)
+{
+    if (mStream->AtEnd())
+    {
+        return false;
+    }
+
+    InputSnapshot snapshot;
+    snapshot.Read(*mStream, mPrevious);
+    mStream->Read(mExpectedHash);
+    snapshot.Apply(input);
+    mPrevious = snapshot;
+    return true;
+}
+
+void InputReplayer::CheckTick(u32 stateHash)
+{
+    if (stateHash != mExpectedHash)
+    {
+        // Only the first divergence is interesting, everything after it will mismatch too
+        if (mMismatchedTickCount == 0)
+        {
+            LOG_ERROR("Replay diverged from the recording at tick " << mTickCount << " expected state hash " << mExpectedHash << " but got " << stateHash);
+        }
+        mMismatchedTickCount++;
+    }
+    mTickCount++;
+}
+
+// ==============================================================
+
+SubsystemTimings& Timings()
+{
+    static SubsystemTimings timings;
+    return timings;
+}
+
+void SubsystemTimings::EndTick()
+{
+    for (u32 i = 0; i < eSubsystemCount; i++)
+    {
+        mTicks[i].push_back(mCurrentTick[i]);
+        mCurrentTick[i] = 0;
+    }
+}
+
+std::string SubsystemTimings::Report() const
+{
+    static const char* kNames[eSubsystemCount] =
+    {
+        "Tick",
+        "GridMap",
+        "MapObjects",
+        "Scripts"
+    };
+
+    const auto toMs = [](u64 ns) { return static_cast<f64>(ns) / 1000000.0; };
+
+    std::stringstream report;
+    report << std::fixed << std::setprecision(3);
+    report << "Ticks: " << mTicks[eTick].size() << "\n";
+    report << std::left << std::setw(12) << "Subsystem"
+        << std::right << std::setw(12) << "Total ms"
+        << std::setw(12) << "Avg ms"
+        << std::setw(12) << "P95 ms"
+        << std::setw(12) << "Max ms" << "\n";
+
+    for (u32 i = 0; i < eSubsystemCount; i++)
+    {
+        std::vector<u64> sorted = mTicks[i];
+        if (sorted.empty())
+        {
+            continue;
+        }
+        std::sort(sorted.begin(), sorted.end());
+
+        u64 total = 0;
+        for (u64 ns : sorted)
+        {
+            total += ns;
+        }
+
+        report << std::left << std::setw(12) << kNames[i]
+            << std::right << std::setw(12) << toMs(total)
+            << std::setw(12) << toMs(total / sorted.size())
+            << std::setw(12) << toMs(sorted[(sorted.size() * 95) / 100])
+            << std::setw(12) << toMs(sorted.back()) << "\n";
+    }
+    return report.str();
+}
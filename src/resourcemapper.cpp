@@ -3,30 +3,33 @@
 #include "oddlib/bits_factory.hpp"
 #include "oddlib/audio/vab.hpp"
 #include <cmath>
+#include <algorithm>
 #include "oddlib/audio/SequencePlayer.h"
 
-Animation::AnimationSetHolder::AnimationSetHolder(std::shared_ptr<Oddlib::LvlArchive> sLvlPtr, std::shared_ptr<Oddlib::AnimationSet> sAnimSetPtr, u32 animIdx) : mLvlPtr(sLvlPtr), mAnimSetPtr(sAnimSetPtr)
-{
-    mAnim = mAnimSetPtr->AnimationAt(animIdx);
-}
-
-const Oddlib::Animation& Animation::AnimationSetHolder::Animation() const
-{
-    return *mAnim;
-}
-
-u32 Animation::AnimationSetHolder::MaxW() const
-{
-    return mAnimSetPtr->MaxW();
-}
-
-u32 Animation::AnimationSetHolder::MaxH() const
-{
-    return mAnimSetPtr->MaxH();
-}
+AnimationClip::AnimationClip(std::shared_ptr<Oddlib::LvlArchive> sLvlPtr, std::shared_ptr<Oddlib::AnimationSet> sAnimSetPtr, u32 animIdx,
+    bool isPsx, bool scaleFrameOffsets, u32 defaultBlendingMode, const std::string& sourceDataSet)
+    : mLvlPtr(sLvlPtr), mAnimSetPtr(sAnimSetPtr), mIsPsx(isPsx), mSourceDataSet(sourceDataSet)
+{
+    const Oddlib::Animation& anim = *mAnimSetPtr->AnimationAt(animIdx);
+    mFps = anim.Fps();
+    mLoopStartFrame = anim.LoopStartFrame();
+    mLoop = anim.Loop();
+    mMaxW = mAnimSetPtr->MaxW();
+    mMaxH = mAnimSetPtr->MaxH();
+
+    const u32 numFrames = static_cast<u32>(anim.NumFrames());
+    mOffX.reserve(numFrames);
+    mOffY.reserve(numFrames);
+    mBoxX.reserve(numFrames);
+    mBoxY.reserve(numFrames);
+    mBoxW.reserve(numFrames);
+    mBoxH.reserve(numFrames);
+    mSurface.reserve(numFrames);
+    for (u32 i = 0; i < numFrames; i++)
+    {
+        AddFrame(anim.GetFrame(i), scaleFrameOffsets);
+    }
 
-Animation::Animation(AnimationSetHolder anim, bool isPsx, bool scaleFrameOffsets, u32 defaultBlendingMode, const std::string& sourceDataSet) : mAnim(anim), mIsPsx(isPsx), mScaleFrameOffsets(scaleFrameOffsets), mSourceDataSet(sourceDataSet)
-{
     switch (defaultBlendingMode)
     {
     case 0:
@@ -42,6 +45,33 @@ Animation::Animation(AnimationSetHolder anim, bool isPsx, bool scaleFrameOffsets
     }
 }
 
+AnimationClip::AnimationClip(const std::vector<Oddlib::Animation::Frame>& frames, u32 fps, u32 maxW, u32 maxH, bool isPsx, bool scaleFrameOffsets)
+    : mFps(fps), mMaxW(maxW), mMaxH(maxH), mIsPsx(isPsx)
+{
+    for (const Oddlib::Animation::Frame& frame : frames)
+    {
+        AddFrame(frame, scaleFrameOffsets);
+    }
+}
+
+void AnimationClip::AddFrame(const Oddlib::Animation::Frame& frame, bool scaleFrameOffsets)
+{
+    mOffX.push_back(scaleFrameOffsets ? static_cast<f32>(frame.mOffX / kPcToPsxScaleFactor) : static_cast<f32>(frame.mOffX));
+    mOffY.push_back(static_cast<f32>(frame.mOffY));
+    mBoxX.push_back(static_cast<f32>(frame.mTopLeft.x));
+    mBoxY.push_back(static_cast<f32>(frame.mTopLeft.y));
+    mBoxW.push_back(static_cast<f32>(std::abs(frame.mTopLeft.x - frame.mBottomRight.x)));
+    mBoxH.push_back(static_cast<f32>(std::abs(frame.mTopLeft.y - frame.mBottomRight.y)));
+    mSurface.push_back(frame.mFrame);
+}
+
+const /*static*/ f32 AnimationClip::kPcToPsxScaleFactor = 1.73913043478f;
+
+Animation::Animation(std::shared_ptr<const AnimationClip> clip) : mClip(clip)
+{
+
+}
+
 s32 Animation::FrameCounter() const
 {
     return mCounter;
@@ -54,18 +84,19 @@ bool Animation::Update()
     if (mCounter >= mFrameDelay)
     {
         ret = true;
-        mFrameDelay = mAnim.Animation().Fps(); // Because mFrameDelay is 1 initially and Fps() can be > 1
+        const s32 numFrames = static_cast<s32>(mClip->NumFrames());
+        mFrameDelay = mClip->Fps(); // Because mFrameDelay is 1 initially and Fps() can be > 1
         mCounter = 0;
         mFrameNum++;
-        if (mFrameNum >= mAnim.Animation().NumFrames())
+        if (mFrameNum >= numFrames)
         {
-            if (mAnim.Animation().Loop())
+            if (mClip->Loop())
             {
-                mFrameNum = mAnim.Animation().LoopStartFrame();
+                mFrameNum = mClip->LoopStartFrame();
             }
             else
             {
-                mFrameNum = mAnim.Animation().NumFrames() - 1;
+                mFrameNum = numFrames - 1;
             }
 
             // Reached the final frame, animation has completed 1 cycle
@@ -73,7 +104,7 @@ bool Animation::Update()
         }
 
         // Are we *on* the last frame?
-        mIsLastFrame = (mFrameNum == mAnim.Animation().NumFrames() - 1);
+        mIsLastFrame = (mFrameNum == numFrames - 1);
     }
     return ret;
 }
@@ -103,10 +134,12 @@ void Animation::Render(AbstractRenderer& rend, bool flipX, int layer, AbstractRe
     msg = s.str();
     */
 
-    const Oddlib::Animation::Frame& frame = mAnim.Animation().GetFrame(mFrameNum == -1 ? 0 : mFrameNum);
+    const AnimationClip& clip = *mClip;
+    const u32 frame = RenderFrame();
+    const SDL_Surface* surface = clip.mSurface[frame];
 
-    f32 xFrameOffset = (mScaleFrameOffsets ? static_cast<f32>(frame.mOffX / kPcToPsxScaleFactor) : static_cast<f32>(frame.mOffX)) * mScale;
-    const f32 yFrameOffset = static_cast<f32>(frame.mOffY) * mScale;
+    f32 xFrameOffset = clip.mOffX[frame] * mScale;
+    const f32 yFrameOffset = clip.mOffY[frame] * mScale;
 
     const f32 xpos = static_cast<f32>(mXPos);
     const f32 ypos = static_cast<f32>(mYPos);
@@ -116,13 +149,13 @@ void Animation::Render(AbstractRenderer& rend, bool flipX, int layer, AbstractRe
         xFrameOffset = -xFrameOffset;
     }
     // Render sprite as textured quad
-    const TextureHandle textureId = rend.CreateTexture(AbstractRenderer::eTextureFormats::eRGBA, frame.mFrame->w, frame.mFrame->h, AbstractRenderer::eTextureFormats::eRGBA, frame.mFrame->pixels, true);
+    const TextureHandle textureId = rend.CreateTexture(AbstractRenderer::eTextureFormats::eRGBA, surface->w, surface->h, AbstractRenderer::eTextureFormats::eRGBA, surface->pixels, true);
     rend.TexturedQuad(
         textureId,
         xpos + xFrameOffset,
         ypos + yFrameOffset,
-        static_cast<f32>(frame.mFrame->w) * (flipX ? -ScaleX() : ScaleX()),
-        static_cast<f32>(frame.mFrame->h) * mScale,
+        static_cast<f32>(surface->w) * (flipX ? -ScaleX() : ScaleX()),
+        static_cast<f32>(surface->h) * mScale,
         layer,
         ColourU8{ 255, 255, 255, 255 },
         AbstractRenderer::eNormal,
@@ -134,35 +167,30 @@ void Animation::Render(AbstractRenderer& rend, bool flipX, int layer, AbstractRe
     {
         // Render bounding box
         const ColourU8 boundingBoxColour{ 255, 0, 255, 255 };
-        const f32 width = static_cast<f32>(std::abs(frame.mTopLeft.x - frame.mBottomRight.x)) * mScale;
+        const f32 width = clip.mBoxW[frame] * mScale;
 
-        const glm::vec4 rectScreen(rend.WorldToScreenRect(xpos + (static_cast<f32>(flipX ? -frame.mTopLeft.x : frame.mTopLeft.x) * mScale),
-            ypos + (static_cast<f32>(frame.mTopLeft.y) * mScale),
+        const glm::vec4 rectScreen(rend.WorldToScreenRect(xpos + ((flipX ? -clip.mBoxX[frame] : clip.mBoxX[frame]) * mScale),
+            ypos + (clip.mBoxY[frame] * mScale),
             flipX ? -width : width,
-            static_cast<f32>(std::abs(frame.mTopLeft.y - frame.mBottomRight.y)) * mScale));
+            clip.mBoxH[frame] * mScale));
 
-        rend.Rect(rectScreen.x, rectScreen.y, rectScreen.z, rectScreen.w,
-            layer,
-            boundingBoxColour,
-            AbstractRenderer::eBlendModes::eNormal,
-            AbstractRenderer::eCoordinateSystem::eScreen);
+        rend.Overlay().Rect(rectScreen.x, rectScreen.y, rectScreen.z, rectScreen.w, boundingBoxColour.To32Bit());
     }
 
     if (Debugging().mAnimDebugStrings)
     {
         // Render frame pos and frame number
         const glm::vec2 xyposScreen(rend.WorldToScreen(glm::vec2(xpos, ypos)));
-        rend.Text(xyposScreen.x, xyposScreen.y,
-            24.0f,
-            (mSourceDataSet
-                + " x: " + std::to_string(xpos)
-                + " y: " + std::to_string(ypos)
-                + " f: " + std::to_string(FrameNumber())
-                ).c_str(),
-            ColourU8{ 255,255,255,255 },
-            AbstractRenderer::eLayers::eFmv,
-            AbstractRenderer::eBlendModes::eNormal,
-            AbstractRenderer::eCoordinateSystem::eScreen);
+        DebugOverlay& overlay = rend.Overlay();
+        overlay.BeginText(xyposScreen.x, xyposScreen.y, 24.0f, ColourU8{ 255,255,255,255 }.To32Bit());
+        overlay.Append(clip.SourceDataSet().c_str());
+        overlay.Append(" x: ");
+        overlay.Append(xpos);
+        overlay.Append(" y: ");
+        overlay.Append(ypos);
+        overlay.Append(" f: ");
+        overlay.Append(FrameNumber());
+        overlay.EndText();
     }
 }
 
@@ -186,22 +214,43 @@ void Animation::Restart()
 
 bool Animation::Collision(s32 x, s32 y) const
 {
-    const Oddlib::Animation::Frame& frame = mAnim.Animation().GetFrame(FrameNumber());
+    const u32 frame = RenderFrame();
+    const SDL_Surface* surface = mClip->mSurface[frame];
 
     // TODO: Refactor rect calcs
-    f32 xpos = mScaleFrameOffsets ? static_cast<f32>(frame.mOffX / kPcToPsxScaleFactor) : static_cast<f32>(frame.mOffX);
-    f32 ypos = static_cast<f32>(frame.mOffY);
+    f32 xpos = mClip->mOffX[frame];
+    f32 ypos = mClip->mOffY[frame];
 
     ypos = mYPos + (ypos * mScale);
     xpos = mXPos + (xpos * mScale);
 
-    f32 w = static_cast<f32>(frame.mFrame->w) * ScaleX();
-    f32 h = static_cast<f32>(frame.mFrame->h) * mScale;
+    f32 w = static_cast<f32>(surface->w) * ScaleX();
+    f32 h = static_cast<f32>(surface->h) * mScale;
 
 
     return PointInRect(x, y, static_cast<s32>(xpos), static_cast<s32>(ypos), static_cast<s32>(w), static_cast<s32>(h));
 }
 
+WorldRect Animation::Bounds(bool flipX) const
+{
+    const u32 frame = RenderFrame();
+    const SDL_Surface* surface = mClip->mSurface[frame];
+
+    f32 xFrameOffset = mClip->mOffX[frame] * mScale;
+    const f32 yFrameOffset = mClip->mOffY[frame] * mScale;
+    if (flipX)
+    {
+        xFrameOffset = -xFrameOffset;
+    }
+
+    // Same rect as Render(), flipping gives a negative width
+    const glm::vec2 p1(static_cast<f32>(mXPos) + xFrameOffset, static_cast<f32>(mYPos) + yFrameOffset);
+    const glm::vec2 p2 = p1 + glm::vec2(
+        static_cast<f32>(surface->w) * (flipX ? -ScaleX() : ScaleX()),
+        static_cast<f32>(surface->h) * mScale);
+    return WorldRect{ glm::min(p1, p2), glm::max(p1, p2) };
+}
+
 void Animation::SetXPos(s32 xpos)
 {
     mXPos = xpos;
@@ -224,12 +273,12 @@ s32 Animation::YPos() const
 
 u32 Animation::MaxW() const
 {
-    return static_cast<u32>(mAnim.MaxW()*ScaleX());
+    return static_cast<u32>(mClip->MaxW()*ScaleX());
 }
 
 u32 Animation::MaxH() const
 {
-    return static_cast<u32>(mAnim.MaxH()*mScale);
+    return static_cast<u32>(mClip->MaxH()*mScale);
 }
 
 s32 Animation::FrameNumber() const
@@ -239,7 +288,7 @@ s32 Animation::FrameNumber() const
 
 u32 Animation::NumberOfFrames() const
 {
-    return mAnim.Animation().NumFrames();
+    return mClip->NumFrames();
 }
 
 void Animation::SetScale(f32 scale)
@@ -250,11 +299,9 @@ void Animation::SetScale(f32 scale)
 f32 Animation::ScaleX() const
 {
     // PC sprites have a bigger width as they are higher resolution
-    return mIsPsx ? (mScale) : (mScale / kPcToPsxScaleFactor);
+    return mClip->IsPsx() ? (mScale) : (mScale / AnimationClip::kPcToPsxScaleFactor);
 }
 
-const /*static*/ f32 Animation::kPcToPsxScaleFactor = 1.73913043478f;
-
 ResourceMapper::ResourceMapper(IFileSystem& fileSystem, 
     const char* dataSetContentsFile,
     const char* animationResourceFile,
@@ -371,6 +418,21 @@ const SoundBankLocation* ResourceMapper::FindSoundBank(const std::string& soundB
     return mSoundResources.FindSoundBank(soundBank);
 }
 
+const SoundBankLocation* ResourceMapper::FindSoundBank(SoundBankId soundBank)
+{
+    return mSoundResources.FindSoundBank(soundBank);
+}
+
+bool ResourceMapper::FindSoundBankId(const std::string& soundBank, SoundBankId& id) const
+{
+    return mSoundResources.FindBankId(soundBank.c_str(), id);
+}
+
+const std::string& ResourceMapper::SoundBankName(SoundBankId soundBank) const
+{
+    return mSoundResources.BankName(soundBank);
+}
+
 ResourceLocator::ResourceLocator(ResourceMapper&& resourceMapper, DataPaths&& dataPaths)
     : mResMapper(std::move(resourceMapper)), mDataPaths(std::move(dataPaths))
 {
@@ -407,12 +469,12 @@ std::future<std::string> ResourceLocator::LocateScript(const std::string& script
     });
 }
 
-std::unique_ptr<ISound> ResourceLocator::DoLoadSoundMusic(const char* resourceName, const DataPaths::FileSystemInfo& fs, const std::string& strSb, const MusicResource& musicRes)
+std::unique_ptr<ISound> ResourceLocator::DoLoadSoundMusic(const char* resourceName, const DataPaths::FileSystemInfo& fs, SoundBankId soundBank, const MusicResource& musicRes)
 {
-    const SoundBankLocation* sbl = mResMapper.FindSoundBank(strSb);
+    const SoundBankLocation* sbl = mResMapper.FindSoundBank(soundBank);
 
     // Only look in this file system if its mapped to the same dataset as what the sound bank lives in
-    if (fs.mDataSetName != sbl->mDataSetName)
+    if (!sbl || fs.mDataSetName != sbl->mDataSetName)
     {
         return nullptr;
     }
@@ -525,9 +587,9 @@ std::future<std::unique_ptr<Vab>> ResourceLocator::LocateVab(const std::string&
     });
 }
 
-std::unique_ptr<ISound> ResourceLocator::DoLoadSoundEffect(const char* resourceName, const DataPaths::FileSystemInfo& fs, const std::string& strSb, const SoundEffectResource& sfxRes, const SoundEffectResourceLocation& sfxResLoc)
+std::unique_ptr<ISound> ResourceLocator::DoLoadSoundEffect(const char* resourceName, const DataPaths::FileSystemInfo& fs, SoundBankId soundBank, const SoundEffectResource& sfxRes, const SoundEffectResourceLocation& sfxResLoc)
 {
-    const SoundBankLocation* sbl = mResMapper.FindSoundBank(strSb);
+    const SoundBankLocation* sbl = mResMapper.FindSoundBank(soundBank);
 
     // Only look in this file system if its mapped to the same dataset as what the sound bank lives in
     if (!sbl || fs.mDataSetName != sbl->mDataSetName)
@@ -593,6 +655,15 @@ std::future<std::unique_ptr<ISound>> ResourceLocator::LocateSound(const std::str
         std::unique_lock<std::mutex> lock(mMutex);
 
         const SoundResource* sr = mResMapper.FindSound(resourceName.c_str());
+
+        // A bank that no sound refers to can't have anything to load
+        SoundBankId explicitSoundBank = 0;
+        const bool hasExplicitSoundBank = !explicitSoundBankName.empty();
+        if (hasExplicitSoundBank && !mResMapper.FindSoundBankId(explicitSoundBankName, explicitSoundBank))
+        {
+            return std::unique_ptr<ISound>();
+        }
+
         for (const DataPaths::FileSystemInfo& fs : mDataPaths.ActiveDataPaths())
         {
             if (fs.mIsMod)
@@ -605,8 +676,8 @@ std::future<std::unique_ptr<ISound>> ResourceLocator::LocateSound(const std::str
                 {
                     if (useMusicRec && !sr->mMusic.mSoundBanks.empty())
                     {
-                        const std::set<std::string>& soundBanks = !explicitSoundBankName.empty() ? std::set<std::string> { explicitSoundBankName } : sr->mMusic.mSoundBanks;
-                        for (const std::string& sb : soundBanks)
+                        const std::vector<SoundBankId>& soundBanks = hasExplicitSoundBank ? std::vector<SoundBankId> { explicitSoundBank } : sr->mMusic.mSoundBanks;
+                        for (SoundBankId sb : soundBanks)
                         {
                             auto ret = DoLoadSoundMusic(resourceName.c_str(), fs, sb, sr->mMusic);
                             if (ret)
@@ -620,14 +691,14 @@ std::future<std::unique_ptr<ISound>> ResourceLocator::LocateSound(const std::str
                     {
                         for (const SoundEffectResourceLocation& loc : sr->mSoundEffect.mSoundBanks)
                         {
-                            const bool explicitSoundBankNameExists = !explicitSoundBankName.empty() && loc.mSoundBanks.find(explicitSoundBankName) != std::end(loc.mSoundBanks);
-                            if (!explicitSoundBankName.empty() && !explicitSoundBankNameExists)
+                            const bool explicitSoundBankExists = hasExplicitSoundBank && std::find(loc.mSoundBanks.begin(), loc.mSoundBanks.end(), explicitSoundBank) != std::end(loc.mSoundBanks);
+                            if (hasExplicitSoundBank && !explicitSoundBankExists)
                             {
                                 break;
                             }
 
-                            const std::set<std::string>& soundBanks = !explicitSoundBankName.empty() ? std::set<std::string> { explicitSoundBankName } : loc.mSoundBanks;
-                            for (const std::string& sb : soundBanks)
+                            const std::vector<SoundBankId>& soundBanks = hasExplicitSoundBank ? std::vector<SoundBankId> { explicitSoundBank } : loc.mSoundBanks;
+                            for (SoundBankId sb : soundBanks)
                             {
                                 auto ret = DoLoadSoundEffect(resourceName.c_str(), fs, sb, sr->mSoundEffect, loc);
                                 if (ret)
@@ -676,8 +747,7 @@ up_future_UP_Path ResourceLocator::LocatePath(const std::string& resourceName)
                                     if (lvlFile)
                                     {
                                         auto chunk = lvlFile->ChunkById(mapping->mId);
-                                        auto stream = chunk->Stream();
-                                        return std::make_unique<Oddlib::Path>(mapping->mMusicTheme, *stream,
+                                        return std::make_unique<Oddlib::Path>(mapping->mMusicTheme, chunk->ReadData(),
                                             mapping->mCollisionOffset,
                                             mapping->mIndexTableOffset,
                                             mapping->mObjectOffset,
@@ -699,11 +769,25 @@ up_future_UP_Path ResourceLocator::LocatePath(const std::string& resourceName)
 
 std::future<std::unique_ptr<Oddlib::IBits>> ResourceLocator::LocateCamera(const std::string& resourceName)
 {
-    LOG_INFO("Requesting camera " << resourceName);
     return std::async(std::launch::async, [=]() 
     {
-        std::unique_lock<std::mutex> lock(mMutex);
-        return DoLocateCamera(resourceName.c_str(), false);
+        CameraStreams streams;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            std::unique_ptr<Oddlib::IBits> cam = DoLocateCamera(resourceName.c_str(), false, &streams);
+            if (cam)
+            {
+                return cam;
+            }
+        }
+
+        // Decoding is most of the work, it's done after unlocking so that camera prefetching
+        // doesn't hold up every other lookup
+        if (streams.mBits)
+        {
+            return Oddlib::MakeBits(*streams.mBits, streams.mFg1.get());
+        }
+        return std::unique_ptr<Oddlib::IBits>();
     });
 }
 
@@ -781,7 +865,7 @@ static void ApplyDelta(SDL_Surface* deltaSurface, SDL_Surface* originalCameraSur
     }
 }
 
-std::unique_ptr<Oddlib::IBits> ResourceLocator::DoLocateCamera(const char* resourceName, bool ignoreMods)
+std::unique_ptr<Oddlib::IBits> ResourceLocator::DoLocateCamera(const char* resourceName, bool ignoreMods, CameraStreams* streams)
 {
     std::string deltaName;
     std::string modName;
@@ -814,7 +898,7 @@ std::unique_ptr<Oddlib::IBits> ResourceLocator::DoLocateCamera(const char* resou
 
             if (fs.mFileSystem->FileExists(deltaName))
             {
-                auto cam = DoLocateCamera(resourceName, true);
+                auto cam = DoLocateCamera(resourceName, true, nullptr);
                 if (cam)
                 {
                     auto originalCameraSurface = cam->GetSurface();
@@ -856,6 +940,12 @@ std::unique_ptr<Oddlib::IBits> ResourceLocator::DoLocateCamera(const char* resou
                             }
 
                             LOG_INFO("Loaded original camera from " << fs.mDataSetName << " has foreground layer: " << (fg1Stream ? "true" : "false"));
+                            if (streams)
+                            {
+                                streams->mBits = std::move(bitsStream);
+                                streams->mFg1 = std::move(fg1Stream);
+                                return nullptr;
+                            }
                             return Oddlib::MakeBits(*bitsStream, fg1Stream.get());
                         }
                     }
@@ -1049,6 +1139,11 @@ const std::vector<SoundBankLocation>& ResourceLocator::GetSoundBankResources() c
     return mResMapper.GetSoundBankResources();
 }
 
+const std::string& ResourceLocator::SoundBankName(SoundBankId soundBank) const
+{
+    return mResMapper.SoundBankName(soundBank);
+}
+
 std::future<const MusicTheme*> ResourceLocator::LocateSoundTheme(const std::string& themeName)
 {
     return std::async(std::launch::async, [=]() 
@@ -1076,6 +1171,14 @@ std::unique_ptr<Animation> ResourceLocator::DoLocateAnimation(const DataPaths::F
                     // Loop through each LVL and see if animFile exists there
                     for (const ResourceMapper::DataSetFileAttributes& dataSetFileAttributes : *fileLocations)
                     {
+                        // Every instance of the same animation shares a clip, so most of the time
+                        // there is nothing more to do than give out another cursor
+                        std::shared_ptr<AnimationClip> clip = mCache.GetAnimClip(resourceName, fs.mDataSetName, dataSetFileAttributes.mLvlName, animFile.mFile, animFile.mId, animFile.mAnimationIndex);
+                        if (clip)
+                        {
+                            return std::make_unique<Animation>(clip);
+                        }
+
                         auto lvlPtr = OpenLvl(*fs.mFileSystem, fs.mDataSetName, dataSetFileAttributes.mLvlName);
                         if (lvlPtr)
                         {
@@ -1107,14 +1210,20 @@ std::unique_ptr<Animation> ResourceLocator::DoLocateAnimation(const DataPaths::F
                                 }
                             }
 
-                            // Construct the animation from the chunk bytes
-                            return std::make_unique<Animation>(
-                                Animation::AnimationSetHolder(lvlPtr, animSetPtr, animFile.mAnimationIndex),
-                                dataSetFileAttributes.mIsPsx,
-                                dataSetFileAttributes.mScaleFrameOffsets,
-                                animMapping.mBlendingMode,
-                                fs.mDataSetName);
-
+                            if (animSetPtr)
+                            {
+                                // Construct the clip from the chunk bytes
+                                clip = mCache.AddAnimClip(std::make_unique<AnimationClip>(
+                                    lvlPtr,
+                                    animSetPtr,
+                                    animFile.mAnimationIndex,
+                                    dataSetFileAttributes.mIsPsx,
+                                    dataSetFileAttributes.mScaleFrameOffsets,
+                                    animMapping.mBlendingMode,
+                                    fs.mDataSetName),
+                                    resourceName, fs.mDataSetName, dataSetFileAttributes.mLvlName, animFile.mFile, animFile.mId, animFile.mAnimationIndex);
+                                return std::make_unique<Animation>(clip);
+                            }
                         }
                     }
                 }
@@ -1165,6 +1274,12 @@ const std::string& BaseSeqSound::Name() const
     return mSoundName;
 }
 
+void BaseSeqSound::CreatePlayer()
+{
+    mSeqPlayer = std::make_unique<SequencePlayer>(mSoundName.c_str(), *mVab);
+    mSeqPlayer->SetOfflineRendering(mOfflineRendering);
+}
+
 SingleSeqSampleSound::SingleSeqSampleSound(const char* soundName, std::unique_ptr<Vab> vab, u32 program, u32 note, u32 minPitch, u32 maxPitch, u32 /*vol*/)
     : BaseSeqSound(soundName, std::move(vab)), mProgram(program), mNote(note), mMinPitch(minPitch), mMaxPitch(maxPitch)
 {
@@ -1178,7 +1293,7 @@ static float RandFloat(float a, float b)
 
 void SingleSeqSampleSound::Load()
 {
-    mSeqPlayer = std::make_unique<SequencePlayer>(mSoundName.c_str(), *mVab);
+    CreatePlayer();
     mSeqPlayer->NoteOnSingleShot(mProgram, mNote, 127, 0.0f, RandFloat(static_cast<f32>(mMinPitch), static_cast<f32>(mMaxPitch)));
 }
 
@@ -1190,7 +1305,7 @@ SeqSound::SeqSound(const char* soundName, std::unique_ptr<Vab> vab, std::unique_
 
 void SeqSound::Load()
 {
-    mSeqPlayer = std::make_unique<SequencePlayer>(mSoundName.c_str(), *mVab);
+    CreatePlayer();
     mSeqPlayer->LoadSequenceStream(*mSeqData);
     mSeqPlayer->PlaySequence();
 }
@@ -5,6 +5,7 @@
 #include "fmv.hpp"
 #include "sound.hpp"
 #include "resourcemapper.hpp"
+#include "replay.hpp"
 
 PlayFmvState::PlayFmvState(IAudioController& audioController, ResourceLocator& locator)
 {
@@ -41,10 +42,10 @@ void PlayFmvState::Play(const char* fmvName)
 
 // ==============================================================
 
-RunGameState::RunGameState(ResourceLocator& locator, AbstractRenderer& renderer)
+RunGameState::RunGameState(ResourceLocator& locator, AbstractRenderer& renderer, IFileSystem& fs)
     : mResourceLocator(locator), mRenderer(renderer), mAnimBrowser(locator)
 {
-    mLevel = std::make_unique<Level>(mResourceLocator);
+    mLevel = std::make_unique<Level>(mResourceLocator, fs);
 
     // Debugging - reload path and load next path
     static std::string currentPathName;
@@ -122,6 +123,16 @@ bool RunGameState::IsLoading() const
     return mState != RunGameStates::eRunning;
 }
 
+u32 RunGameState::StateHashValue() const
+{
+    StateHash hash;
+    if (mLevel)
+    {
+        mLevel->AddToStateHash(hash);
+    }
+    return hash.Value();
+}
+
 void RunGameState::Render()
 {
     mRenderer.Clear(0.4f, 0.4f, 0.4f);
@@ -0,0 +1,176 @@
+#include "scriptallocator.hpp"
+#include <squirrel.h>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+// Note: This is compiled in to squirrel_static rather than AliveLib so that the VM can always
+// resolve its allocation functions. Everything here is POD and never freed so that allocations
+// made during static init or after static destruction of other objects are still valid.
+
+namespace
+{
+    const u32 kSizeClassBytes[ScriptAllocator::kSizeClassCount] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+    const u32 kLargeClass = ScriptAllocator::kSizeClassCount;
+    const u32 kChunkSize = 64 * 1024;
+
+    struct FreeBlock
+    {
+        FreeBlock* mNext;
+    };
+
+    FreeBlock* gFreeLists[ScriptAllocator::kSizeClassCount];
+    ScriptAllocator::Stats gStats;
+
+    u32 SizeClassOf(SQUnsignedInteger size)
+    {
+        // Zero sized requests land in the smallest class, their free passes 0 as well
+        for (u32 i = 0; i < ScriptAllocator::kSizeClassCount; i++)
+        {
+            if (size <= kSizeClassBytes[i])
+            {
+                return i;
+            }
+        }
+        return kLargeClass;
+    }
+
+    bool Grow(u32 sizeClass)
+    {
+        u8* chunk = static_cast<u8*>(malloc(kChunkSize));
+        if (!chunk)
+        {
+            return false;
+        }
+        gStats.mBytesReserved += kChunkSize;
+
+        const u32 blockSize = kSizeClassBytes[sizeClass];
+        const u32 blockCount = kChunkSize / blockSize;
+        for (u32 i = 0; i < blockCount; i++)
+        {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + (i * blockSize));
+            block->mNext = gFreeLists[sizeClass];
+            gFreeLists[sizeClass] = block;
+        }
+        return true;
+    }
+
+    void* PoolAlloc(u32 sizeClass)
+    {
+        if (!gFreeLists[sizeClass] && !Grow(sizeClass))
+        {
+            return nullptr;
+        }
+        FreeBlock* block = gFreeLists[sizeClass];
+        gFreeLists[sizeClass] = block->mNext;
+        gStats.mLiveBlocks[sizeClass]++;
+        return block;
+    }
+
+    void PoolFree(void* p, u32 sizeClass)
+    {
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->mNext = gFreeLists[sizeClass];
+        gFreeLists[sizeClass] = block;
+        gStats.mLiveBlocks[sizeClass]--;
+    }
+}
+
+namespace ScriptAllocator
+{
+    const Stats& GetStats()
+    {
+        return gStats;
+    }
+
+    u32 SizeClassBytes(u32 sizeClass)
+    {
+        return kSizeClassBytes[sizeClass];
+    }
+}
+
+void* sq_vm_malloc(SQUnsignedInteger size)
+{
+    const u32 sizeClass = SizeClassOf(size);
+    void* p = nullptr;
+    if (sizeClass == kLargeClass)
+    {
+        p = malloc(static_cast<size_t>(size));
+        if (p)
+        {
+            gStats.mBytesReserved += size;
+            gStats.mLiveLargeBlocks++;
+        }
+    }
+    else
+    {
+        p = PoolAlloc(sizeClass);
+    }
+
+    if (p)
+    {
+        gStats.mBytesInUse += size;
+        gStats.mAllocations++;
+    }
+    return p;
+}
+
+void sq_vm_free(void* p, SQUnsignedInteger size)
+{
+    if (!p)
+    {
+        return;
+    }
+
+    const u32 sizeClass = SizeClassOf(size);
+    if (sizeClass == kLargeClass)
+    {
+        free(p);
+        gStats.mBytesReserved -= size;
+        gStats.mLiveLargeBlocks--;
+    }
+    else
+    {
+        PoolFree(p, sizeClass);
+    }
+
+    gStats.mBytesInUse -= size;
+    gStats.mFrees++;
+}
+
+void* sq_vm_realloc(void* p, SQUnsignedInteger oldSize, SQUnsignedInteger size)
+{
+    if (!p)
+    {
+        return sq_vm_malloc(size);
+    }
+
+    const u32 oldClass = SizeClassOf(oldSize);
+    const u32 newClass = SizeClassOf(size);
+
+    if (oldClass == newClass && oldClass != kLargeClass)
+    {
+        // Still fits in the same block
+        gStats.mBytesInUse = gStats.mBytesInUse - oldSize + size;
+        return p;
+    }
+
+    if (oldClass == kLargeClass && newClass == kLargeClass)
+    {
+        void* newP = realloc(p, static_cast<size_t>(size));
+        if (newP)
+        {
+            gStats.mBytesReserved = gStats.mBytesReserved - oldSize + size;
+            gStats.mBytesInUse = gStats.mBytesInUse - oldSize + size;
+        }
+        return newP;
+    }
+
+    void* newP = sq_vm_malloc(size);
+    if (newP)
+    {
+        memcpy(newP, p, static_cast<size_t>(std::min(oldSize, size)));
+        sq_vm_free(p, oldSize);
+    }
+    return newP;
+}
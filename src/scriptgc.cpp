@@ -0,0 +1,78 @@
+#include "scriptgc.hpp"
+#include "scriptallocator.hpp"
+#include "imgui/imgui.h"
+#include <chrono>
+#include <algorithm>
+
+ScriptGarbageCollector::ScriptGarbageCollector(HSQUIRRELVM vm)
+    : mVm(vm)
+{
+    mBytesInUseAfterCollection = ScriptAllocator::GetStats().mBytesInUse;
+}
+
+void ScriptGarbageCollector::Step(f32 budgetMs)
+{
+    const u64 bytesInUse = ScriptAllocator::GetStats().mBytesInUse;
+    const u64 growth = bytesInUse > mBytesInUseAfterCollection ? bytesInUse - mBytesInUseAfterCollection : 0;
+    if (growth < kCollectGrowthBytes)
+    {
+        return;
+    }
+
+    if (growth < kForceCollectGrowthBytes && mEstimatedCollectionMs > budgetMs)
+    {
+        mDeferredSteps++;
+        return;
+    }
+
+    if (growth >= kForceCollectGrowthBytes)
+    {
+        mForcedCollections++;
+    }
+
+    Collect();
+}
+
+void ScriptGarbageCollector::Collect()
+{
+    using TClock = std::chrono::high_resolution_clock;
+    const TClock::time_point start = TClock::now();
+
+    mLastCollectedObjects = static_cast<s32>(sq_collectgarbage(mVm));
+
+    mLastCollectionMs = std::chrono::duration<f32, std::milli>(TClock::now() - start).count();
+    mMaxCollectionMs = std::max(mMaxCollectionMs, mLastCollectionMs);
+    mEstimatedCollectionMs = mCollections == 0 ? mLastCollectionMs : (mEstimatedCollectionMs * 0.75f) + (mLastCollectionMs * 0.25f);
+    mCollections++;
+
+    mBytesInUseAfterCollection = ScriptAllocator::GetStats().mBytesInUse;
+}
+
+void ScriptGarbageCollector::DebugUi()
+{
+    if (!ImGui::CollapsingHeader("Script heap"))
+    {
+        return;
+    }
+
+    const ScriptAllocator::Stats& stats = ScriptAllocator::GetStats();
+    ImGui::Text("In use: %.1f KB", static_cast<f32>(stats.mBytesInUse) / 1024.0f);
+    ImGui::Text("Reserved: %.1f KB", static_cast<f32>(stats.mBytesReserved) / 1024.0f);
+    ImGui::Text("Allocations: %llu Frees: %llu", static_cast<unsigned long long>(stats.mAllocations), static_cast<unsigned long long>(stats.mFrees));
+
+    for (u32 i = 0; i < ScriptAllocator::kSizeClassCount; i++)
+    {
+        ImGui::Text("%u byte blocks: %u", ScriptAllocator::SizeClassBytes(i), stats.mLiveBlocks[i]);
+    }
+    ImGui::Text("Large blocks: %u", stats.mLiveLargeBlocks);
+
+    ImGui::Separator();
+    ImGui::Text("Collections: %u (%u forced, %u deferred)", mCollections, mForcedCollections, mDeferredSteps);
+    ImGui::Text("Last: %.3f ms, %d objects", mLastCollectionMs, mLastCollectedObjects);
+    ImGui::Text("Estimate: %.3f ms Max: %.3f ms", mEstimatedCollectionMs, mMaxCollectionMs);
+
+    if (ImGui::Button("Collect now"))
+    {
+        Collect();
+    }
+}
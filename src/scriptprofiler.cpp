@@ -0,0 +1,356 @@
+#include "scriptprofiler.hpp"
+#include "logger.hpp"
+#include "filesystem.hpp"
+#include "oddlib/stream.hpp"
+#include "oddlib/exceptions.hpp"
+#include "jsonxx/jsonxx.h"
+#include "imgui/imgui.h"
+#include <algorithm>
+
+/*static*/ ScriptProfiler* ScriptProfiler::sInstance = nullptr;
+
+ScriptProfiler::ScriptProfiler(HSQUIRRELVM vm, IFileSystem& fs)
+    : mVm(vm), mFs(fs)
+{
+    Reset();
+}
+
+ScriptProfiler::~ScriptProfiler()
+{
+    SetEnabled(false);
+}
+
+void ScriptProfiler::SetEnabled(bool enabled)
+{
+    if (enabled == mEnabled)
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        // The hook has no user data so only one profiler can be active at a time
+        if (sInstance)
+        {
+            LOG_ERROR("Another script profiler is already enabled");
+            return;
+        }
+        sInstance = this;
+        mStack.clear();
+        mLastEventTime = TClock::now();
+        sq_setnativedebughook(mVm, &ScriptProfiler::OnDebugHook);
+    }
+    else
+    {
+        sq_setnativedebughook(mVm, nullptr);
+        sInstance = nullptr;
+
+        // Anything still on the stack won't see its return event
+        for (FunctionStats& function : mFunctions)
+        {
+            function.mActiveCalls = 0;
+        }
+        mStack.clear();
+    }
+    mEnabled = enabled;
+}
+
+void ScriptProfiler::Reset()
+{
+    mFunctions.clear();
+    mFunctionLookup.clear();
+    mStack.clear();
+    mNodes.clear();
+    mNodes.emplace_back();
+    mLastEventTime = TClock::now();
+}
+
+/*static*/ void ScriptProfiler::OnDebugHook(HSQUIRRELVM /*vm*/, SQInteger type, const SQChar* sourceName, SQInteger line, const SQChar* funcName)
+{
+    if (!sInstance)
+    {
+        return;
+    }
+
+    switch (type)
+    {
+    case 'c':
+        sInstance->OnCall(sourceName, funcName);
+        break;
+
+    case 'r':
+        sInstance->OnReturn();
+        break;
+
+    case 'l':
+        sInstance->OnLine(static_cast<s32>(line));
+        break;
+    }
+}
+
+void ScriptProfiler::AttributeElapsed(TClock::time_point now)
+{
+    const u64 elapsedNs = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - mLastEventTime).count());
+    mLastEventTime = now;
+
+    if (mStack.empty())
+    {
+        // Time spent in native code between calls in to the VM
+        return;
+    }
+
+    const Frame& top = mStack.back();
+    mNodes[top.mNode].mExclusiveNs += elapsedNs;
+
+    FunctionStats& function = mFunctions[top.mFunction];
+    function.mExclusiveNs += elapsedNs;
+    if (top.mLine > 0)
+    {
+        function.mLineExclusiveNs[top.mLine] += elapsedNs;
+    }
+}
+
+void ScriptProfiler::OnCall(const SQChar* sourceName, const SQChar* funcName)
+{
+    const TClock::time_point now = TClock::now();
+    AttributeElapsed(now);
+
+    const u32 function = FunctionIndex(sourceName, funcName);
+    const u32 parentNode = mStack.empty() ? 0 : mStack.back().mNode;
+
+    Frame frame = {};
+    frame.mNode = ChildNode(parentNode, function);
+    frame.mFunction = function;
+    frame.mLine = 0;
+    frame.mStartTime = now;
+    mStack.push_back(frame);
+
+    FunctionStats& stats = mFunctions[function];
+    stats.mCalls++;
+    stats.mActiveCalls++;
+}
+
+void ScriptProfiler::OnReturn()
+{
+    const TClock::time_point now = TClock::now();
+    AttributeElapsed(now);
+
+    // Profiling was enabled part way through this call
+    if (mStack.empty())
+    {
+        return;
+    }
+
+    const Frame& top = mStack.back();
+    FunctionStats& stats = mFunctions[top.mFunction];
+    stats.mActiveCalls--;
+    if (stats.mActiveCalls == 0)
+    {
+        stats.mInclusiveNs += static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - top.mStartTime).count());
+    }
+    mStack.pop_back();
+}
+
+void ScriptProfiler::OnLine(s32 line)
+{
+    AttributeElapsed(TClock::now());
+    if (!mStack.empty())
+    {
+        mStack.back().mLine = line;
+    }
+}
+
+u32 ScriptProfiler::FunctionIndex(const SQChar* sourceName, const SQChar* funcName)
+{
+    const char* name = funcName ? funcName : "unknown";
+    const char* source = sourceName ? sourceName : "unknown";
+
+    // Reuse the same key string to avoid allocating on every call
+    mLookupKey.assign(source);
+    mLookupKey += ':';
+    mLookupKey += name;
+
+    auto it = mFunctionLookup.find(mLookupKey);
+    if (it != std::end(mFunctionLookup))
+    {
+        return it->second;
+    }
+
+    const u32 index = static_cast<u32>(mFunctions.size());
+    FunctionStats stats;
+    stats.mName = name;
+    stats.mSource = source;
+    mFunctions.push_back(std::move(stats));
+    mFunctionLookup[mLookupKey] = index;
+    return index;
+}
+
+u32 ScriptProfiler::ChildNode(u32 parentNode, u32 function)
+{
+    for (u32 child : mNodes[parentNode].mChildren)
+    {
+        if (mNodes[child].mFunction == function)
+        {
+            return child;
+        }
+    }
+
+    const u32 index = static_cast<u32>(mNodes.size());
+    CallNode node;
+    node.mFunction = function;
+    mNodes.push_back(std::move(node));
+    mNodes[parentNode].mChildren.push_back(index);
+    return index;
+}
+
+void ScriptProfiler::FoldedStacks(u32 node, const std::string& prefix, std::string& out) const
+{
+    for (u32 child : mNodes[node].mChildren)
+    {
+        const CallNode& childNode = mNodes[child];
+        const FunctionStats& function = mFunctions[childNode.mFunction];
+        const std::string path = prefix + ";" + function.mName + " (" + function.mSource + ")";
+
+        const u64 exclusiveUs = childNode.mExclusiveNs / 1000;
+        if (exclusiveUs > 0)
+        {
+            out += path + " " + std::to_string(exclusiveUs) + "\n";
+        }
+        FoldedStacks(child, path, out);
+    }
+}
+
+bool ScriptProfiler::WriteFile(const std::string& fileName, const std::string& contents) const
+{
+    try
+    {
+        auto stream = mFs.Create(fileName);
+        stream->Write(contents);
+    }
+    catch (const Oddlib::Exception& ex)
+    {
+        LOG_ERROR("Failed to write " << fileName << ": " << ex.what());
+        return false;
+    }
+    return true;
+}
+
+bool ScriptProfiler::DumpFoldedStacks(const std::string& fileName) const
+{
+    std::string out;
+    FoldedStacks(0, "native", out);
+    if (!WriteFile(fileName, out))
+    {
+        return false;
+    }
+    LOG_INFO("Wrote script profile folded stacks to " << fileName);
+    return true;
+}
+
+bool ScriptProfiler::DumpJson(const std::string& fileName) const
+{
+    jsonxx::Array functions;
+    for (const FunctionStats& function : mFunctions)
+    {
+        jsonxx::Array lines;
+        for (const auto& line : function.mLineExclusiveNs)
+        {
+            jsonxx::Object lineObj;
+            lineObj
+                << "line" << static_cast<jsonxx::Number>(line.first)
+                << "exclusive_us" << static_cast<jsonxx::Number>(line.second) / 1000.0;
+            lines << lineObj;
+        }
+
+        jsonxx::Object functionObj;
+        functionObj
+            << "name" << function.mName
+            << "source" << function.mSource
+            << "calls" << static_cast<jsonxx::Number>(function.mCalls)
+            << "inclusive_us" << static_cast<jsonxx::Number>(function.mInclusiveNs) / 1000.0
+            << "exclusive_us" << static_cast<jsonxx::Number>(function.mExclusiveNs) / 1000.0
+            << "lines" << lines;
+        functions << functionObj;
+    }
+
+    jsonxx::Object root;
+    root << "functions" << functions;
+    if (!WriteFile(fileName, root.json() + "\n"))
+    {
+        return false;
+    }
+    LOG_INFO("Wrote script profile to " << fileName);
+    return true;
+}
+
+void ScriptProfiler::DebugUi()
+{
+    if (!ImGui::CollapsingHeader("Script profiler"))
+    {
+        return;
+    }
+
+    bool enabled = mEnabled;
+    if (ImGui::Checkbox("Enabled", &enabled))
+    {
+        SetEnabled(enabled);
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+    {
+        Reset();
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("Dump json"))
+    {
+        DumpJson("{UserDir}/script_profile.json");
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("Dump folded"))
+    {
+        DumpFoldedStacks("{UserDir}/script_profile.folded");
+    }
+
+    // Heaviest functions first
+    std::vector<const FunctionStats*> sorted;
+    sorted.reserve(mFunctions.size());
+    for (const FunctionStats& function : mFunctions)
+    {
+        sorted.push_back(&function);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const FunctionStats* a, const FunctionStats* b)
+    {
+        return a->mExclusiveNs > b->mExclusiveNs;
+    });
+
+    ImGui::Columns(4, "script profile");
+    ImGui::TextUnformatted("Function"); ImGui::NextColumn();
+    ImGui::TextUnformatted("Calls"); ImGui::NextColumn();
+    ImGui::TextUnformatted("Excl ms"); ImGui::NextColumn();
+    ImGui::TextUnformatted("Incl ms"); ImGui::NextColumn();
+    ImGui::Separator();
+
+    const size_t kMaxRows = 30;
+    for (size_t i = 0; i < sorted.size() && i < kMaxRows; i++)
+    {
+        const FunctionStats& function = *sorted[i];
+        ImGui::Text("%s (%s)", function.mName.c_str(), function.mSource.c_str());
+        if (ImGui::IsItemHovered() && !function.mLineExclusiveNs.empty())
+        {
+            ImGui::BeginTooltip();
+            for (const auto& line : function.mLineExclusiveNs)
+            {
+                ImGui::Text("Line %d: %.3f ms", line.first, static_cast<f64>(line.second) / 1000000.0);
+            }
+            ImGui::EndTooltip();
+        }
+        ImGui::NextColumn();
+        ImGui::Text("%u", function.mCalls); ImGui::NextColumn();
+        ImGui::Text("%.3f", static_cast<f64>(function.mExclusiveNs) / 1000000.0); ImGui::NextColumn();
+        ImGui::Text("%.3f", static_cast<f64>(function.mInclusiveNs) / 1000000.0); ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+}
@@ -438,8 +438,9 @@ void Sound::SoundBrowserUi()
                     {
                         if (ImGui::CollapsingHeader("SEQs"))
                         {
-                            for (const std::string& sb : selected->mMusic.mSoundBanks)
+                            for (SoundBankId sbId : selected->mMusic.mSoundBanks)
                             {
+                                const std::string& sb = mLocator.SoundBankName(sbId);
                                 if (ImGui::Selectable(sb.c_str()))
                                 {
                                     auto player = PlaySound(selected->mResourceName, sb, true, false, bUseCache);
@@ -459,8 +460,9 @@ void Sound::SoundBrowserUi()
                         {
                             for (const SoundEffectResourceLocation& sbLoc : selected->mSoundEffect.mSoundBanks)
                             {
-                                for (const std::string& sb : sbLoc.mSoundBanks)
+                                for (SoundBankId sbId : sbLoc.mSoundBanks)
                                 {
+                                    const std::string& sb = mLocator.SoundBankName(sbId);
                                     if (ImGui::Selectable(sb.c_str()))
                                     {
                                         auto player = PlaySound(selected->mResourceName, sb, false, true, bUseCache);
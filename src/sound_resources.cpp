@@ -2,6 +2,7 @@
 #include "jsonxx/jsonxx.h"
 #include "logger.hpp"
 #include <fstream>
+#include <algorithm>
 
 const std::vector<MusicThemeEntry>* MusicTheme::FindEntry(const char* entryName) const
 {
@@ -20,7 +21,7 @@ void SoundResources::ParseSEQ(SoundResource& res, const rapidjson::Value& obj)
     const auto& soundBanksArray = obj["sound_banks"].GetArray();
     for (const auto& soundBank : soundBanksArray)
     {
-        res.mMusic.mSoundBanks.insert(soundBank.GetString());
+        AddBank(res.mMusic.mSoundBanks, soundBank.GetString());
     }
 }
 
@@ -40,12 +41,33 @@ void SoundResources::ParseSample(SoundResource& res, const rapidjson::Value& obj
         const auto& soundBanksArray = locationObject["sound_banks"].GetArray();
         for (const auto& soundBank : soundBanksArray)
         {
-            location.mSoundBanks.insert(soundBank.GetString());
+            AddBank(location.mSoundBanks, soundBank.GetString());
         }
         res.mSoundEffect.mSoundBanks.push_back(location);
     }
 }
 
+SoundBankId SoundResources::InternBank(const std::string& soundBank)
+{
+    SoundBankId id = 0;
+    if (!FindBankId(soundBank.c_str(), id))
+    {
+        id = static_cast<SoundBankId>(mBankNames.size());
+        mBankNames.push_back(soundBank);
+        mBankNameIndex.Insert(static_cast<s32>(id), [&](s32 idx) -> const std::string& { return mBankNames[idx]; });
+    }
+    return id;
+}
+
+void SoundResources::AddBank(std::vector<SoundBankId>& banks, const char* soundBank)
+{
+    const SoundBankId id = InternBank(soundBank);
+    if (std::find(banks.begin(), banks.end(), id) == banks.end())
+    {
+        banks.push_back(id);
+    }
+}
+
 void SoundResources::ParseSoundBanks(const rapidjson::Value& obj)
 {
     SoundBankLocation location;
@@ -152,6 +174,40 @@ void SoundResources::Parse(const std::string& json)
             }
         }
     }
+
+    BuildIndexes();
+}
+
+void SoundResources::BuildIndexes()
+{
+    mSoundIndex.Clear();
+    for (size_t i = 0; i < mSounds.size(); i++)
+    {
+        mSoundIndex.Insert(static_cast<s32>(i), [&](s32 idx) -> const std::string& { return mSounds[idx].mResourceName; });
+    }
+
+    mSoundBankIndex.Clear();
+    for (size_t i = 0; i < mSoundBanks.size(); i++)
+    {
+        mSoundBankIndex.Insert(static_cast<s32>(i), [&](s32 idx) -> const std::string& { return mSoundBanks[idx].mName; });
+    }
+
+    mThemeIndex.Clear();
+    for (size_t i = 0; i < mThemes.size(); i++)
+    {
+        mThemeIndex.Insert(static_cast<s32>(i), [&](s32 idx) -> const std::string& { return mThemes[idx].mName; });
+    }
+
+    mBankLocations.resize(mBankNames.size());
+    for (size_t i = 0; i < mBankNames.size(); i++)
+    {
+        const SoundBankLocation* sbl = FindSoundBank(mBankNames[i]);
+        mBankLocations[i] = sbl ? static_cast<s32>(sbl - mSoundBanks.data()) : NameIndex::kNotFound;
+        if (!sbl)
+        {
+            LOG_WARNING("Sound bank " << mBankNames[i] << " is used by a sound but has no location");
+        }
+    }
 }
 
 void SoundResources::Dump(const std::string& fileName)
@@ -167,9 +223,9 @@ void SoundResources::Dump(const std::string& fileName)
         if (!sndRes.mMusic.mSoundBanks.empty())
         {
             jsonxx::Array musicSoundBanks;
-            for (const std::string& sb : sndRes.mMusic.mSoundBanks)
+            for (SoundBankId sb : sndRes.mMusic.mSoundBanks)
             {
-                musicSoundBanks << sb;
+                musicSoundBanks << BankName(sb);
             }
 
             jsonxx::Object music;
@@ -187,9 +243,9 @@ void SoundResources::Dump(const std::string& fileName)
             {
 
                 jsonxx::Array soundEffectSoundBanks;
-                for (const std::string& sb : loc.mSoundBanks)
+                for (SoundBankId sb : loc.mSoundBanks)
                 {
-                    soundEffectSoundBanks << sb;
+                    soundEffectSoundBanks << BankName(sb);
                 }
 
                 jsonxx::Object locationsObject;
@@ -279,36 +335,38 @@ void SoundResources::Dump(const std::string& fileName)
 
 const SoundResource* SoundResources::FindSound(const char* resourceName) const
 {
-    for (const SoundResource& mr : mSounds)
-    {
-        if (mr.mResourceName == resourceName)
-        {
-            return &mr;
-        }
-    }
-    return nullptr;
+    const s32 idx = mSoundIndex.Find(resourceName, [&](s32 i) -> const std::string& { return mSounds[i].mResourceName; });
+    return idx != NameIndex::kNotFound ? &mSounds[idx] : nullptr;
 }
 
 const SoundBankLocation* SoundResources::FindSoundBank(const std::string& soundBank) const
 {
-    for (const SoundBankLocation& sbl : mSoundBanks)
+    const s32 idx = mSoundBankIndex.Find(soundBank.c_str(), [&](s32 i) -> const std::string& { return mSoundBanks[i].mName; });
+    return idx != NameIndex::kNotFound ? &mSoundBanks[idx] : nullptr;
+}
+
+const SoundBankLocation* SoundResources::FindSoundBank(SoundBankId soundBank) const
+{
+    if (soundBank >= mBankLocations.size() || mBankLocations[soundBank] == NameIndex::kNotFound)
     {
-        if (sbl.mName == soundBank)
-        {
-            return &sbl;
-        }
+        return nullptr;
     }
-    return nullptr;
+    return &mSoundBanks[mBankLocations[soundBank]];
 }
 
-const MusicTheme* SoundResources::FindMusicTheme(const char* themeName) const
+bool SoundResources::FindBankId(const char* soundBank, SoundBankId& id) const
 {
-    for (const MusicTheme& mt : mThemes)
+    const s32 idx = mBankNameIndex.Find(soundBank, [&](s32 i) -> const std::string& { return mBankNames[i]; });
+    if (idx == NameIndex::kNotFound)
     {
-        if (mt.mName == themeName)
-        {
-            return &mt;
-        }
+        return false;
     }
-    return nullptr;
+    id = static_cast<SoundBankId>(idx);
+    return true;
+}
+
+const MusicTheme* SoundResources::FindMusicTheme(const char* themeName) const
+{
+    const s32 idx = mThemeIndex.Find(themeName, [&](s32 i) -> const std::string& { return mThemes[i].mName; });
+    return idx != NameIndex::kNotFound ? &mThemes[idx] : nullptr;
 }
@@ -47,6 +47,7 @@ public:
 
     virtual void Update() override { }
     virtual const std::string& Name() const override { return mName; }
+    virtual void SetOfflineRendering(bool /*offline*/) override { }
 
     virtual void Stop() override
     {
@@ -169,6 +170,9 @@ void SoundCache::AddToMemoryAndDiskCache(std::unique_ptr<ISound> sound, std::ato
 
     // TODO: mod files that are already wav shouldn't be converted - but could still be copied to the cache
 
+    // Each cache job renders its own sound on a loader thread, so it runs as fast as it can
+    // instead of being paced by the audio callback
+    sound->SetOfflineRendering(true);
     sound->Load();
 
     if (quitFlag)
@@ -0,0 +1,147 @@
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "activationregions.hpp"
+#include "mapobjectstore.hpp"
+
+static const glm::vec2 kBlockSize(375.0f, 260.0f);
+
+static MapObjectHandle AddAt(MapObjectStore& store, f32 x, f32 y)
+{
+    const MapObjectHandle handle = store.Add(nullptr, ObjRect{});
+    store.mXPos[store.Index(handle)] = x;
+    store.mYPos[store.Index(handle)] = y;
+    return handle;
+}
+
+TEST(ActivationRegions, WakesObjectsNearTheSubject)
+{
+    MapObjectStore store;
+    const MapObjectHandle sameBlock = AddAt(store, 400.0f, 300.0f);
+    const MapObjectHandle nextBlock = AddAt(store, 800.0f, 10.0f);
+    const MapObjectHandle farAway = AddAt(store, 375.0f * 5, 300.0f);
+    const MapObjectHandle global = AddAt(store, 375.0f * 10, 260.0f * 10);
+    store.mAlwaysActive[store.Index(global)] = 1;
+
+    ActivationRegions activation;
+    activation.Update(store, glm::vec2(380.0f, 270.0f), kBlockSize);
+
+    ASSERT_TRUE(activation.IsAwake(sameBlock));
+    ASSERT_TRUE(activation.IsAwake(nextBlock));
+    ASSERT_FALSE(activation.IsAwake(farAway));
+    ASSERT_TRUE(activation.IsAwake(global));
+
+    ASSERT_EQ(3u, activation.GetStats().mAwake);
+    ASSERT_EQ(1u, activation.GetStats().mAsleep);
+    ASSERT_EQ(1u, activation.GetStats().mAlwaysActive);
+
+    activation.WakeAll(store);
+    ASSERT_TRUE(activation.IsAwake(farAway));
+    ASSERT_EQ(4u, activation.GetStats().mAwake);
+}
+
+TEST(ActivationRegions, HandlesStayCorrectAfterRemoval)
+{
+    MapObjectStore store;
+    const MapObjectHandle removed = AddAt(store, 0.0f, 0.0f);
+    const MapObjectHandle farAway = AddAt(store, 375.0f * 5, 0.0f);
+    const MapObjectHandle near = AddAt(store, 10.0f, 10.0f);
+
+    // Swaps near in to the removed object's index
+    store.Remove(removed);
+
+    ActivationRegions activation;
+    activation.Update(store, glm::vec2(0.0f, 0.0f), kBlockSize);
+    ASSERT_TRUE(activation.IsAwake(near));
+    ASSERT_FALSE(activation.IsAwake(farAway));
+
+    // Not seen by the last Update yet
+    const MapObjectHandle added = AddAt(store, 375.0f * 8, 0.0f);
+    ASSERT_TRUE(activation.IsAwake(added));
+}
+
+TEST(ActivationRegions, SleepTicksAreStaggered)
+{
+    MapObjectHandle a;
+    a.mSlot = 0;
+    MapObjectHandle b;
+    b.mSlot = 1;
+
+    u32 aTicks = 0;
+    for (u32 tick = 0; tick < ActivationRegions::kSleepTickInterval * 4; tick++)
+    {
+        const bool aTicked = ActivationRegions::WantsSleepTick(a, tick);
+        if (aTicked)
+        {
+            aTicks++;
+            ASSERT_FALSE(ActivationRegions::WantsSleepTick(b, tick));
+        }
+    }
+    ASSERT_EQ(4u, aTicks);
+}
+
+// Stands in for the script Update call of an awake object
+static f32 FakeScriptUpdate(MapObjectStore& store, u32 index)
+{
+    f32 v = store.mXPos[index];
+    for (u32 i = 0; i < 200; i++)
+    {
+        v = std::sqrt(v + static_cast<f32>(i));
+    }
+    store.mYPos[index] += v * 0.0f;
+    return v;
+}
+
+TEST(ActivationRegions, Benchmark)
+{
+    using TClock = std::chrono::high_resolution_clock;
+    const u32 kFrames = 60;
+
+    // The same density of objects (about 20 per camera) on ever larger maps
+    for (u32 mapSize : { 10u, 40u, 160u })
+    {
+        MapObjectStore store;
+        std::vector<MapObjectHandle> handles;
+        for (u32 x = 0; x < mapSize; x++)
+        {
+            for (u32 y = 0; y < mapSize / 4 + 1; y++)
+            {
+                for (u32 i = 0; i < 20; i++)
+                {
+                    handles.push_back(AddAt(store,
+                        (x * kBlockSize.x) + (i * 17.0f),
+                        (y * kBlockSize.y) + (i * 11.0f)));
+                }
+            }
+        }
+
+        ActivationRegions activation;
+        const glm::vec2 subject(kBlockSize.x * 2.5f, kBlockSize.y * 0.5f);
+
+        f32 sink = 0.0f;
+        u32 updates = 0;
+        const TClock::time_point start = TClock::now();
+        for (u32 frame = 0; frame < kFrames; frame++)
+        {
+            activation.Update(store, subject, kBlockSize);
+            for (const MapObjectHandle& handle : handles)
+            {
+                if (activation.IsAwake(handle))
+                {
+                    sink += FakeScriptUpdate(store, store.Index(handle));
+                    updates++;
+                }
+            }
+        }
+        const f64 frameMs = std::chrono::duration<f64, std::milli>(TClock::now() - start).count() / kFrames;
+
+        std::cout << store.Count() << " objects: " << updates / kFrames << " updated per frame, "
+            << frameMs << "ms per frame" << std::endl;
+
+        // Only the 3x2 blocks around the subject that exist in the map are awake, whatever its size
+        ASSERT_EQ(20u * 3 * 2, activation.GetStats().mAwake);
+        ASSERT_EQ(store.Count() - (20u * 3 * 2), activation.GetStats().mAsleep);
+        ASSERT_GE(sink, 0.0f);
+    }
+}
@@ -0,0 +1,143 @@
+#include <gmock/gmock.h>
+#include "resourcemapper.hpp"
+#include "mapobject.hpp"
+#include "mapobjectstore.hpp"
+#include "inmemoryfs.hpp"
+
+static SDL_Surface MakeSurface(int w, int h)
+{
+    SDL_Surface surface = {};
+    surface.w = w;
+    surface.h = h;
+    return surface;
+}
+
+// Two frames that differ in every field, the boxes are given bottom right first in the second
+static std::vector<Oddlib::Animation::Frame> MakeFrames(SDL_Surface& first, SDL_Surface& second)
+{
+    return std::vector<Oddlib::Animation::Frame>
+    {
+        { 35, -40, { -10, -38 }, { 12, 0 }, &first },
+        { -17, -36, { 8, -2 }, { -9, -30 }, &second }
+    };
+}
+
+TEST(AnimationClip, OffsetsMatchPcScaling)
+{
+    SDL_Surface first = MakeSurface(20, 10);
+    SDL_Surface second = MakeSurface(30, 15);
+    const std::vector<Oddlib::Animation::Frame> frames = MakeFrames(first, second);
+
+    const AnimationClip pc(frames, 1, 40, 50, false, true);
+    const AnimationClip psx(frames, 1, 40, 50, true, false);
+    ASSERT_EQ(2u, pc.NumFrames());
+    ASSERT_EQ(2u, psx.NumFrames());
+    for (u32 i = 0; i < frames.size(); i++)
+    {
+        // What Animation used to work out on every call
+        ASSERT_FLOAT_EQ(static_cast<f32>(frames[i].mOffX / AnimationClip::kPcToPsxScaleFactor), pc.mOffX[i]);
+        ASSERT_FLOAT_EQ(static_cast<f32>(frames[i].mOffY), pc.mOffY[i]);
+
+        ASSERT_FLOAT_EQ(static_cast<f32>(frames[i].mOffX), psx.mOffX[i]);
+        ASSERT_FLOAT_EQ(static_cast<f32>(frames[i].mOffY), psx.mOffY[i]);
+    }
+
+    // The PC width is scaled down too, the height and y offset aren't
+    Animation anim(std::make_shared<const AnimationClip>(frames, 1, 40, 50, false, true));
+    anim.SetXPos(100);
+    anim.SetYPos(200);
+    anim.SetScale(2.0f);
+    const WorldRect bounds = anim.Bounds(false);
+    const f32 scaleX = 2.0f / AnimationClip::kPcToPsxScaleFactor;
+    ASSERT_FLOAT_EQ(100.0f + (35 / AnimationClip::kPcToPsxScaleFactor) * 2.0f, bounds.mMin.x);
+    ASSERT_FLOAT_EQ(200.0f - 80.0f, bounds.mMin.y);
+    ASSERT_FLOAT_EQ(bounds.mMin.x + 20.0f * scaleX, bounds.mMax.x);
+    ASSERT_FLOAT_EQ(bounds.mMin.y + 20.0f, bounds.mMax.y);
+    ASSERT_EQ(static_cast<u32>(40 * scaleX), anim.MaxW());
+    ASSERT_EQ(100u, anim.MaxH());
+}
+
+TEST(AnimationClip, BoxSizes)
+{
+    SDL_Surface first = MakeSurface(20, 10);
+    SDL_Surface second = MakeSurface(30, 15);
+    const AnimationClip clip(MakeFrames(first, second), 1, 40, 50, false, true);
+
+    // Boxes are never scaled by the clip, and the size is positive whichever way round the corners are
+    ASSERT_EQ(-10.0f, clip.mBoxX[0]);
+    ASSERT_EQ(-38.0f, clip.mBoxY[0]);
+    ASSERT_EQ(22.0f, clip.mBoxW[0]);
+    ASSERT_EQ(38.0f, clip.mBoxH[0]);
+
+    ASSERT_EQ(8.0f, clip.mBoxX[1]);
+    ASSERT_EQ(-2.0f, clip.mBoxY[1]);
+    ASSERT_EQ(17.0f, clip.mBoxW[1]);
+    ASSERT_EQ(28.0f, clip.mBoxH[1]);
+
+    ASSERT_EQ(&first, clip.mSurface[0]);
+    ASSERT_EQ(&second, clip.mSurface[1]);
+}
+
+TEST(Animation, BeforeFirstUpdateUsesFirstFrame)
+{
+    SDL_Surface first = MakeSurface(20, 10);
+    SDL_Surface second = MakeSurface(30, 15);
+    Animation anim(std::make_shared<const AnimationClip>(MakeFrames(first, second), 1, 40, 50, true, false));
+
+    // Frame -1 until the first Update, which is drawn and collided as frame 0
+    ASSERT_EQ(-1, anim.FrameNumber());
+    const WorldRect beforeUpdate = anim.Bounds(false);
+    ASSERT_EQ(100.0f + 35.0f, beforeUpdate.mMin.x);
+    ASSERT_EQ(100.0f - 40.0f, beforeUpdate.mMin.y);
+    ASSERT_EQ(20.0f, beforeUpdate.mMax.x - beforeUpdate.mMin.x);
+    ASSERT_TRUE(anim.Collision(100 + 35, 100 - 40));
+
+    ASSERT_TRUE(anim.Update());
+    ASSERT_EQ(0, anim.FrameNumber());
+    const WorldRect frame0 = anim.Bounds(false);
+    ASSERT_EQ(beforeUpdate.mMin, frame0.mMin);
+    ASSERT_EQ(beforeUpdate.mMax, frame0.mMax);
+
+    ASSERT_TRUE(anim.Update());
+    ASSERT_EQ(1, anim.FrameNumber());
+    ASSERT_EQ(100.0f - 17.0f, anim.Bounds(false).mMin.x);
+
+    // Restarting goes back to -1, which is frame 0 again
+    anim.Restart();
+    ASSERT_EQ(-1, anim.FrameNumber());
+    ASSERT_EQ(frame0.mMin, anim.Bounds(false).mMin);
+}
+
+TEST(MapObject, CurrentAnimationFollowsReallocation)
+{
+    InMemoryFileSystem fs;
+    DataPaths paths(fs, "{GameDir}/data/DataSetIds.json", "{GameDir}/data/DataSets.json");
+    ResourceLocator locator(ResourceMapper(), std::move(paths));
+    MapObjectStore store;
+    MapObject obj(locator, store, ObjRect{});
+
+    SDL_Surface first = MakeSurface(20, 10);
+    SDL_Surface second = MakeSurface(30, 15);
+    const std::vector<Oddlib::Animation::Frame> frames = MakeFrames(first, second);
+    auto walk = std::make_shared<const AnimationClip>(frames, 1, 40, 50, true, false);
+
+    // Play the first animation part way through, as SetAnimation would
+    Animation* current = obj.AddAnimation("Walk", Animation(walk));
+    current->Update();
+    current->Update();
+    store.mAnim[store.Index(obj.Handle())] = current;
+
+    // Enough that the animations have to move
+    const u32 kOthers = 32;
+    Animation* last = nullptr;
+    for (u32 i = 0; i < kOthers; i++)
+    {
+        last = obj.AddAnimation("Other" + std::to_string(i), Animation(std::make_shared<const AnimationClip>(frames, 1, 40, 50, true, false)));
+    }
+
+    // Still the first one, wherever it is now
+    Animation* moved = store.mAnim[store.Index(obj.Handle())];
+    ASSERT_EQ(last - kOthers, moved);
+    ASSERT_EQ(walk.get(), &moved->Clip());
+    ASSERT_EQ(1, moved->FrameNumber());
+}
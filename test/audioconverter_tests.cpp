@@ -0,0 +1,89 @@
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include "audioconverter.hpp"
+#include "resourcemapper.hpp"
+
+// Renders a tone for a fixed number of frames and then silence, like a SEQ that has ended
+class ToneSound : public ISound
+{
+public:
+    explicit ToneSound(u32 numFrames) : mNumFrames(numFrames) { }
+    void Load() override { }
+    void DebugUi() override { }
+    void Restart() override { mFrame = 0; }
+    void Update() override { }
+    void Stop() override { mFrame = mNumFrames; }
+    const std::string& Name() const override { return mName; }
+    void SetOfflineRendering(bool /*offline*/) override { }
+    bool AtEnd() const override { return mFrame >= mNumFrames; }
+
+    void Play(f32* stream, u32 len) override
+    {
+        for (u32 i = 0; i + 1 < len && mFrame < mNumFrames; i += 2, mFrame++)
+        {
+            stream[i] += std::sin(mFrame * 0.01f);
+            stream[i + 1] += 0.5f;
+        }
+    }
+private:
+    u32 mNumFrames;
+    u32 mFrame = 0;
+    std::string mName = "tone";
+};
+
+TEST(AudioConverter, TrimTrailingSilence)
+{
+    std::vector<f32> samples(37, 0.0f);
+    ASSERT_EQ(0u, AudioConverter::TrimTrailingSilence(samples.data(), static_cast<u32>(samples.size())));
+
+    // Sound only in the left channel still keeps the whole frame
+    samples[10] = 1.0f;
+    ASSERT_EQ(12u, AudioConverter::TrimTrailingSilence(samples.data(), static_cast<u32>(samples.size())));
+
+    samples[21] = -0.25f;
+    samples[30] = -0.0f;
+    ASSERT_EQ(22u, AudioConverter::TrimTrailingSilence(samples.data(), static_cast<u32>(samples.size())));
+}
+
+TEST(AudioConverter, Deinterleave)
+{
+    const u32 kFrames = 11;
+    std::vector<f32> samples;
+    for (u32 i = 0; i < kFrames; i++)
+    {
+        samples.push_back(static_cast<f32>(i));
+        samples.push_back(-static_cast<f32>(i));
+    }
+
+    std::vector<f32> left(kFrames);
+    std::vector<f32> right(kFrames);
+    AudioConverter::Deinterleave(samples.data(), kFrames, left.data(), right.data());
+    for (u32 i = 0; i < kFrames; i++)
+    {
+        ASSERT_EQ(static_cast<f32>(i), left[i]);
+        ASSERT_EQ(-static_cast<f32>(i), right[i]);
+    }
+}
+
+TEST(AudioConverter, WavBenchmark)
+{
+    using TClock = std::chrono::high_resolution_clock;
+    const u32 kFrames = 44100 * 60;
+    const char* kFileName = "audioconverter_test.wav";
+
+    std::atomic<bool> quitFlag(false);
+    ToneSound sound(kFrames);
+    const TClock::time_point start = TClock::now();
+    AudioConverter::Convert<WavEncoder>(sound, kFileName, quitFlag);
+    const f64 ms = std::chrono::duration<f64, std::milli>(TClock::now() - start).count();
+    std::cout << "Converted " << kFrames << " frames to wav in " << ms << "ms" << std::endl;
+
+    {
+        Oddlib::FileStream wav(kFileName, Oddlib::IStream::ReadMode::ReadOnly);
+        ASSERT_EQ(sizeof(WavHeader::Header) + (kFrames * sizeof(f32) * 2), wav.Size());
+    }
+    std::remove(kFileName);
+}
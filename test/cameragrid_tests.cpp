@@ -0,0 +1,122 @@
+#include <gmock/gmock.h>
+#include <vector>
+#include "cameragrid.hpp"
+
+// Block, image offset and image size of AE and AO paths, as set up by the GridMap loader
+static const glm::vec2 kAeBlockSize(375.0f, 260.0f);
+static const glm::vec2 kAoBlockSize(1024.0f, 480.0f);
+static const glm::vec2 kAoImageOffset(257.0f, 114.0f);
+static const glm::vec2 kImageSize(368.0f, 240.0f);
+
+static void Fill(CameraGrid<int>& grid, u32 xSize, u32 ySize, const glm::vec2& blockSize, const glm::vec2& imageOffset)
+{
+    grid.Reset(xSize, ySize, blockSize, imageOffset, kImageSize);
+    for (u32 i = 0; i < xSize * ySize; i++)
+    {
+        grid.Add(static_cast<int>(i));
+    }
+}
+
+TEST(CameraGrid, CellAtIsClampedToTheGrid)
+{
+    CameraGrid<int> grid;
+    Fill(grid, 4, 3, kAeBlockSize, glm::vec2(0.0f, 0.0f));
+
+    const CameraGrid<int>::Cell inside = grid.CellAt(glm::vec2(400.0f, 300.0f));
+    ASSERT_EQ(1u, inside.mX);
+    ASSERT_EQ(1u, inside.mY);
+    ASSERT_EQ((1 * 3) + 1, *grid.At(inside));
+
+    // Exactly on a block edge belongs to the next block
+    ASSERT_EQ(1u, grid.CellAt(glm::vec2(375.0f, 0.0f)).mX);
+
+    const CameraGrid<int>::Cell before = grid.CellAt(glm::vec2(-50.0f, -50.0f));
+    ASSERT_EQ(0u, before.mX);
+    ASSERT_EQ(0u, before.mY);
+
+    const CameraGrid<int>::Cell after = grid.CellAt(glm::vec2(100000.0f, 100000.0f));
+    ASSERT_EQ(3u, after.mX);
+    ASSERT_EQ(2u, after.mY);
+
+    CameraGrid<int>::Cell cell = {};
+    ASSERT_FALSE(grid.CellContaining(glm::vec2(-1.0f, 10.0f), cell));
+    ASSERT_FALSE(grid.CellContaining(glm::vec2(375.0f * 4, 10.0f), cell));
+    ASSERT_TRUE(grid.CellContaining(glm::vec2(375.0f * 4 - 1.0f, 10.0f), cell));
+    ASSERT_EQ(3u, cell.mX);
+    ASSERT_EQ(0u, cell.mY);
+}
+
+TEST(CameraGrid, AoImagesAreOffsetInsideTheirBlock)
+{
+    CameraGrid<int> grid;
+    Fill(grid, 3, 3, kAoBlockSize, kAoImageOffset);
+
+    const WorldRect bounds = grid.ImageBounds(1, 2);
+    ASSERT_EQ(1024.0f + 257.0f, bounds.mMin.x);
+    ASSERT_EQ(960.0f + 114.0f, bounds.mMin.y);
+    ASSERT_EQ(1024.0f + 257.0f + 368.0f, bounds.mMax.x);
+    ASSERT_EQ(960.0f + 114.0f + 240.0f, bounds.mMax.y);
+
+    // A position in the block but left of the image still belongs to that block's camera
+    const CameraGrid<int>::Cell cell = grid.CellAt(glm::vec2(1024.0f + 10.0f, 480.0f + 10.0f));
+    ASSERT_EQ(1u, cell.mX);
+    ASSERT_EQ(1u, cell.mY);
+
+    // A rect inside the image of cell (1, 1)
+    const glm::vec2 inside = grid.ImageBounds(1, 1).mMin + glm::vec2(10.0f, 10.0f);
+    const CameraGrid<int>::Range range = grid.CellsOverlapping(WorldRect{ inside, inside + glm::vec2(20.0f, 20.0f) });
+    ASSERT_TRUE(range.Contains(1, 1));
+    ASSERT_FALSE(range.Contains(2, 1));
+    ASSERT_FALSE(range.Contains(1, 2));
+
+    // The rect right of cell 0's image in the gap before cell 1's image can only overlap cell 0
+    const CameraGrid<int>::Range gap = grid.CellsOverlapping(WorldRect{ glm::vec2(700.0f, 200.0f), glm::vec2(800.0f, 220.0f) });
+    ASSERT_EQ(0u, gap.mXStart);
+    ASSERT_EQ(1u, gap.mXEnd);
+
+    // A rect left of every image still overlaps nothing outside of the grid
+    const CameraGrid<int>::Range left = grid.CellsOverlapping(WorldRect{ glm::vec2(-5000.0f, -5000.0f), glm::vec2(-4000.0f, -4000.0f) });
+    ASSERT_EQ(left.mXStart, left.mXEnd);
+    ASSERT_EQ(left.mYStart, left.mYEnd);
+}
+
+TEST(CameraGrid, CellsAroundClampAtTheEdges)
+{
+    CameraGrid<int> grid;
+    Fill(grid, 5, 4, kAoBlockSize, kAoImageOffset);
+
+    const CameraGrid<int>::Range corner = grid.CellsAround(glm::vec2(10.0f, 10.0f), 1);
+    ASSERT_EQ(0u, corner.mXStart);
+    ASSERT_EQ(2u, corner.mXEnd);
+    ASSERT_EQ(0u, corner.mYStart);
+    ASSERT_EQ(2u, corner.mYEnd);
+
+    const CameraGrid<int>::Range middle = grid.CellsAround(glm::vec2(1024.0f * 2.5f, 480.0f * 1.5f), 1);
+    ASSERT_EQ(1u, middle.mXStart);
+    ASSERT_EQ(4u, middle.mXEnd);
+    ASSERT_EQ(0u, middle.mYStart);
+    ASSERT_EQ(3u, middle.mYEnd);
+}
+
+TEST(CameraGrid, ForEachOnlyVisitsAddedCells)
+{
+    CameraGrid<int> grid;
+    grid.Reset(3, 2, kAeBlockSize, glm::vec2(0.0f, 0.0f), kImageSize);
+
+    // Part way through loading the path
+    grid.Add(0);
+    grid.Add(1);
+    grid.Add(2);
+
+    std::vector<int> visited;
+    grid.ForEach(CameraGrid<int>::Range{ 0, 3, 0, 2 }, [&](u32 x, u32 y, int& cell)
+    {
+        ASSERT_EQ(static_cast<int>((x * 2) + y), cell);
+        visited.push_back(cell);
+    });
+    ASSERT_EQ((std::vector<int>{ 0, 1, 2 }), visited);
+
+    ASSERT_EQ(nullptr, grid.At(1, 1));
+    ASSERT_EQ(nullptr, grid.At(0, 2));
+    ASSERT_NE(nullptr, grid.At(1, 0));
+}
@@ -2,6 +2,7 @@
 #include "string_util.hpp"
 #include "resourcemapper.hpp"
 #include "gridmap.hpp"
+#include "collisionlineindex.hpp"
 #include "abstractrenderer.hpp"
 #include <array>
 
@@ -69,4 +70,132 @@ TEST(Collision, NearestHitPointWins)
     ASSERT_TRUE(CollisionLine::RayCast<1>(lines, { 1957, 1090 }, { 1957, 1590 }, { CollisionLine::eFloor }, &hitPoint));
     ASSERT_EQ(hitPoint.intersection.x, 1957);
     ASSERT_EQ(hitPoint.intersection.y, 1140);
+    ASSERT_EQ(1, hitPoint.lineIndex);
+}
+
+TEST(CollisionGraph, FloorsAreJoinedByTheirEnds)
+{
+    CollisionLines lines;
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 100, 200 }, glm::vec2{ 0, 200 }, CollisionLine::eFloor));
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 101, 201 }, glm::vec2{ 200, 300 }, CollisionLine::eFloor));
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 200, 300 }, glm::vec2{ 300, 300 }, CollisionLine::eBackGroundFloor));
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 200, 300 }, glm::vec2{ 200, 400 }, CollisionLine::eWallLeft));
+
+    CollisionGraph graph;
+    graph.Build(lines);
+
+    ASSERT_EQ(1, graph.NextFloorSegment(0, CollisionGraph::eDirection::eRight));
+    ASSERT_EQ(CollisionGraph::kNoLine, graph.NextFloorSegment(0, CollisionGraph::eDirection::eLeft));
+    ASSERT_EQ(0, graph.NextFloorSegment(1, CollisionGraph::eDirection::eLeft));
+
+    // Floors of another type and walls are never joined to
+    ASSERT_EQ(CollisionGraph::kNoLine, graph.NextFloorSegment(1, CollisionGraph::eDirection::eRight));
+    ASSERT_EQ(CollisionGraph::kNoLine, graph.NextFloorSegment(3, CollisionGraph::eDirection::eLeft));
+
+    ASSERT_FLOAT_EQ(100.0f, graph.At(0).mLength);
+    ASSERT_FLOAT_EQ(-1.0f, graph.At(0).mDirection.x);
+    ASSERT_FLOAT_EQ(1.0f, graph.At(1).mSlope);
+    ASSERT_EQ(1u, graph.SnappedJoinCount());
+}
+
+TEST(CollisionGraph, LinksThatDontTouchAreDropped)
+{
+    CollisionLines lines;
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 0, 0 }, glm::vec2{ 100, 0 }, CollisionLine::eTrackLine));
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 100, 0 }, glm::vec2{ 200, 0 }, CollisionLine::eTrackLine));
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 500, 0 }, glm::vec2{ 600, 0 }, CollisionLine::eTrackLine));
+    lines[0]->mLink.mNext = lines[1].get();
+    lines[1]->mLink.mPrevious = lines[0].get();
+    lines[1]->mLink.mNext = lines[2].get();
+
+    CollisionGraph graph;
+    graph.Build(lines);
+
+    ASSERT_EQ(1, graph.At(0).mNext);
+    ASSERT_EQ(0, graph.At(1).mPrevious);
+    ASSERT_EQ(CollisionGraph::kNoLine, graph.At(1).mNext);
+    ASSERT_EQ(1u, graph.BrokenLinkCount());
+}
+
+TEST(CollisionGraph, LinksToLinesNotInThePathAreDropped)
+{
+    CollisionLines lines;
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 0, 0 }, glm::vec2{ 100, 0 }, CollisionLine::eTrackLine));
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 100, 0 }, glm::vec2{ 200, 0 }, CollisionLine::eTrackLine));
+
+    // Would touch line 1, but isn't line 0
+    CollisionLine removed(glm::vec2{ 0, 0 }, glm::vec2{ 100, 0 }, CollisionLine::eTrackLine);
+    lines[1]->mLink.mPrevious = &removed;
+
+    CollisionGraph graph;
+    graph.Build(lines);
+
+    ASSERT_EQ(CollisionGraph::kNoLine, graph.At(1).mPrevious);
+    ASSERT_EQ(1u, graph.BrokenLinkCount());
+}
+
+TEST(CollisionGraph, FloorBelowFollowsTheFloor)
+{
+    CollisionLines lines;
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 0, 100 }, glm::vec2{ 100, 100 }, CollisionLine::eFloor));
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 100, 100 }, glm::vec2{ 200, 110 }, CollisionLine::eFloor));
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 0, 300 }, glm::vec2{ 200, 300 }, CollisionLine::eFloor));
+
+    CollisionGraph graph;
+    graph.Build(lines);
+
+    ASSERT_EQ(0, graph.FloorBelow(0, glm::vec2(50.0f, 100.0f)));
+
+    // Walked on to the slope
+    ASSERT_EQ(1, graph.FloorBelow(0, glm::vec2(150.0f, 104.0f)));
+    ASSERT_FLOAT_EQ(105.0f, graph.YAt(1, 150.0f));
+
+    // Above the floor, off the end of it, or with no floor to start from needs a ray cast
+    ASSERT_EQ(CollisionGraph::kNoLine, graph.FloorBelow(0, glm::vec2(50.0f, 50.0f)));
+    ASSERT_EQ(CollisionGraph::kNoLine, graph.FloorBelow(0, glm::vec2(250.0f, 110.0f)));
+    ASSERT_EQ(CollisionGraph::kNoLine, graph.FloorBelow(CollisionGraph::kNoLine, glm::vec2(50.0f, 100.0f)));
+}
+
+TEST(CollisionLineIndex, QueryFindsLinesTouchingTheRect)
+{
+    CollisionLines lines;
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 10, 10 }, glm::vec2{ 20, 10 }, CollisionLine::eFloor));     // Inside
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ -500, 50 }, glm::vec2{ 900, 50 }, CollisionLine::eFloor));  // Crosses, spans cells
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 300, 0 }, glm::vec2{ 200, 100 }, CollisionLine::eWallLeft)); // Bounds overlap, line doesn't
+    lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ 2000, 2000 }, glm::vec2{ 2100, 2000 }, CollisionLine::eFloor));
+
+    CollisionLineIndex index;
+    index.Build(lines, 64.0f);
+
+    std::vector<s32> found;
+    index.Query(lines, WorldRect{ glm::vec2(0.0f, 0.0f), glm::vec2(220.0f, 60.0f) }, found);
+    ASSERT_EQ((std::vector<s32>{ 0, 1 }), found);
+
+    index.Query(lines, WorldRect{ glm::vec2(1990.0f, 1990.0f), glm::vec2(5000.0f, 5000.0f) }, found);
+    ASSERT_EQ((std::vector<s32>{ 3 }), found);
+
+    index.Query(lines, WorldRect{ glm::vec2(-5000.0f, -5000.0f), glm::vec2(-4000.0f, -4000.0f) }, found);
+    ASSERT_TRUE(found.empty());
+}
+
+TEST(CollisionLineIndex, PickMatchesLinearPick)
+{
+    CollisionLines lines;
+    for (u32 i = 0; i < 50; i++)
+    {
+        const f32 x = static_cast<f32>((i * 37) % 600);
+        const f32 y = static_cast<f32>((i * 53) % 400);
+        lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2{ x, y }, glm::vec2{ x + 80.0f, y + static_cast<f32>(i % 7) * 10.0f }, CollisionLine::eFloor));
+    }
+
+    CollisionLineIndex index;
+    index.Build(lines);
+
+    for (f32 x = -20.0f; x < 700.0f; x += 7.0f)
+    {
+        for (f32 y = -20.0f; y < 500.0f; y += 5.0f)
+        {
+            ASSERT_EQ(CollisionLine::Pick(lines, glm::vec2(x, y), 2.0f), index.Pick(lines, glm::vec2(x, y), 2.0f));
+        }
+    }
 }
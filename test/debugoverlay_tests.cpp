@@ -0,0 +1,39 @@
+#include <gmock/gmock.h>
+#include "debugoverlay.hpp"
+
+TEST(DebugOverlay, Parts)
+{
+    DebugOverlay overlay;
+    overlay.Rect(1.0f, 2.0f, 3.0f, 4.0f, 0xff00ffff);
+
+    overlay.BeginText(10.0f, 20.0f, 24.0f, 0xffffffff);
+    overlay.Append("ABEBLIFT.BAN");
+    overlay.Append(" x: ");
+    overlay.Append(12.5f);
+    overlay.Append(" f: ");
+    overlay.Append(-1);
+    overlay.EndText();
+
+    overlay.BeginText(30.0f, 40.0f, 24.0f, 0xffffffff);
+    overlay.Append(" x: ");
+    overlay.Append(12.5f);
+    overlay.EndText();
+
+    ASSERT_EQ(1u, overlay.RectCount());
+    ASSERT_EQ(2u, overlay.TextCount());
+    ASSERT_EQ(0u, overlay.FirstPart(0));
+    ASSERT_EQ(5u, overlay.FirstPart(1));
+    ASSERT_EQ(7u, overlay.FirstPart(2));
+
+    ASSERT_STREQ("12.500000", overlay.Part(2));
+    ASSERT_STREQ("-1", overlay.Part(4));
+
+    // The same string or number is the same part wherever it is
+    ASSERT_EQ(overlay.mPartKey[1], overlay.mPartKey[5]);
+    ASSERT_EQ(overlay.mPartKey[2], overlay.mPartKey[6]);
+    ASSERT_NE(overlay.mPartKey[1], overlay.mPartKey[3]);
+
+    overlay.Clear();
+    ASSERT_TRUE(overlay.Empty());
+    ASSERT_EQ(0u, overlay.PartCount());
+}
@@ -0,0 +1,105 @@
+#include <gmock/gmock.h>
+#include "framepacer.hpp"
+
+namespace
+{
+    // Microsecond ticks. Reading the time takes a microsecond so that spin waits move forward,
+    // sleeps wake up mOversleepUs late.
+    class FakeClock : public IFrameClock
+    {
+    public:
+        u64 Frequency() const override { return 1000000; }
+        u64 Now() const override { return mNow++; }
+
+        void SleepUs(f32 us) override
+        {
+            mSlept++;
+            mNow += static_cast<u64>(us) + mOversleepUs;
+        }
+
+        void Advance(u64 us) { mNow += us; }
+
+        mutable u64 mNow = 1000;
+        u64 mOversleepUs = 0;
+        u32 mSlept = 0;
+    };
+}
+
+TEST(FramePacer, Pacing)
+{
+    const u32 kFrames = 130;
+
+    FakeClock clock;
+    FramePacer pacer(clock, 60);
+    const f32 initialMarginUs = pacer.SpinMarginUs();
+    const u64 start = clock.mNow;
+    for (u32 i = 0; i < kFrames; i++)
+    {
+        pacer.WaitForNextFrame();
+    }
+    const f32 elapsedMs = (clock.mNow - start) / 1000.0f;
+
+    // The first frame is due straight away, and then one every 1/60th of a second
+    ASSERT_GE(elapsedMs, (kFrames - 1) * pacer.FrameMs());
+    ASSERT_LT(elapsedMs, kFrames * pacer.FrameMs());
+    ASSERT_EQ(kFrames - 1, clock.mSlept);
+
+    // Sleeps that are never late shrink the spin margin, so most of each frame is asleep
+    ASSERT_LT(pacer.SpinMarginUs(), initialMarginUs);
+    const FramePacer::Stats& stats = pacer.LastStats();
+    // The period is rounded down to whole ticks so a second can hold one more
+    ASSERT_NEAR(60.0f, static_cast<f32>(stats.mFrames), 1.0f);
+    ASSERT_EQ(0u, stats.mDroppedFrames);
+    ASSERT_LT(stats.mCpuUsage, 0.1f);
+    ASSERT_LT(stats.mMaxErrorUs, 2.0f);
+}
+
+TEST(FramePacer, MarginGrowsWhenSleepsAreLate)
+{
+    FakeClock clock;
+    FramePacer pacer(clock, 60);
+    pacer.WaitForNextFrame();
+
+    // Later than the margin, so this frame starts late
+    clock.mOversleepUs = 3000;
+    pacer.WaitForNextFrame();
+    ASSERT_GE(pacer.SpinMarginUs(), 3000.0f);
+
+    // But the next ones are on time
+    const u64 due = clock.mNow + static_cast<u64>(pacer.MsUntilNextFrame() * 1000.0f);
+    pacer.WaitForNextFrame();
+    ASSERT_LE(clock.mNow - due, 2u);
+}
+
+TEST(FramePacer, WithoutSleepingSpins)
+{
+    FakeClock clock;
+    FramePacer pacer(clock, 60);
+    pacer.SetSleepEnabled(false);
+    for (u32 i = 0; i < 70; i++)
+    {
+        pacer.WaitForNextFrame();
+    }
+    ASSERT_EQ(0u, clock.mSlept);
+    ASSERT_EQ(1.0f, pacer.LastStats().mCpuUsage);
+}
+
+TEST(FramePacer, DropsMissedFrames)
+{
+    FakeClock clock;
+    FramePacer pacer(clock, 60);
+    pacer.WaitForNextFrame();
+    pacer.WaitForNextFrame();
+
+    // Falling behind by several frames shouldn't cause the next ones to be run back to back
+    clock.Advance(110000);
+    pacer.WaitForNextFrame();
+    ASSERT_NEAR(pacer.FrameMs(), pacer.MsUntilNextFrame(), 0.01f);
+
+    // Counted once the stats cover a second
+    for (u32 i = 0; i < 60; i++)
+    {
+        pacer.WaitForNextFrame();
+    }
+    ASSERT_EQ(5u, pacer.LastStats().mDroppedFrames);
+}
@@ -0,0 +1,75 @@
+#include <gmock/gmock.h>
+#include "fsm.hpp"
+
+// Idle -> Walking while right is held, Walking -> Idle once it is let go
+static void AddWalkStates(FiniteStateMachine& fsm, std::vector<std::string>& animations)
+{
+    fsm.Actions().Add("SetAnimation", [&](FsmArgumentStack& args) { animations.push_back(args.PopString()); });
+
+    FsmState idle("Idle");
+    StateAction idleAnim("SetAnimation");
+    idleAnim.Arguments().Push("Idle");
+    idle.AddEnterAction(idleAnim);
+    FsmStateTransition toWalk("Walking");
+    toWalk.AddCondition(StateCondition("InputRight"));
+    idle.AddTransition(toWalk);
+    fsm.AddState(idle);
+
+    FsmState walking("Walking");
+    StateAction walkAnim("SetAnimation");
+    walkAnim.Arguments().Push("Walk");
+    walking.AddEnterAction(walkAnim);
+    FsmStateTransition toIdle("Idle");
+    toIdle.AddCondition(StateCondition("!InputRight"));
+    walking.AddTransition(toIdle);
+    fsm.AddState(walking);
+}
+
+TEST(FiniteStateMachine, NegatedConditions)
+{
+    bool right = false;
+    std::vector<std::string> animations;
+
+    FiniteStateMachine fsm;
+    fsm.Conditions().Add("InputRight", [&](FsmArgumentStack&) { return right; });
+    AddWalkStates(fsm, animations);
+    ASSERT_TRUE(fsm.Compile());
+    ASSERT_TRUE(fsm.ToState("Idle"));
+
+    fsm.Update();
+    ASSERT_EQ("Idle", fsm.StateName(fsm.ActiveState()));
+
+    right = true;
+    fsm.Update();
+    ASSERT_EQ("Walking", fsm.StateName(fsm.ActiveState()));
+    fsm.Update();
+    ASSERT_EQ("Walking", fsm.StateName(fsm.ActiveState()));
+
+    right = false;
+    fsm.Update();
+    ASSERT_EQ("Idle", fsm.StateName(fsm.ActiveState()));
+    ASSERT_EQ((std::vector<std::string>{ "Idle", "Walk", "Idle" }), animations);
+}
+
+TEST(FiniteStateMachine, MissingNamesFailToCompile)
+{
+    std::vector<std::string> animations;
+
+    FiniteStateMachine fsm;
+    AddWalkStates(fsm, animations);
+
+    FsmState lost("Lost");
+    lost.AddTransition(FsmStateTransition("Nowhere"));
+    fsm.AddState(lost);
+
+    // InputRight was never added and Nowhere isn't a state
+    ASSERT_FALSE(fsm.Compile());
+    ASSERT_TRUE(fsm.ToState("Lost"));
+    fsm.Update();
+    ASSERT_EQ("Lost", fsm.StateName(fsm.ActiveState()));
+
+    // A missing condition fails even when negated, so Walking never goes back to Idle
+    ASSERT_TRUE(fsm.ToState("Walking"));
+    fsm.Update();
+    ASSERT_EQ("Walking", fsm.StateName(fsm.ActiveState()));
+}
@@ -0,0 +1,119 @@
+#include <gmock/gmock.h>
+#include "inputevents.hpp"
+
+static InputSnapshot KeyPressed(SDL_Scancode key)
+{
+    InputSnapshot snapshot;
+    snapshot.mKeys[InputSnapshot::ePressed][key] = true;
+    snapshot.mKeys[InputSnapshot::eDown][key] = true;
+    return snapshot;
+}
+
+TEST(InputEventBus, Edges)
+{
+    InputEventBus bus;
+    InputSnapshot snapshot = KeyPressed(SDL_SCANCODE_E);
+    snapshot.mKeys[InputSnapshot::eReleased][SDL_SCANCODE_A] = true;
+    snapshot.mMouseButtons[1] = 0x2;
+    snapshot.mActions[InputSnapshot::ePressed] = (1u << 3) | (1u << 8);
+    bus.Publish(snapshot);
+
+    const std::vector<InputEvent>& events = bus.Events();
+    ASSERT_EQ(5u, events.size());
+    ASSERT_EQ(InputEvent::eTypes::eKeyPressed, events[0].mType);
+    ASSERT_EQ(static_cast<u32>(SDL_SCANCODE_E), events[0].mCode);
+    ASSERT_EQ(InputEvent::eTypes::eKeyReleased, events[1].mType);
+    ASSERT_EQ(static_cast<u32>(SDL_SCANCODE_A), events[1].mCode);
+    ASSERT_EQ(InputEvent::eTypes::eMouseButtonPressed, events[2].mType);
+    ASSERT_EQ(1u, events[2].mCode);
+    ASSERT_EQ(InputEvent::eTypes::eActionPressed, events[3].mType);
+    ASSERT_EQ(3u, events[3].mCode);
+    ASSERT_EQ(8u, events[4].mCode);
+
+    // Holding a key down isn't an edge
+    InputSnapshot held;
+    held.mKeys[InputSnapshot::eDown][SDL_SCANCODE_E] = true;
+    bus.Publish(held);
+    ASSERT_TRUE(bus.Events().empty());
+}
+
+TEST(InputEventBus, Subscribers)
+{
+    InputEventBus bus;
+    u32 eCount = 0;
+    u32 wCount = 0;
+    InputEventBus::SubscriptionId wId = 0;
+    bus.Subscribe(InputEvent::eTypes::eKeyPressed, SDL_SCANCODE_E, [&](const InputEvent&)
+    {
+        eCount++;
+
+        // Unsubscribing the other handler from within a handler
+        bus.Unsubscribe(wId);
+    });
+    wId = bus.Subscribe(InputEvent::eTypes::eKeyPressed, SDL_SCANCODE_W, [&](const InputEvent&) { wCount++; });
+
+    bus.Publish(KeyPressed(SDL_SCANCODE_W));
+    ASSERT_EQ(0u, eCount);
+    ASSERT_EQ(1u, wCount);
+
+    InputSnapshot both = KeyPressed(SDL_SCANCODE_E);
+    both.mKeys[InputSnapshot::ePressed][SDL_SCANCODE_W] = true;
+    bus.Publish(both);
+    ASSERT_EQ(1u, eCount);
+    ASSERT_EQ(1u, wCount);
+
+    bus.Publish(KeyPressed(SDL_SCANCODE_W));
+    ASSERT_EQ(1u, wCount);
+}
+
+TEST(InputEventBus, SubscribeWhilstDispatching)
+{
+    InputEventBus bus;
+    u32 laterCount = 0;
+    u32 newCount = 0;
+    bus.Subscribe(InputEvent::eTypes::eKeyPressed, SDL_SCANCODE_E, [&](const InputEvent&)
+    {
+        // Enough new edges that the subscriber map rehashes under the dispatch
+        for (u32 key = SDL_SCANCODE_F1; key <= SDL_SCANCODE_F12; key++)
+        {
+            bus.Subscribe(InputEvent::eTypes::eKeyPressed, key, [&](const InputEvent&) { newCount++; });
+            bus.Subscribe(InputEvent::eTypes::eKeyReleased, key, [&](const InputEvent&) { newCount++; });
+        }
+    });
+    bus.Subscribe(InputEvent::eTypes::eKeyPressed, SDL_SCANCODE_E, [&](const InputEvent&) { laterCount++; });
+
+    bus.Publish(KeyPressed(SDL_SCANCODE_E));
+    ASSERT_EQ(1u, laterCount);
+    ASSERT_EQ(0u, newCount);
+
+    bus.Publish(KeyPressed(SDL_SCANCODE_F5));
+    ASSERT_EQ(1u, newCount);
+}
+
+TEST(InputEventBus, History)
+{
+    InputEventBus bus;
+    bus.Publish(KeyPressed(SDL_SCANCODE_SPACE));
+    for (u32 i = 0; i < 3; i++)
+    {
+        bus.Publish(InputSnapshot());
+    }
+
+    ASSERT_EQ(4u, bus.Tick());
+    ASSERT_EQ(4u, bus.HistorySize());
+    ASSERT_TRUE(bus.Snapshot(3).mKeys[InputSnapshot::ePressed][SDL_SCANCODE_SPACE]);
+    ASSERT_FALSE(bus.KeyPressedWithin(SDL_SCANCODE_SPACE, 3));
+    ASSERT_TRUE(bus.KeyPressedWithin(SDL_SCANCODE_SPACE, 4));
+
+    const u32 kHistoryTicks = InputEventBus::kHistoryTicks;
+    InputSnapshot jump;
+    jump.mActions[InputSnapshot::ePressed] = 1u << 8;
+    bus.Publish(jump);
+    for (u32 i = 0; i < kHistoryTicks; i++)
+    {
+        bus.Publish(InputSnapshot());
+    }
+    ASSERT_EQ(kHistoryTicks, bus.HistorySize());
+    ASSERT_TRUE(bus.Snapshot(kHistoryTicks - 1).mKeys[InputSnapshot::ePressed].none());
+    ASSERT_FALSE(bus.ActionPressedWithin(8, 1000));
+}
@@ -0,0 +1,160 @@
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <map>
+#include "mapobjectstore.hpp"
+#include "oddlib/exceptions.hpp"
+
+TEST(MapObjectStore, HandlesSurviveRemoval)
+{
+    MapObjectStore store;
+    const MapObjectHandle a = store.Add(nullptr, ObjRect{ 1, 0, 0, 0 });
+    const MapObjectHandle b = store.Add(nullptr, ObjRect{ 2, 0, 0, 0 });
+    const MapObjectHandle c = store.Add(nullptr, ObjRect{ 3, 0, 0, 0 });
+    store.mXPos[store.Index(c)] = 30.0f;
+
+    store.Remove(a);
+
+    ASSERT_EQ(2u, store.Count());
+    ASSERT_FALSE(store.IsValid(a));
+    ASSERT_TRUE(store.IsValid(b));
+    ASSERT_TRUE(store.IsValid(c));
+    ASSERT_EQ(2, store.mRect[store.Index(b)].x);
+    ASSERT_EQ(3, store.mRect[store.Index(c)].x);
+    ASSERT_EQ(30.0f, store.mXPos[store.Index(c)]);
+}
+
+TEST(MapObjectStore, ReusedSlotInvalidatesOldHandle)
+{
+    MapObjectStore store;
+    const MapObjectHandle a = store.Add(nullptr, ObjRect{});
+    store.Remove(a);
+
+    const MapObjectHandle b = store.Add(nullptr, ObjRect{});
+    ASSERT_EQ(a.mSlot, b.mSlot);
+    ASSERT_FALSE(store.IsValid(a));
+    ASSERT_TRUE(store.IsValid(b));
+    ASSERT_THROW(store.Remove(a), Oddlib::Exception);
+}
+
+TEST(MapObjectStore, TryRemoveStaleHandle)
+{
+    MapObjectStore store;
+    const MapObjectHandle a = store.Add(nullptr, ObjRect{});
+    const MapObjectHandle b = store.Add(nullptr, ObjRect{});
+    ASSERT_TRUE(store.TryRemove(a));
+
+    // Doesn't throw, and leaves the others alone
+    ASSERT_FALSE(store.TryRemove(a));
+    ASSERT_FALSE(store.TryRemove(MapObjectHandle()));
+    ASSERT_EQ(1u, store.Count());
+    ASSERT_TRUE(store.IsValid(b));
+}
+
+TEST(MapObjectStore, DrawsParentsThenChildren)
+{
+    MapObjectStore store;
+    const MapObjectHandle a = store.Add(nullptr, ObjRect{});
+    const MapObjectHandle b = store.Add(nullptr, ObjRect{});
+    const MapObjectHandle c = store.Add(nullptr, ObjRect{});
+
+    // Children added later still draw straight after their parent
+    const MapObjectHandle aChild = store.Add(nullptr, ObjRect{}, a);
+    const MapObjectHandle aGrandChild = store.Add(nullptr, ObjRect{}, aChild);
+    const MapObjectHandle bChild = store.Add(nullptr, ObjRect{}, b);
+    const MapObjectHandle aChild2 = store.Add(nullptr, ObjRect{}, a);
+    ASSERT_EQ((std::vector<u32>{ a.mSlot, aChild.mSlot, aGrandChild.mSlot, aChild2.mSlot, b.mSlot, bChild.mSlot, c.mSlot }), store.DrawOrder());
+
+    // Removal moves the last object in to the hole but doesn't change the order
+    store.Remove(a);
+    store.Remove(aChild);
+    store.Remove(aGrandChild);
+    store.Remove(aChild2);
+    ASSERT_EQ((std::vector<u32>{ b.mSlot, bChild.mSlot, c.mSlot }), store.DrawOrder());
+
+    // A reused slot is ordered by when it was added, not by where it was
+    const MapObjectHandle d = store.Add(nullptr, ObjRect{});
+    const MapObjectHandle cChild = store.Add(nullptr, ObjRect{}, c);
+    ASSERT_EQ((std::vector<u32>{ b.mSlot, bChild.mSlot, c.mSlot, cChild.mSlot, d.mSlot }), store.DrawOrder());
+}
+
+namespace
+{
+    // Roughly the shape of a MapObject before its hot state moved in to the store
+    struct HeapObject
+    {
+        std::string mName;
+        std::map<std::string, int> mAnims;
+        f32 mXPos;
+        f32 mYPos;
+        bool mFlipX;
+        u8 mCold[128];
+    };
+}
+
+TEST(MapObjectStore, Benchmark)
+{
+    const u32 kObjectCount = 20000;
+    const u32 kPasses = 50;
+
+    std::vector<std::unique_ptr<HeapObject>> heapObjects;
+    MapObjectStore store;
+    std::vector<MapObjectHandle> handles;
+
+    // Interleave allocations so the heap objects aren't laid out in iteration order, like a map
+    // that has loaded and removed objects for a while
+    std::vector<std::unique_ptr<HeapObject>> allocated;
+    for (u32 i = 0; i < kObjectCount; i++)
+    {
+        allocated.push_back(std::make_unique<HeapObject>());
+        allocated.back()->mXPos = static_cast<f32>(i);
+        allocated.back()->mYPos = static_cast<f32>(i * 2);
+        allocated.back()->mFlipX = (i % 2) != 0;
+
+        handles.push_back(store.Add(nullptr, ObjRect{}));
+        store.mXPos.back() = static_cast<f32>(i);
+        store.mYPos.back() = static_cast<f32>(i * 2);
+        store.mFlipX.back() = (i % 2) != 0;
+    }
+    std::shuffle(allocated.begin(), allocated.end(), std::mt19937(1234));
+    heapObjects = std::move(allocated);
+
+    using TClock = std::chrono::high_resolution_clock;
+
+    f32 heapSum = 0.0f;
+    const TClock::time_point heapStart = TClock::now();
+    for (u32 pass = 0; pass < kPasses; pass++)
+    {
+        for (auto& obj : heapObjects)
+        {
+            obj->mXPos += obj->mFlipX ? -1.0f : 1.0f;
+            heapSum += obj->mXPos + obj->mYPos;
+        }
+    }
+    const f64 heapMs = std::chrono::duration<f64, std::milli>(TClock::now() - heapStart).count();
+
+    f32 storeSum = 0.0f;
+    const TClock::time_point storeStart = TClock::now();
+    for (u32 pass = 0; pass < kPasses; pass++)
+    {
+        for (u32 i = 0; i < store.Count(); i++)
+        {
+            store.mXPos[i] += store.mFlipX[i] ? -1.0f : 1.0f;
+            storeSum += store.mXPos[i] + store.mYPos[i];
+        }
+    }
+    const f64 storeMs = std::chrono::duration<f64, std::milli>(TClock::now() - storeStart).count();
+
+    std::cout << kObjectCount << " objects x " << kPasses << " passes: heap objects " << heapMs << "ms, store " << storeMs << "ms" << std::endl;
+
+    // Same work in both, only the summation order differs
+    ASSERT_NEAR(heapSum, storeSum, std::abs(heapSum) * 0.001f);
+
+    for (const MapObjectHandle& handle : handles)
+    {
+        store.Remove(handle);
+    }
+    ASSERT_EQ(0u, store.Count());
+}
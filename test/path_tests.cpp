@@ -0,0 +1,93 @@
+#include <gmock/gmock.h>
+#include "oddlib/path.hpp"
+#include "oddlib/stream.hpp"
+#include <cstring>
+
+namespace
+{
+    void Push16(std::vector<u8>& data, u16 value)
+    {
+        data.push_back(static_cast<u8>(value & 0xFF));
+        data.push_back(static_cast<u8>(value >> 8));
+    }
+
+    void Push32(std::vector<u8>& data, u32 value)
+    {
+        Push16(data, static_cast<u16>(value & 0xFFFF));
+        Push16(data, static_cast<u16>(value >> 16));
+    }
+
+    // A 1x1 AE path with one camera, one collision line and one object
+    std::vector<u8> MakeAePath()
+    {
+        std::vector<u8> data;
+
+        const char kCamName[] = "R1P01C01";
+        data.insert(data.end(), kCamName, kCamName + 8);
+
+        // Collision item
+        Push16(data, 10); Push16(data, 20);
+        Push16(data, 30); Push16(data, 40);
+        Push16(data, 0);
+        Push16(data, static_cast<u16>(-1)); Push16(data, 1);
+        Push16(data, static_cast<u16>(-1)); Push16(data, static_cast<u16>(-1));
+        Push16(data, 20);
+
+        // Object: TLV, rect and 4 bytes of object specific data
+        Push16(data, 0x4);
+        Push16(data, 16 + 4);
+        Push32(data, 5);
+        Push16(data, 1); Push16(data, 2);
+        Push16(data, 3); Push16(data, 4);
+        Push32(data, 0xDEADBEEF);
+
+        // Index table, offset of the first camera's object list
+        Push32(data, 0);
+        return data;
+    }
+
+    const u32 kCollisionOffset = 8 + 16;
+    const u32 kObjectOffset = kCollisionOffset + 20;
+    const u32 kIndexTableOffset = 48 + 16;
+}
+
+TEST(Path, LoadAe)
+{
+    Oddlib::Path path("", MakeAePath(), kCollisionOffset, kIndexTableOffset, kObjectOffset, 1, 1, false);
+
+    ASSERT_EQ("R1P01C01.CAM", path.CameraByPosition(0, 0).mName);
+
+    const Oddlib::Path::CollisionItems& collisions = path.Collisions();
+    ASSERT_EQ(1u, collisions.Count());
+    ASSERT_EQ(10, collisions.mP1X[0]);
+    ASSERT_EQ(40, collisions.mP2Y[0]);
+    ASSERT_EQ(-1, collisions.mLinkPrevious[0]);
+    ASSERT_EQ(1, collisions.mLinkNext[0]);
+    ASSERT_EQ(20, collisions.At(0).mLineLength);
+
+    const auto& objects = path.CameraByPosition(0, 0).mObjects;
+    ASSERT_EQ(1u, objects.size());
+    ASSERT_EQ(5u, objects[0].mType);
+    ASSERT_EQ(3, objects[0].mRectBottomRight.mX);
+    ASSERT_EQ(4u, objects[0].mDataSize);
+
+    Oddlib::SpanStream stream(path.ObjectData(objects[0]), objects[0].mDataSize);
+    u32 value = 0;
+    stream.Read(value);
+    ASSERT_EQ(0xDEADBEEF, value);
+    ASSERT_TRUE(stream.AtEnd());
+}
+
+TEST(Path, TruncatedDataThrows)
+{
+    std::vector<u8> data = MakeAePath();
+    data.resize(data.size() - 8);
+    ASSERT_THROW(Oddlib::Path("", std::move(data), kCollisionOffset, kIndexTableOffset, kObjectOffset, 1, 1, false), Oddlib::InvalidPath);
+}
+
+TEST(Path, ObjectLengthSmallerThanHeaderThrows)
+{
+    std::vector<u8> data = MakeAePath();
+    data[28 + 2] = 8;
+    ASSERT_THROW(Oddlib::Path("", std::move(data), kCollisionOffset, kIndexTableOffset, kObjectOffset, 1, 1, false), Oddlib::InvalidPath);
+}
@@ -0,0 +1,60 @@
+#include <gmock/gmock.h>
+#include "replay.hpp"
+#include "oddlib/stream.hpp"
+
+TEST(InputSnapshot, WriteReadRoundTrip)
+{
+    InputSnapshot previous;
+    previous.mKeys[InputSnapshot::eDown][SDL_SCANCODE_LEFT] = true;
+
+    InputSnapshot current = previous;
+    current.mKeys[InputSnapshot::eRawDown][SDL_SCANCODE_E] = true;
+    current.mKeys[InputSnapshot::ePressed][SDL_SCANCODE_E] = true;
+    current.mKeys[InputSnapshot::eDown][SDL_SCANCODE_LEFT] = false;
+    current.mMouseButtons[1] = 0x9;
+    current.mMouseX = 320;
+    current.mMouseY = -5;
+    current.mActions[InputSnapshot::eRawDown] = 0x12;
+
+    Oddlib::MemoryStream stream(std::vector<u8>{});
+    current.Write(stream, previous);
+    stream.Seek(0);
+
+    InputSnapshot read;
+    read.Read(stream, previous);
+
+    ASSERT_EQ(current.mKeys, read.mKeys);
+    ASSERT_EQ(current.mMouseButtons, read.mMouseButtons);
+    ASSERT_EQ(current.mMouseX, read.mMouseX);
+    ASSERT_EQ(current.mMouseY, read.mMouseY);
+    ASSERT_EQ(current.mActions, read.mActions);
+}
+
+TEST(InputSnapshot, IdleTickIsOneByte)
+{
+    InputSnapshot previous;
+    previous.mKeys[InputSnapshot::eDown][SDL_SCANCODE_RIGHT] = true;
+    previous.mMouseX = 100;
+
+    Oddlib::MemoryStream stream(std::vector<u8>{});
+    previous.Write(stream, previous);
+    ASSERT_EQ(1u, stream.LoadAllToString().size());
+}
+
+TEST(StateHash, OrderMatters)
+{
+    StateHash a;
+    a.Add(1.0f);
+    a.Add(2.0f);
+
+    StateHash b;
+    b.Add(2.0f);
+    b.Add(1.0f);
+
+    StateHash c;
+    c.Add(1.0f);
+    c.Add(2.0f);
+
+    ASSERT_NE(a.Value(), b.Value());
+    ASSERT_EQ(a.Value(), c.Value());
+}
@@ -5,6 +5,10 @@
 #include "logger.hpp"
 #include "resourcemapper.hpp"
 #include "inmemoryfs.hpp"
+#include "gamefilesystem.hpp"
+#include "string_util.hpp"
+#include <chrono>
+#include <iostream>
 
 using namespace ::testing;
 
@@ -27,6 +31,82 @@ TEST(IFileSystem, NormalizePath)
     }
 }
 
+TEST(NamedPaths, Expand)
+{
+    NamedPaths namedPaths;
+    namedPaths.Add("{GameDir}", "C:\\Games\\Alive\\");
+    namedPaths.Add("{CacheDir}", "/home/fool/cache/");
+
+    std::string out;
+    namedPaths.Expand("{GameDir}/data/sounds.json", out);
+    ASSERT_EQ("C:/Games/Alive/data/sounds.json", out);
+
+    namedPaths.Expand("{CacheDir}\\Foo.wav", out);
+    ASSERT_EQ("/home/fool/cache/Foo.wav", out);
+
+    namedPaths.Expand("{UserDir}/{Cache}/x", out);
+    ASSERT_EQ("{UserDir}/{Cache}/x", out);
+
+    ASSERT_EQ("C:\\Games\\Alive\\", *namedPaths.Find("{GameDir}"));
+    ASSERT_EQ(nullptr, namedPaths.Find("{UserDir}"));
+}
+
+TEST(NamedPaths, ExpandBenchmark)
+{
+    using TClock = std::chrono::high_resolution_clock;
+    const u32 kPaths = 100000;
+
+    const std::map<std::string, std::string> namedPathMap =
+    {
+        { "{GameDir}", "C:/Games/Alive/" },
+        { "{UserDir}", "C:/Users/fool/Documents/ALIVE User files/" },
+        { "{CacheDir}", "C:/Users/fool/Documents/ALIVE User files/CacheFiles/" }
+    };
+
+    NamedPaths namedPaths;
+    for (const auto& namedPath : namedPathMap)
+    {
+        namedPaths.Add(namedPath.first, namedPath.second);
+    }
+
+    // What GameFileSystem::ExpandPath did before the table was made read only
+    std::recursive_mutex mutex;
+    auto oldExpandPath = [&](const std::string& path)
+    {
+        std::unique_lock<std::recursive_mutex> lock(mutex);
+        std::string ret = path;
+        for (const auto& namedPath : namedPathMap)
+        {
+            string_util::replace_all(ret, namedPath.first, namedPath.second);
+        }
+        InMemoryFileSystem::NormalizePath(ret);
+        return ret;
+    };
+
+    const std::string path = "{CacheDir}/MLSNDFX_Slig_Hi.wav";
+    size_t oldLength = 0;
+    TClock::time_point start = TClock::now();
+    for (u32 i = 0; i < kPaths; i++)
+    {
+        oldLength += oldExpandPath(path).size();
+    }
+    const f64 oldNs = std::chrono::duration<f64, std::nano>(TClock::now() - start).count() / kPaths;
+
+    size_t newLength = 0;
+    std::string out;
+    start = TClock::now();
+    for (u32 i = 0; i < kPaths; i++)
+    {
+        namedPaths.Expand(path, out);
+        newLength += out.size();
+    }
+    const f64 newNs = std::chrono::duration<f64, std::nano>(TClock::now() - start).count() / kPaths;
+    std::cout << "ExpandPath: " << oldNs << "ns per path before, " << newNs << "ns now" << std::endl;
+
+    ASSERT_EQ(oldExpandPath(path), out);
+    ASSERT_EQ(oldLength, newLength);
+}
+
 TEST(IFileSystem, WildCardMatcher)
 {
     ASSERT_TRUE(InMemoryFileSystem::WildCardMatcher("Hello.txt", "*.txt", IFileSystem::IgnoreCase));
@@ -398,6 +478,55 @@ TEST(ResourceLocator, ParseGameDefinition)
     ASSERT_EQ(gd.Hidden(), true);
 }
 
+TEST(ResourceLocator, GameDefinitionCache)
+{
+    const std::string gameDefJson = R"(
+    {
+      "Name" : "Mod",
+      "Description" : "A mod",
+      "Author" : "Someone",
+      "DatasetName" : "AeMod",
+      "RequiredDatasets"  : [ "AePc", "AePsx" ]
+    }
+    )";
+
+    InMemoryFileSystem fs;
+    fs.AddFile("game.json", gameDefJson);
+    GameDefinition gd(fs, "game.json", true);
+
+    Oddlib::MemoryStream written(std::vector<u8>{});
+    gd.Write(written);
+    const std::string bytes = written.LoadAllToString();
+
+    Oddlib::MemoryStream stream(std::vector<u8>(bytes.begin(), bytes.end()));
+    GameDefinition cached;
+    cached.Read(stream);
+    ASSERT_TRUE(stream.AtEnd());
+    ASSERT_EQ("Mod", cached.Name());
+    ASSERT_EQ("A mod", cached.Description());
+    ASSERT_EQ("Someone", cached.Author());
+    ASSERT_EQ("", cached.GameScriptName());
+    ASSERT_EQ("AeMod", cached.DataSetName());
+    ASSERT_EQ(gd.RequiredDataSets(), cached.RequiredDataSets());
+    ASSERT_FALSE(cached.Hidden());
+    ASSERT_TRUE(cached.IsMod());
+    ASSERT_EQ(gd.ContainingArchive(), cached.ContainingArchive());
+
+    // An entry is only used while its file is unchanged
+    GameDefinitionCache cache;
+    GameDefinitionCache::Entry entry;
+    entry.mPath = "mods/mod.zip";
+    entry.mSize = 100;
+    entry.mModifiedTime = 5;
+    entry.mHasDefinition = true;
+    entry.mDefinition = cached;
+    cache.mEntries.push_back(entry);
+    ASSERT_NE(nullptr, cache.Find("mods/mod.zip", 100, 5));
+    ASSERT_EQ(nullptr, cache.Find("mods/mod.zip", 100, 6));
+    ASSERT_EQ(nullptr, cache.Find("mods/mod.zip", 101, 5));
+    ASSERT_EQ(nullptr, cache.Find("mods/other.zip", 100, 5));
+}
+
 TEST(ResourceLocator, GameDefinitionDiscovery)
 {
     // TODO - enumerating GD's
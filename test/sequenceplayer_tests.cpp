@@ -0,0 +1,130 @@
+#include <gmock/gmock.h>
+#include <algorithm>
+#include "oddlib/audio/SequencePlayer.h"
+
+static void PushU16(std::vector<u8>& data, u16 value)
+{
+    data.push_back(static_cast<u8>(value & 0xFF));
+    data.push_back(static_cast<u8>(value >> 8));
+}
+
+// Program 0 has one tone over every key that loops a saw wave, with a fast attack and release
+static std::unique_ptr<Vab> MakeVab()
+{
+    std::vector<u8> tone =
+    {
+        0,      // Priority
+        0,      // Mode, not reverb
+        127,    // Volume
+        64,     // Pan, centre
+        60,     // Centre note
+        0,      // Shift
+        0, 127, // Key range
+        0, 0, 0, 0, 0, 0, 0, 0
+    };
+    PushU16(tone, 0x030F); // Attack, decay and sustain level
+    PushU16(tone, 0x0000); // Release
+    PushU16(tone, 0);      // Program
+    PushU16(tone, 1);      // Sample 1, 0 means none
+    for (int i = 0; i < 4; i++)
+    {
+        PushU16(tone, 0);
+    }
+
+    auto vab = std::make_unique<Vab>();
+    Oddlib::MemoryStream toneStream(std::move(tone));
+    vab->mTones.push_back(std::make_unique<VagAtr>(toneStream));
+    vab->mProgs[0].iNumTones = 1;
+    vab->mProgs[0].iTones.push_back(vab->mTones.back().get());
+
+    Vab::SampleData sample;
+    for (u16 i = 0; i < 2048; i++)
+    {
+        PushU16(sample, static_cast<u16>((i % 64) * 256));
+    }
+    vab->mSamples.push_back(sample);
+    return vab;
+}
+
+// 120 bpm so each tick is 44.1 samples. Two notes where the second starts as the first stops.
+static std::vector<u8> MakeSeq()
+{
+    return std::vector<u8>
+    {
+        'S', 'E', 'Q', 'p',
+        1, 0, 0, 0,             // Version
+        0x80, 0x01,             // Resolution of a quarter note
+        0x07, 0xA1, 0x20,       // 500000us per quarter note
+        4, 4,                   // Time signature
+
+        0x00, 0xC0, 0,          // Channel 0 uses program 0
+        0x00, 0x90, 60, 100,    // Note on
+        0x0A, 0x80, 60, 0,      // Note off 10 ticks later
+        0x00, 0x90, 67, 80,
+        0x14, 0x80, 67, 0,      // 20 ticks later
+        0x00, 0xFF, 0x2F, 0x00  // End of track
+    };
+}
+
+// Like AudioConverter, an Update and then a Play each block until AtEnd
+static std::vector<f32> Render(Vab& vab, bool offline, u32 blockFrames, u32& blocks)
+{
+    SequencePlayer player("test", vab);
+    player.SetOfflineRendering(offline);
+    Oddlib::MemoryStream seq(MakeSeq());
+    player.LoadSequenceStream(seq);
+    player.PlaySequence();
+
+    const u32 kMaxBlocks = (kAliveAudioSampleRate * 5) / blockFrames;
+    std::vector<f32> samples;
+    std::vector<f32> block(blockFrames * 2);
+    for (blocks = 0; blocks < kMaxBlocks && !player.AtEnd(); blocks++)
+    {
+        std::fill(block.begin(), block.end(), 0.0f);
+        player.Update();
+        player.Play(block.data(), static_cast<u32>(block.size()));
+        samples.insert(samples.end(), block.begin(), block.end());
+    }
+    return samples;
+}
+
+static size_t FirstSound(const std::vector<f32>& samples, size_t from)
+{
+    for (size_t i = from; i < samples.size(); i++)
+    {
+        if (samples[i] != 0.0f)
+        {
+            return i;
+        }
+    }
+    return samples.size();
+}
+
+TEST(SequencePlayer, OfflineMatchesRealTime)
+{
+    std::unique_ptr<Vab> vab = MakeVab();
+
+    // Events fall part way through the blocks so offline rendering has to split them
+    const u32 kBlockFrames = 100;
+    u32 realTimeBlocks = 0;
+    u32 offlineBlocks = 0;
+    const std::vector<f32> realTime = Render(*vab, false, kBlockFrames, realTimeBlocks);
+    const std::vector<f32> offline = Render(*vab, true, kBlockFrames, offlineBlocks);
+
+    // Both finish, in the same block
+    const u32 kMaxBlocks = (kAliveAudioSampleRate * 5) / kBlockFrames;
+    ASSERT_LT(realTimeBlocks, kMaxBlocks);
+    ASSERT_EQ(realTimeBlocks, offlineBlocks);
+    ASSERT_EQ(realTime.size(), offline.size());
+
+    // Both notes start on the same sample
+    const size_t firstNote = FirstSound(realTime, 0);
+    ASSERT_EQ(firstNote, FirstSound(offline, 0));
+    ASSERT_LT(firstNote, realTime.size());
+
+    // Each sample matches, so the note offs and the second note on happen at the same time too
+    for (size_t i = 0; i < realTime.size(); i++)
+    {
+        ASSERT_NEAR(realTime[i], offline[i], 0.00001f) << "at sample " << i;
+    }
+}
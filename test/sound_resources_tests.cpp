@@ -0,0 +1,97 @@
+#include <gmock/gmock.h>
+#include <chrono>
+#include <iostream>
+#include "sound_resources.hpp"
+
+static std::string SoundName(u32 i)
+{
+    return "Sound_" + std::to_string(i);
+}
+
+// Every sound is a sample in one of kBanks sound banks, the first one is also a SEQ
+static std::string MakeSoundsJson(u32 soundCount, u32 bankCount)
+{
+    std::string json = "[ { \"sound_resources\": [";
+    for (u32 i = 0; i < soundCount; i++)
+    {
+        const std::string bank = "\"Bank_" + std::to_string(i % bankCount) + "\"";
+        json += i > 0 ? "," : "";
+        json += "{ \"resource_name\": \"" + SoundName(i) + "\",";
+        if (i == 0)
+        {
+            json += "\"seq\": { \"resource_id\": 7, \"sound_banks\": [ \"Bank_1\", \"Bank_0\", \"Bank_1\" ] },";
+        }
+        json += "\"sample\": { \"volume\": 127, \"min_pitch\": 0, \"max_pitch\": 0, \"locations\": [ { \"program\": 25, \"tone\": 60, \"sound_banks\": [ " + bank + " ] } ] } }";
+    }
+
+    json += "] }, { \"sound_banks\": [";
+    for (u32 i = 0; i < bankCount; i++)
+    {
+        json += i > 0 ? "," : "";
+        json += "{ \"name\": \"Bank_" + std::to_string(i) + "\", \"data_set\": \"AePc\", \"bsq_name\": \"MLSEQ.BSQ\", \"vab_name\": \"MLSNDFX\" }";
+    }
+
+    json += "] }, { \"themes\": [ { \"name\": \"Mines\", \"base_line\": [ \"Sound_0\" ] }, { \"name\": \"Brewery\", \"base_line\": [ \"Sound_1\" ] } ] } ]";
+    return json;
+}
+
+TEST(SoundResources, HashedLookups)
+{
+    SoundResources resources;
+    resources.Parse(MakeSoundsJson(3, 2));
+
+    ASSERT_EQ(nullptr, resources.FindSound("I don't exist"));
+    const SoundResource* sound = resources.FindSound("Sound_2");
+    ASSERT_EQ(&resources.mSounds[2], sound);
+
+    // Bank ids keep the order they are listed in without duplicates
+    const std::vector<SoundBankId>& seqBanks = resources.mSounds[0].mMusic.mSoundBanks;
+    ASSERT_EQ(2u, seqBanks.size());
+    ASSERT_EQ("Bank_1", resources.BankName(seqBanks[0]));
+    ASSERT_EQ("Bank_0", resources.BankName(seqBanks[1]));
+
+    SoundBankId id = 0;
+    ASSERT_FALSE(resources.FindBankId("Bank_2", id));
+    ASSERT_TRUE(resources.FindBankId("Bank_0", id));
+    ASSERT_EQ(seqBanks[1], id);
+    ASSERT_EQ(resources.FindSoundBank("Bank_0"), resources.FindSoundBank(id));
+    ASSERT_EQ("Bank_0", resources.FindSoundBank(id)->mName);
+    ASSERT_EQ(nullptr, resources.FindSoundBank(SoundBankId(100)));
+
+    ASSERT_EQ(nullptr, resources.FindMusicTheme("Paramonia"));
+    ASSERT_EQ(&resources.mThemes[1], resources.FindMusicTheme("Brewery"));
+}
+
+TEST(SoundResources, LookupBenchmark)
+{
+    using TClock = std::chrono::high_resolution_clock;
+    const u32 kSounds = 2000;
+
+    SoundResources resources;
+    resources.Parse(MakeSoundsJson(kSounds, 50));
+
+    std::vector<std::string> names;
+    for (u32 i = 0; i < kSounds; i++)
+    {
+        names.push_back(SoundName(i));
+    }
+
+    // Resolve every sound effect the way LocateSound does: the sound and then each of its banks
+    u32 found = 0;
+    const TClock::time_point start = TClock::now();
+    for (const std::string& name : names)
+    {
+        const SoundResource* sound = resources.FindSound(name.c_str());
+        for (const SoundEffectResourceLocation& loc : sound->mSoundEffect.mSoundBanks)
+        {
+            for (SoundBankId sb : loc.mSoundBanks)
+            {
+                found += resources.FindSoundBank(sb) ? 1 : 0;
+            }
+        }
+    }
+    const f64 lookupUs = std::chrono::duration<f64, std::micro>(TClock::now() - start).count() / kSounds;
+    std::cout << kSounds << " sounds: " << lookupUs << "us per sound effect lookup" << std::endl;
+
+    ASSERT_EQ(kSounds, found);
+}
@@ -1,5 +1,7 @@
 #include <gmock/gmock.h>
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 #include "gridmap.hpp"
 #include "editormode.hpp"
 
@@ -203,3 +205,127 @@ TEST(UndoStack, StackLimit)
     ASSERT_TRUE(SetsEqual(data, { 1, 2 }));
 
 }
+
+static CollisionLines MakeLines(u32 count)
+{
+    CollisionLines lines;
+    for (u32 i = 0; i < count; i++)
+    {
+        const f32 x = static_cast<f32>(i * 10);
+        lines.emplace_back(std::make_unique<CollisionLine>(glm::vec2(x, 0.0f), glm::vec2(x + 5.0f, 0.0f), CollisionLine::eFloor));
+    }
+    return lines;
+}
+
+TEST(Selection, SelectDeselectAndClear)
+{
+    CollisionLines lines = MakeLines(200);
+    Selection selection;
+    ASSERT_FALSE(selection.HasSelection());
+
+    selection.Select(lines, 130, true);
+    selection.Select(lines, 3, true);
+    selection.Select(lines, 64, true);
+    selection.Select(lines, 3, true);
+    ASSERT_EQ((std::vector<s32>{ 130, 3, 64 }), selection.SelectedLines());
+    ASSERT_TRUE(selection.IsSelected(64));
+    ASSERT_TRUE(lines[64]->IsSelected());
+    ASSERT_FALSE(selection.IsSelected(65));
+    ASSERT_FALSE(selection.IsSelected(5000));
+
+    selection.Select(lines, 3, false);
+    ASSERT_EQ((std::vector<s32>{ 130, 64 }), selection.SelectedLines());
+    ASSERT_FALSE(selection.IsSelected(3));
+    ASSERT_FALSE(lines[3]->IsSelected());
+
+    const std::vector<s32> old = selection.Clear(lines);
+    ASSERT_EQ((std::vector<s32>{ 130, 64 }), old);
+    ASSERT_FALSE(selection.HasSelection());
+    ASSERT_FALSE(selection.IsSelected(130));
+    ASSERT_FALSE(lines[130]->IsSelected());
+}
+
+TEST(Selection, DragBenchmark)
+{
+    using TClock = std::chrono::high_resolution_clock;
+    const u32 kLines = 5000;
+    const u32 kMouseMoves = 1000;
+
+    CollisionLines lines = MakeLines(kLines);
+    Selection selection;
+    for (u32 i = 0; i < kLines; i++)
+    {
+        selection.Select(lines, static_cast<s32>(i), true);
+    }
+    const s32* selectedData = selection.SelectedLines().data();
+
+    // Each mouse move while dragging merges in to the one move command: undo, merge, redo
+    UndoStack stack;
+    bool merge = false;
+    const TClock::time_point start = TClock::now();
+    for (u32 i = 0; i < kMouseMoves; i++)
+    {
+        stack.PushMerge<MoveSelection>(merge, lines, selection, glm::vec2(1.0f, 2.0f));
+        merge = true;
+    }
+    const f64 eventUs = std::chrono::duration<f64, std::micro>(TClock::now() - start).count() / kMouseMoves;
+    std::cout << kLines << " selected lines: " << eventUs << "us per mouse move" << std::endl;
+
+    ASSERT_EQ(1u, stack.Count());
+    ASSERT_EQ(selectedData, selection.SelectedLines().data());
+    ASSERT_EQ(kMouseMoves * 1.0f, lines[kLines - 1]->mLine.mP1.x - ((kLines - 1) * 10.0f));
+    ASSERT_EQ(kMouseMoves * 2.0f, lines[0]->mLine.mP2.y);
+
+    stack.Undo();
+    ASSERT_EQ(0.0f, lines[0]->mLine.mP1.x);
+    ASSERT_EQ(0.0f, lines[0]->mLine.mP2.y);
+}
+
+TEST(UndoStack, GroupsAreOneCommand)
+{
+    std::set<s32> data;
+    UndoStack stack;
+
+    stack.Push<TestCommand>(data, 1, TestCommand::eOperation::eAdd);
+
+    stack.BeginGroup("Add many");
+    stack.Push<TestCommand>(data, 2, TestCommand::eOperation::eAdd);
+    stack.BeginGroup("Nested");
+    stack.Push<TestCommand>(data, 3, TestCommand::eOperation::eAdd);
+    stack.Push<TestCommand>(data, 1, TestCommand::eOperation::eRemove);
+    stack.EndGroup();
+    ASSERT_TRUE(stack.InGroup());
+    stack.Push<TestCommand>(data, 4, TestCommand::eOperation::eAdd);
+    stack.EndGroup();
+    ASSERT_FALSE(stack.InGroup());
+
+    // Commands are applied as they are pushed, not when the group ends
+    ASSERT_TRUE(SetsEqual(data, { 2, 3, 4 }));
+    ASSERT_EQ(2u, stack.Count());
+
+    stack.Undo();
+    ASSERT_TRUE(SetsEqual(data, { 1 }));
+
+    stack.Redo();
+    ASSERT_TRUE(SetsEqual(data, { 2, 3, 4 }));
+
+    // Empty groups add nothing
+    stack.BeginGroup("Nothing");
+    stack.EndGroup();
+    ASSERT_EQ(2u, stack.Count());
+}
+
+TEST(UndoStack, UndoClosesAnOpenGroup)
+{
+    std::set<s32> data;
+    UndoStack stack;
+
+    stack.BeginGroup("Open");
+    stack.Push<TestCommand>(data, 5, TestCommand::eOperation::eAdd);
+    stack.Push<TestCommand>(data, 6, TestCommand::eOperation::eAdd);
+
+    stack.Undo();
+    ASSERT_FALSE(stack.InGroup());
+    ASSERT_EQ(1u, stack.Count());
+    ASSERT_TRUE(SetsEqual(data, {}));
+}
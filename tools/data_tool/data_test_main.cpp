@@ -487,17 +487,18 @@ public:
                     // Load the path block
                     auto pathStream = chunk->Stream();
                     Oddlib::Path path(pathData->mMusicTheme, *pathStream, pathData->mCollisionOffset, pathData->mIndexTableOffset, pathData->mObjectOffset, pathData->mNumberOfScreensX, pathData->mNumberOfScreensY, IsAo(eType));
-                    CheckSecondLinkIsNotUsed(path.CollisionItems());
+                    CheckSecondLinkIsNotUsed(path.Collisions());
                 }
             }
         }
     }
 
-    void CheckSecondLinkIsNotUsed(const std::vector<Oddlib::Path::CollisionItem>& items)
+    void CheckSecondLinkIsNotUsed(const Oddlib::Path::CollisionItems& items)
     {
 
-        for (const Oddlib::Path::CollisionItem& item : items)
+        for (u32 i = 0; i < items.Count(); i++)
         {
+            const Oddlib::Path::CollisionItem item = items.At(i);
             CollisionLine::ToType(item.mType);
             if (item.mType != CollisionLine::eBulletWall
                 && item.mType != CollisionLine::eArt
@@ -2301,7 +2301,7 @@ void SoundResourcesDumper::PopulateSoundEffectSoundBanks()
             abort();
         }
 
-        for (SoundEffectResourceLocation& loc : soundEffect.mSoundBanks)
+        for (TempSoundEffectLocation& loc : soundEffect.mSoundBanks)
         {
             // In the defined data above the initial sound banks are actually wild card matches for which
             // sound banks we really want to put in here. This is because there are tons of sound banks and in general
@@ -2332,7 +2332,7 @@ void SoundResourcesDumper::RemoveBrokenSoundEffectSoundBanks()
         auto brokenSfxRec = gBrokenSfxSoundBanks.find(sfxRes.mResourceName);
         if (brokenSfxRec != std::end(gBrokenSfxSoundBanks))
         {
-            for (SoundEffectResourceLocation& sfxLoc : sfxRes.mSoundBanks)
+            for (TempSoundEffectLocation& sfxLoc : sfxRes.mSoundBanks)
             {
                 for (const std::string& brokenSoundBank : brokenSfxRec->second)
                 {
@@ -2362,7 +2362,7 @@ void SoundResourcesDumper::RemoveSoundBanksThatDontMatchPrimarySample()
             {
                 const s16 pSampleIndex = pFx->mVab->VagAt(pFx->mProgram, pFx->mNote)->iVag - 1;
                 Vab::SampleData pSampleData = pFx->mVab->mSamples[pSampleIndex];
-                for (SoundEffectResourceLocation& sfxLoc : sfxRes.mSoundBanks)
+                for (TempSoundEffectLocation& sfxLoc : sfxRes.mSoundBanks)
                 {
                     // Remove if sample data does not match primary
                     for (auto sbIt = std::begin(sfxLoc.mSoundBanks); sbIt != std::end(sfxLoc.mSoundBanks); )
@@ -2431,13 +2431,31 @@ static SoundResource* FindRecord(std::vector<SoundResource>& all, const std::str
     return nullptr;
 }
 
-static void CopyRec(SoundResource& sfxRec, const TempSoundEffectResource& sfx)
+static std::vector<SoundBankId> InternBanks(SoundResources& resources, const std::set<std::string>& soundBanks)
+{
+    std::vector<SoundBankId> ids;
+    for (const std::string& soundBank : soundBanks)
+    {
+        ids.push_back(resources.InternBank(soundBank));
+    }
+    return ids;
+}
+
+static void CopyRec(SoundResources& resources, SoundResource& sfxRec, const TempSoundEffectResource& sfx)
 {
     sfxRec.mResourceName = sfx.mResourceName;
     sfxRec.mSoundEffect.mMaxPitch = sfx.mMaxPitch;
     sfxRec.mSoundEffect.mMinPitch = sfx.mMinPitch;
     sfxRec.mSoundEffect.mVolume = sfx.mVolume;
-    sfxRec.mSoundEffect.mSoundBanks = sfx.mSoundBanks;
+    sfxRec.mSoundEffect.mSoundBanks.clear();
+    for (const TempSoundEffectLocation& loc : sfx.mSoundBanks)
+    {
+        SoundEffectResourceLocation location;
+        location.mProgram = loc.mProgram;
+        location.mTone = loc.mTone;
+        location.mSoundBanks = InternBanks(resources, loc.mSoundBanks);
+        sfxRec.mSoundEffect.mSoundBanks.push_back(location);
+    }
     sfxRec.mComment = sfx.mComment;
 }
 
@@ -2449,7 +2467,7 @@ void SoundResourcesDumper::MergeToFinalResources()
         SoundResource musicRec;
         musicRec.mResourceName = music.mResourceName;
         musicRec.mMusic.mResourceId = music.mResourceId;
-        musicRec.mMusic.mSoundBanks = music.mSoundBanks;
+        musicRec.mMusic.mSoundBanks = InternBanks(mFinalResources, music.mSoundBanks);
         mFinalResources.mSounds.push_back(musicRec);
     }
 
@@ -2465,12 +2483,12 @@ void SoundResourcesDumper::MergeToFinalResources()
                 abort();
             }
 
-            CopyRec(*pFound, sfx);
+            CopyRec(mFinalResources, *pFound, sfx);
         }
         else
         {
             SoundResource sfxRec;
-            CopyRec(sfxRec, sfx);
+            CopyRec(mFinalResources, sfxRec, sfx);
             mFinalResources.mSounds.push_back(sfxRec);
         }
     }
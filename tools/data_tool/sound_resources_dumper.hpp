@@ -4,11 +4,20 @@
 #include "sound_resources.hpp"
 #include <set>
 
-class TempSoundEffectResource : public SoundEffectResource
+// Sound banks are added and removed by name until the records are interned in to the final resources
+class TempSoundEffectLocation
+{
+public:
+    s32 mProgram;
+    s32 mTone;
+    std::set<std::string> mSoundBanks;
+};
+
+class TempSoundEffectResource
 {
 public:
     TempSoundEffectResource() = default;
-    TempSoundEffectResource(std::string name, s32 vol, s32 minPitch, s32 maxPitch, std::vector<SoundEffectResourceLocation> soundBanks, const std::string& comment)
+    TempSoundEffectResource(std::string name, s32 vol, s32 minPitch, s32 maxPitch, std::vector<TempSoundEffectLocation> soundBanks, const std::string& comment)
         : mResourceName(name)
     {
         mVolume = vol;
@@ -18,13 +27,19 @@ public:
         mComment = comment;
     }
 
+    s32 mVolume;
+    s32 mMinPitch;
+    s32 mMaxPitch;
+    std::vector<TempSoundEffectLocation> mSoundBanks;
     std::string mResourceName;
     std::string mComment;
 };
 
-class TempMusicResource : public MusicResource
+class TempMusicResource
 {
 public:
+    u32 mResourceId;
+    std::set<std::string> mSoundBanks;
     std::string mResourceName;
 };
 
@@ -523,8 +523,10 @@ void GdiLoop(HDC hdc)
                 renderOffsetY += 114;
             }
 
-            for (auto collision : gPath->CollisionItems())
+            const Oddlib::Path::CollisionItems& collisions = gPath->Collisions();
+            for (u32 i = 0; i < collisions.Count(); i++)
             {
+                const Oddlib::Path::CollisionItem collision = collisions.At(i);
                 int p1x = collision.mP1.mX - renderOffsetX;
                 int p1y = collision.mP1.mY - renderOffsetY;
                 int p2x = collision.mP2.mX - renderOffsetX;